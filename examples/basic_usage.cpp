@@ -10,11 +10,11 @@ void printRecommendations(const std::vector<BookQueryEngine::RecommendationResul
     
     for (size_t i = 0; i < recommendations.size(); ++i) {
         const auto& rec = recommendations[i];
-        std::cout << i + 1 << ". " << rec.book.getTitle() << "\n";
-        std::cout << "   Author: " << rec.book.getAuthor() << "\n";
-        std::cout << "   Genres: " << join(rec.book.getGenres(), ", ") << "\n";
-        std::cout << "   Rating: " << rec.book.getAverageRating() 
-                  << "/5.0 (" << rec.book.getRatingsCount() << " ratings)\n";
+        std::cout << i + 1 << ". " << rec.book->getTitle() << "\n";
+        std::cout << "   Author: " << rec.book->getAuthor() << "\n";
+        std::cout << "   Genres: " << join(rec.book->getGenres(), ", ") << "\n";
+        std::cout << "   Rating: " << rec.book->getAverageRating() 
+                  << "/5.0 (" << rec.book->getRatingsCount() << " ratings)\n";
         std::cout << "   Similarity Score: " << rec.similarity_score << "\n";
         std::cout << "   Why this book: " << rec.explanation << "\n\n";
     }
@@ -136,9 +136,9 @@ private:
             if (books.size() > 1) {
                 std::cout << "\nI found multiple matches. Which book did you mean?\n\n";
                 for (size_t i = 0; i < books.size(); ++i) {
-                    std::cout << i + 1 << ". " << books[i].getTitle() 
-                              << " by " << books[i].getAuthor() << " (" 
-                              << books[i].getPublicationYear() << ")\n";
+                    std::cout << i + 1 << ". " << books[i]->getTitle() 
+                              << " by " << books[i]->getAuthor() << " (" 
+                              << books[i]->getPublicationYear() << ")\n";
                 }
                 
                 std::cout << "\nEnter the number of your choice (1-" << books.size() << "): ";
@@ -151,10 +151,10 @@ private:
                     return;
                 }
                 
-                auto similar = recommender_->getSimilarBooks(books[choice - 1].getId());
+                auto similar = recommender_->getSimilarBooks(books[choice - 1]->getId());
                 printRecommendations(similar);
             } else {
-                auto similar = recommender_->getSimilarBooks(books[0].getId());
+                auto similar = recommender_->getSimilarBooks(books[0]->getId());
                 printRecommendations(similar);
             }
         } catch (const std::exception& e) {
@@ -380,24 +380,24 @@ private:
             const auto& rec = recommendations[i];
             
             // Print title and author
-            std::cout << i + 1 << ". " << rec.book.getTitle() << "\n";
-            std::cout << "   Author: " << rec.book.getAuthor() << "\n";
+            std::cout << i + 1 << ". " << rec.book->getTitle() << "\n";
+            std::cout << "   Author: " << rec.book->getAuthor() << "\n";
             
             // Print genres
-            std::cout << "   Genres: " << joinStrings(rec.book.getGenres(), ", ") << "\n";
+            std::cout << "   Genres: " << joinStrings(rec.book->getGenres(), ", ") << "\n";
             
             // Print rating information
             std::cout << "   Rating: " << std::fixed << std::setprecision(2) 
-                      << rec.book.getAverageRating() << "/5.0 (" 
-                      << rec.book.getRatingsCount() << " ratings)\n";
+                      << rec.book->getAverageRating() << "/5.0 (" 
+                      << rec.book->getRatingsCount() << " ratings)\n";
             
             // Print series information if available
-            if (auto series = rec.book.getSeries()) {
+            if (auto series = rec.book->getSeries()) {
                 std::cout << "   Series: " << *series << "\n";
             }
             
             // Print publication year
-            std::cout << "   Published: " << rec.book.getPublicationYear() << "\n";
+            std::cout << "   Published: " << rec.book->getPublicationYear() << "\n";
             
             // Print explanation
             std::cout << "   Why recommended: " << truncateText(rec.explanation, MAX_DISPLAY_LENGTH) << "\n";
@@ -409,29 +409,43 @@ private:
     }
 
     void printBooks(const std::vector<Book>& books) {
-        if (books.empty()) {
+        if (!printBooksHeader(books.size())) return;
+        for (size_t i = 0; i < books.size(); ++i) {
+            printBook(i, books[i]);
+        }
+    }
+
+    void printBooks(const std::vector<std::shared_ptr<const Book>>& books) {
+        if (!printBooksHeader(books.size())) return;
+        for (size_t i = 0; i < books.size(); ++i) {
+            printBook(i, *books[i]);
+        }
+    }
+
+    bool printBooksHeader(size_t count) {
+        if (count == 0) {
             std::cout << "\nNo books found matching your criteria.\n";
-            return;
+            return false;
         }
 
         std::cout << "\n📚 Books:\n";
         std::cout << "========\n\n";
+        return true;
+    }
 
-        for (size_t i = 0; i < books.size(); ++i) {
-            const auto& book = books[i];
-            std::cout << i + 1 << ". " << book.getTitle() << "\n";
-            std::cout << "   Author: " << book.getAuthor() << "\n";
-            std::cout << "   Genres: " << joinStrings(book.getGenres(), ", ") << "\n";
-            std::cout << "   Rating: " << std::fixed << std::setprecision(2) 
-                      << book.getAverageRating() << "/5.0 (" 
-                      << book.getRatingsCount() << " ratings)\n";
-            
-            if (auto series = book.getSeries()) {
-                std::cout << "   Series: " << *series << "\n";
-            }
-            
-            std::cout << "   Published: " << book.getPublicationYear() << "\n\n";
+    void printBook(size_t i, const Book& book) {
+        std::cout << i + 1 << ". " << book.getTitle() << "\n";
+        std::cout << "   Author: " << book.getAuthor() << "\n";
+        std::cout << "   Genres: " << joinStrings(book.getGenres(), ", ") << "\n";
+        std::cout << "   Rating: " << std::fixed << std::setprecision(2) 
+                  << book.getAverageRating() << "/5.0 (" 
+                  << book.getRatingsCount() << " ratings)\n";
+        
+        if (auto series = book.getSeries()) {
+            std::cout << "   Series: " << *series << "\n";
         }
+        
+        std::cout << "   Published: " << book.getPublicationYear() << "\n\n";
     }
 
     std::vector<std::string> splitString(const std::string& str, char delimiter) {
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+namespace book_recommender {
+
+struct AllocationStats {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes = 0;
+};
+
+namespace detail {
+struct AllocationAccount;
+}
+
+// Counts heap allocations made by the calling thread while the scope is
+// alive, plus those of work it hands to other threads under an
+// AllocationContext (the task executor does this for every task). Global
+// operator new is only hooked when the library is built with
+// BOOK_RECOMMENDER_TRACK_ALLOCATIONS; otherwise every scope reads zero.
+class AllocationScope {
+public:
+    AllocationScope();
+    ~AllocationScope();
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+    AllocationStats stats() const;
+    static bool isTrackingEnabled();
+
+private:
+    std::shared_ptr<detail::AllocationAccount> account_;
+    std::shared_ptr<detail::AllocationAccount> previous_;
+    AllocationStats start_;
+};
+
+// The allocation scopes open on the calling thread, captured so that work
+// running elsewhere on their behalf is charged to them. Empty when no
+// scope is open or tracking is off.
+class AllocationContext {
+public:
+    static AllocationContext current();
+
+    explicit operator bool() const { return account_ != nullptr; }
+
+private:
+    friend class ScopedAllocationContext;
+    std::shared_ptr<detail::AllocationAccount> account_;
+};
+
+// Charges the calling thread's allocations during the scope's lifetime to
+// a captured context. Does nothing when the context's scopes are already
+// open on this thread, since they count the thread directly.
+class ScopedAllocationContext {
+public:
+    explicit ScopedAllocationContext(AllocationContext context);
+    ~ScopedAllocationContext();
+
+    ScopedAllocationContext(const ScopedAllocationContext&) = delete;
+    ScopedAllocationContext& operator=(const ScopedAllocationContext&) = delete;
+
+private:
+    std::shared_ptr<detail::AllocationAccount> account_;
+    std::shared_ptr<detail::AllocationAccount> previous_;
+    AllocationStats start_;
+};
+
+// Polymorphic memory resource that forwards to an upstream resource and
+// counts what passes through it
+class CountingMemoryResource : public std::pmr::memory_resource {
+public:
+    explicit CountingMemoryResource(
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource()
+    ) : upstream_(upstream) {}
+
+    AllocationStats stats() const;
+    uint64_t bytesInUse() const { return bytes_in_use_.load(std::memory_order_relaxed); }
+
+private:
+    std::pmr::memory_resource* upstream_;
+    std::atomic<uint64_t> allocations_{0};
+    std::atomic<uint64_t> deallocations_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> bytes_in_use_{0};
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
+namespace detail {
+
+// Running totals for the calling thread, maintained by the operator new hooks
+AllocationStats threadAllocationTotals();
+void recordAllocation(size_t bytes) noexcept;
+void recordDeallocation() noexcept;
+
+}
+
+}
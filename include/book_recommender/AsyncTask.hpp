@@ -0,0 +1,237 @@
+#pragma once
+
+// Coroutine support needs C++20; configure with
+// -DBOOK_RECOMMENDER_ENABLE_COROUTINES=ON to build it.
+#ifdef BOOK_RECOMMENDER_COROUTINES
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "book_recommender/TaskExecutor.hpp"
+
+namespace book_recommender {
+
+template <typename T>
+class AsyncTask;
+
+namespace detail {
+
+template <typename T>
+struct AsyncResult {
+    std::optional<T> value;
+    std::exception_ptr error;
+
+    template <typename U>
+    void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+
+    T take() {
+        if (error) std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct AsyncResult<void> {
+    std::exception_ptr error;
+
+    void return_void() {}
+
+    void take() {
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+// Eagerly started, self-destroying coroutine used to drive tasks from
+// non-coroutine code
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+}
+
+// Lazily started coroutine producing a T. Nothing runs until the task is
+// awaited; when the body finishes, the awaiting coroutine is resumed on
+// the same thread (symmetric transfer, so long await chains do not grow
+// the stack). A task can be awaited once.
+template <typename T>
+class AsyncTask {
+public:
+    struct promise_type : detail::AsyncResult<T> {
+        std::coroutine_handle<> continuation;
+
+        AsyncTask get_return_object() {
+            return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                auto continuation = handle.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void unhandled_exception() { this->error = std::current_exception(); }
+    };
+
+    AsyncTask(AsyncTask&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    AsyncTask& operator=(AsyncTask&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    AsyncTask(const AsyncTask&) = delete;
+    AsyncTask& operator=(const AsyncTask&) = delete;
+
+    ~AsyncTask() {
+        if (handle_) handle_.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+
+    T await_resume() { return handle_.promise().take(); }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+
+    explicit AsyncTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+};
+
+// `co_await resumeOn(executor)` moves the rest of the coroutine onto a pool
+// worker. Coroutines use it to leave the caller's thread before CPU-bound
+// stages and after completions delivered on foreign threads.
+class ResumeOn {
+public:
+    ResumeOn(TaskExecutor& executor, TaskPriority priority) : executor_(executor), priority_(priority) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+        executor_.post([handle] { handle.resume(); }, priority_);
+    }
+    void await_resume() const noexcept {}
+
+private:
+    TaskExecutor& executor_;
+    TaskPriority priority_;
+};
+
+inline ResumeOn resumeOn(TaskPriority priority = TaskPriority::Interactive,
+                         TaskExecutor& executor = TaskExecutor::getInstance()) {
+    return ResumeOn(executor, priority);
+}
+
+// Starts every task at once and completes when all of them have, with the
+// results in input order. Children run concurrently only as far as they
+// suspend or hop onto the executor themselves. The first failure is
+// rethrown after every child has finished.
+template <typename T>
+AsyncTask<std::vector<T>> whenAll(std::vector<AsyncTask<T>> tasks) {
+    struct State {
+        std::vector<std::optional<T>> results;
+        std::exception_ptr error;
+        std::atomic<size_t> remaining;
+        std::coroutine_handle<> parent;
+        std::mutex mutex;
+    };
+
+    struct Join {
+        State& state;
+        std::vector<AsyncTask<T>>& tasks;
+
+        bool await_ready() const noexcept { return tasks.empty(); }
+        void await_suspend(std::coroutine_handle<> parent) {
+            state.parent = parent;
+            // The extra count keeps the parent suspended until every child
+            // has been started, even if they all finish synchronously
+            state.remaining.store(tasks.size() + 1);
+            for (size_t i = 0; i < tasks.size(); ++i) {
+                run(state, std::move(tasks[i]), i);
+            }
+            complete(state);
+        }
+        void await_resume() const noexcept {}
+
+        static detail::Detached run(State& state, AsyncTask<T> task, size_t index) {
+            try {
+                state.results[index].emplace(co_await task);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (!state.error) state.error = std::current_exception();
+            }
+            complete(state);
+        }
+
+        static void complete(State& state) {
+            if (state.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                state.parent.resume();
+            }
+        }
+    };
+
+    State state;
+    state.results.resize(tasks.size());
+    co_await Join{state, tasks};
+    if (state.error) std::rethrow_exception(state.error);
+
+    std::vector<T> results;
+    results.reserve(state.results.size());
+    for (auto& result : state.results) {
+        results.push_back(std::move(*result));
+    }
+    co_return results;
+}
+
+// Starts a task and returns a future for its result, for callers that are
+// not coroutines themselves. The task begins on the calling thread.
+template <typename T>
+std::future<T> spawn(AsyncTask<T> task) {
+    auto promise = std::make_shared<std::promise<T>>();
+    auto future = promise->get_future();
+    [](AsyncTask<T> task, std::shared_ptr<std::promise<T>> promise) -> detail::Detached {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+                promise->set_value();
+            } else {
+                promise->set_value(co_await task);
+            }
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    }(std::move(task), promise);
+    return future;
+}
+
+// Runs a task to completion, blocking the calling thread. Never call this
+// from a pool worker; await the task instead.
+template <typename T>
+T syncWait(AsyncTask<T> task) {
+    return spawn(std::move(task)).get();
+}
+
+}
+
+#endif
@@ -49,6 +49,12 @@ public:
     double getPopularityScore() const;
     bool isHighlyRated() const;
     int getPublicationYear() const;
+
+    // Score formulas shared with column-oriented views such as BookCatalog
+    static double engagementScore(double average_rating, int ratings_count, int review_count);
+    static double popularityScore(double average_rating, int ratings_count);
+    static bool isHighlyRated(double average_rating, int ratings_count);
+    static int publicationYear(const std::string& publication_date);
     
     // Serialization
     nlohmann::json toJson() const;
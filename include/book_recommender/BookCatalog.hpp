@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Book.hpp"
+
+namespace book_recommender {
+
+// Deduplicated strings addressed by a dense id. Strings live in a deque so
+// references handed out stay valid as the pool grows.
+class StringPool {
+public:
+    uint32_t intern(const std::string& value);
+    std::optional<uint32_t> find(std::string_view value) const;
+
+    const std::string& get(uint32_t id) const { return strings_[id]; }
+    size_t size() const { return strings_.size(); }
+    size_t memoryUsage() const;
+
+private:
+    std::deque<std::string> strings_;
+    std::unordered_map<std::string_view, uint32_t> ids_;
+};
+
+class BookCatalog;
+
+// Read-only handle on one catalog row. Getters mirror Book; text fields
+// come back as views into the catalog, which stay valid until the catalog
+// is next modified.
+class BookView {
+public:
+    BookView(const BookCatalog& catalog, uint32_t row) : catalog_(&catalog), row_(row) {}
+
+    uint32_t row() const { return row_; }
+
+    std::string_view getId() const;
+    std::string_view getTitle() const;
+    const std::string& getAuthor() const;
+    std::vector<std::string_view> getGenres() const;
+    std::string_view getDescription() const;
+    int getPageCount() const;
+    double getAverageRating() const;
+    int getRatingsCount() const;
+    int getReviewCount() const;
+    std::optional<std::string_view> getSeries() const;
+    const std::string& getLanguage() const;
+    const std::string& getPublisher() const;
+    std::string_view getPublicationDate() const;
+    std::string_view getIsbn13() const;
+    bool isEbook() const;
+
+    double getEngagementScore() const;
+    double getPopularityScore() const;
+    bool isHighlyRated() const;
+    int getPublicationYear() const;
+
+    Book toBook() const;
+
+private:
+    const BookCatalog* catalog_;
+    uint32_t row_;
+};
+
+// Column-oriented book storage. Numeric fields sit in contiguous arrays so
+// analytic scans (top rated, genre and author counts) stream through memory;
+// repeated strings (authors, genres, languages, publishers) are interned,
+// and free text is packed into a single heap.
+class BookCatalog {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = BookView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = BookView;
+
+        const_iterator(const BookCatalog& catalog, uint32_t row) : catalog_(&catalog), row_(row) {}
+
+        BookView operator*() const { return BookView(*catalog_, row_); }
+        BookView operator[](difference_type n) const {
+            return BookView(*catalog_, static_cast<uint32_t>(row_ + n));
+        }
+        const_iterator& operator++() { ++row_; return *this; }
+        const_iterator operator++(int) { auto copy = *this; ++row_; return copy; }
+        const_iterator& operator--() { --row_; return *this; }
+        const_iterator operator--(int) { auto copy = *this; --row_; return copy; }
+        const_iterator& operator+=(difference_type n) { row_ = static_cast<uint32_t>(row_ + n); return *this; }
+        const_iterator& operator-=(difference_type n) { row_ = static_cast<uint32_t>(row_ - n); return *this; }
+        const_iterator operator+(difference_type n) const { auto copy = *this; return copy += n; }
+        const_iterator operator-(difference_type n) const { auto copy = *this; return copy -= n; }
+        difference_type operator-(const const_iterator& other) const {
+            return static_cast<difference_type>(row_) - static_cast<difference_type>(other.row_);
+        }
+        bool operator==(const const_iterator& other) const { return row_ == other.row_; }
+        bool operator!=(const const_iterator& other) const { return row_ != other.row_; }
+        bool operator<(const const_iterator& other) const { return row_ < other.row_; }
+
+    private:
+        const BookCatalog* catalog_;
+        uint32_t row_;
+    };
+
+    // Replaces the contents of the catalog
+    void assign(const std::vector<Book>& books);
+
+    // Inserts the book, or overwrites the row that already has its id
+    void upsert(const Book& book);
+    bool remove(const std::string& id);
+    void clear();
+
+    size_t size() const { return text_.size(); }
+    bool empty() const { return text_.empty(); }
+    std::optional<BookView> find(const std::string& id) const;
+    BookView operator[](uint32_t row) const { return BookView(*this, row); }
+
+    const_iterator begin() const { return const_iterator(*this, 0); }
+    const_iterator end() const { return const_iterator(*this, static_cast<uint32_t>(size())); }
+
+    // Raw columns for scans; indexed by row
+    const std::vector<double>& averageRatings() const { return average_ratings_; }
+    const std::vector<int32_t>& ratingsCounts() const { return ratings_counts_; }
+    const std::vector<int32_t>& reviewCounts() const { return review_counts_; }
+    const std::vector<int32_t>& pageCounts() const { return page_counts_; }
+    const std::vector<int16_t>& publicationYears() const { return publication_years_; }
+    const std::vector<uint32_t>& authorIds() const { return author_ids_; }
+
+    // Interned genre ids of one row
+    const uint32_t* genreIdsBegin(uint32_t row) const { return genre_ids_.data() + genre_ranges_[row].offset; }
+    const uint32_t* genreIdsEnd(uint32_t row) const { return genreIdsBegin(row) + genre_ranges_[row].length; }
+
+    const StringPool& authors() const { return authors_; }
+    const StringPool& genres() const { return genres_; }
+
+    // Approximate heap footprint of all columns, pools and the text heap
+    size_t memoryUsage() const;
+
+private:
+    friend class BookView;
+
+    // Location of a string in text_heap_
+    struct TextRef {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    static constexpr uint32_t NO_SERIES = UINT32_MAX;
+
+    struct TextFields {
+        TextRef id;
+        TextRef title;
+        TextRef description;
+        TextRef series;  // offset NO_SERIES when the book has no series
+        TextRef publication_date;
+        TextRef isbn13;
+    };
+
+    // Slice of genre_ids_ owned by a row
+    struct GenreRange {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    // Replaced and removed rows leave garbage behind in the text heap and
+    // genre pool; both are compacted once garbage outweighs live data
+    std::string text_heap_;
+    size_t dead_text_bytes_ = 0;
+    size_t dead_genre_ids_ = 0;
+
+    std::vector<TextFields> text_;
+    std::unordered_map<std::string, uint32_t> row_by_id_;
+
+    std::vector<double> average_ratings_;
+    std::vector<int32_t> ratings_counts_;
+    std::vector<int32_t> review_counts_;
+    std::vector<int32_t> page_counts_;
+    std::vector<int16_t> publication_years_;
+    std::vector<uint8_t> is_ebook_;
+
+    std::vector<uint32_t> author_ids_;
+    std::vector<uint32_t> language_ids_;
+    std::vector<uint32_t> publisher_ids_;
+    std::vector<GenreRange> genre_ranges_;
+    std::vector<uint32_t> genre_ids_;
+
+    StringPool authors_;
+    StringPool genres_;
+    StringPool languages_;
+    StringPool publishers_;
+
+    TextRef appendText(const std::string& value);
+    std::string_view text(TextRef ref) const;
+    size_t textBytes(const TextFields& fields) const;
+
+    GenreRange appendGenres(const std::vector<std::string>& genres);
+    void append(const Book& book);
+    void overwrite(uint32_t row, const Book& book);
+    void retire(uint32_t row);
+    void moveRow(uint32_t from, uint32_t to);
+    void popRow();
+    void compact();
+};
+
+}
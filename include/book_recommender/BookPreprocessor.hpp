@@ -3,8 +3,14 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
 #include "Book.hpp"
 #include "Document.hpp"
+#include "EditDistance.hpp"
+#include "TextAnalysis.hpp"
+#include "TextNormalizer.hpp"
 
 namespace book_recommender {
 
@@ -15,11 +21,26 @@ public:
     // Main preprocessing function
     Document createDocument(const Book& book);
 
-    // Text preprocessing
+    // Index terms of `text`: normalizeText, then forEachTerm (stop words
+    // dropped, the rest stemmed). Meant for term matching, not embedding.
+    // BookQueryEngine::preprocessQuery only normalizes, so the two do not
+    // produce comparable text.
     std::string preprocessText(const std::string& text);
     std::string combineBookText(const Book& book);
 
-    // Genre handling
+    // Texts for a book's per-field vectors, each embedded separately:
+    // "title" (title and author), "description" (overlapping chunks of the
+    // description) and "genres" (the normalized genre tags). Short fields
+    // then match short queries without being diluted by a long description.
+    std::map<std::string, std::vector<std::string>> createFieldTexts(const Book& book);
+
+    // Splits text into windows of at most `max_words` words, each starting
+    // `max_words - overlap` words after the previous one, so a sentence
+    // crossing a boundary appears whole in at least one chunk
+    static std::vector<std::string> chunkText(const std::string& text, size_t max_words = 128, size_t overlap = 32);
+
+    // Genre handling. Results are memoized per raw genre string, so a
+    // genre seen before costs one hash lookup.
     std::vector<std::string> normalizeGenres(const std::vector<std::string>& genres);
     void updateGenreMapping(const std::string& raw_genre, const std::string& normalized_genre);
 
@@ -31,15 +52,27 @@ private:
     std::map<std::string, std::string> genre_mapping_;
     std::vector<std::string> standard_genres_;
 
+    // Standard genres keyed by their normalized form (see genreKey), and a
+    // BK-tree over those keys whose node i is standard_genres_[i]
+    std::unordered_map<std::string, std::string> standard_genre_keys_;
+    BKTree standard_genre_index_;
+    size_t longest_genre_key_ = 0;
+
+    // Raw genre -> standard genre ("" for genres that normalize to nothing).
+    // Cleared whenever the mappings change, which also bumps the generation
+    // so lookups that started before the change don't insert stale results.
+    // genre_mutex_ guards genre_mapping_ and both of these.
+    std::unordered_map<std::string, std::string> genre_cache_;
+    uint64_t genre_cache_generation_ = 0;
+    std::mutex genre_mutex_;
+
     // Text preprocessing helpers
-    std::string removePunctuation(const std::string& text);
     std::string toLowerCase(const std::string& text);
-    std::string removeStopWords(const std::string& text);
-    std::string stemWords(const std::string& text);
     
     // Genre helpers
+    std::string genreKey(const std::string& genre);
+    std::string resolveGenre(const std::string& raw_genre);
     std::string findClosestGenre(const std::string& raw_genre);
-    double calculateGenreSimilarity(const std::string& genre1, const std::string& genre2);
     
     // Initialize standard genres and mappings
     void initializeGenreMappings();
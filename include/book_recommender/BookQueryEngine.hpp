@@ -1,23 +1,34 @@
 #pragma once
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <optional>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "Book.hpp"
 #include "BookVectorStore.hpp"
+#include "GenreTaxonomy.hpp"
+#include "SimilarBooksIndex.hpp"
+#include "AsyncTask.hpp"
+#include "TaskExecutor.hpp"
+#include "UserProfileStore.hpp"
 
 namespace book_recommender {
 
 class BookQueryEngine {
 public:
+    // Books are shared, immutable records; copying a result never copies
+    // the book's description or genre list
     struct RecommendationResult {
-        Book book;
+        std::shared_ptr<const Book> book;
         float similarity_score;
         std::string explanation;
     };
 
     struct QueryFilter {
+        // Matches books in any of these genres or their sub-genres
         std::optional<std::vector<std::string>> genres;
         std::optional<double> min_rating;
         std::optional<double> max_rating;
@@ -27,6 +38,19 @@ public:
         std::optional<std::string> language;
         std::optional<bool> ebook_only;
         std::optional<std::vector<std::string>> authors;
+
+        // Canonical encoding; filters that select the same books compare equal
+        std::string digest() const;
+    };
+
+    // Progress callbacks for streamRecommendations. Both are optional, and
+    // calls never overlap, so they need no locking of their own.
+    struct RecommendationStream {
+        // The ranked results as soon as ranking is done, explanations empty
+        std::function<void(const std::vector<RecommendationResult>&)> on_results;
+        // Result `index` of that list with its explanation filled in, in
+        // the order the explanations complete
+        std::function<void(size_t index, const RecommendationResult& result)> on_explanation;
     };
 
     BookQueryEngine(std::shared_ptr<BookVectorStore> vector_store);
@@ -38,12 +62,70 @@ public:
         int top_k = 5
     );
 
+    // getRecommendations that reports progress: results are handed to
+    // `stream` right after ranking, then each explanation as it arrives.
+    // Returns the complete results, like getRecommendations.
+    std::vector<RecommendationResult> streamRecommendations(
+        const std::string& query,
+        const RecommendationStream& stream,
+        const QueryFilter& filter = {},
+        int top_k = 5
+    );
+
+    // Bulk variant of getRecommendations for offline jobs: all queries share
+    // one vector search. Result i belongs to queries[i]; a query that fails
+    // to embed yields an empty list without failing the batch.
+    std::vector<std::vector<RecommendationResult>> getRecommendationsBatch(
+        const std::vector<std::string>& queries,
+        const QueryFilter& filter = {},
+        int top_k = 5
+    );
+
+#ifdef BOOK_RECOMMENDER_COROUTINES
+    // Coroutine form of getRecommendations for servers holding many queries
+    // in flight: enhance, embed and explain suspend on their Groq calls
+    // rather than blocking a thread, and the CPU stages run on the task
+    // executor at `priority`. Arguments are taken by value because they must
+    // outlive the caller's frame.
+    AsyncTask<std::vector<RecommendationResult>> getRecommendationsAsync(
+        std::string query,
+        QueryFilter filter = {},
+        int top_k = 5,
+        TaskPriority priority = TaskPriority::Interactive
+    );
+#endif
+
     std::vector<RecommendationResult> getSimilarBooks(
         const std::string& book_id,
         const QueryFilter& filter = {},
         int top_k = 5
     );
 
+    // Unread books nearest the reader's interests (see UserProfileStore)
+    std::vector<RecommendationResult> getPersonalizedRecommendations(
+        const UserProfileStore& profiles,
+        const UserProfile& profile,
+        const QueryFilter& filter = {},
+        int top_k = 5
+    );
+
+    // getSimilarBooks answers from the graph when it covers the book and
+    // falls back to a live vector search otherwise. Pass nullptr to detach.
+    void setSimilarityGraph(std::shared_ptr<const SimilarityGraph> graph);
+
+    // How query searches fuse per-field similarities once the store holds
+    // field vectors; without them queries search the main index alone
+    void setFusionOptions(const BookVectorStore::FusionOptions& fusion);
+
+    // Genre hierarchy used by genre filters; defaults to
+    // GenreTaxonomy::defaultTaxonomy()
+    void setGenreTaxonomy(std::shared_ptr<const GenreTaxonomy> taxonomy);
+
+    // Keep the precomputed graph and the book cache consistent with catalog
+    // changes; call after the vector store has been updated
+    void onBookUpserted(const std::string& book_id);
+    void onBookRemoved(const std::string& book_id);
+
     std::vector<RecommendationResult> getAuthorRecommendations(
         const std::string& author,
         const QueryFilter& filter = {},
@@ -56,14 +138,61 @@ public:
         int top_k = 5
     );
 
+    // Queries on the calling thread that failed and came back empty. A
+    // caller compares the count before and after a call to tell a failure
+    // from a genuinely empty answer.
+    static uint64_t getThreadFailureCount();
+
 private:
     std::shared_ptr<BookVectorStore> vector_store_;
+    std::shared_ptr<SimilarBooksIndex> similar_books_;  // accessed with std::atomic_load/store
+    std::shared_ptr<const BookVectorStore::FusionOptions> fusion_;  // accessed with std::atomic_load/store
+    std::shared_ptr<const GenreTaxonomy> taxonomy_;  // accessed with std::atomic_load/store
+
+    // Books materialized from indexed documents, reused until the document
+    // is replaced or removed from the store
+    struct CachedBook {
+        std::weak_ptr<const Document> source;
+        std::shared_ptr<const Book> book;
+        // The book's genres as taxonomy ids, valid for `taxonomy`
+        std::shared_ptr<const GenreSet> genres;
+        std::shared_ptr<const GenreTaxonomy> taxonomy;
+    };
+    mutable std::mutex book_cache_mutex_;
+    mutable std::unordered_map<std::string, CachedBook> book_cache_;
+    void forgetBook(const std::string& book_id);
 
     // Query processing
     std::string enhanceQuery(const std::string& query) const;
+    std::string preprocessQuery(const std::string& query) const;
     std::vector<float> vectorizeQuery(const std::string& query) const;
     bool passesFilter(const Book& book, const QueryFilter& filter) const;
+
+    // The genre part of a filter, resolved against the taxonomy once per
+    // request so that checking a candidate is a bitset intersection
+    struct GenreFilter {
+        bool active = false;
+        GenreSet accepted;
+        // Filter genres the taxonomy does not know, matched by name
+        std::vector<std::string> unknown;
+    };
+    static GenreFilter compileGenreFilter(const QueryFilter& filter, const GenreTaxonomy& taxonomy);
+    bool passesFilter(
+        const Book& book,
+        const GenreSet& book_genres,
+        const QueryFilter& filter,
+        const GenreFilter& genre_filter
+    ) const;
     std::string generateExplanation(const Book& book, const std::string& query) const;
+    std::string describeBook(const Book& book) const;
+    std::string fallbackExplanation(const Book& book) const;
+#ifdef BOOK_RECOMMENDER_COROUTINES
+    AsyncTask<std::string> explainAsync(
+        std::shared_ptr<const Book> book,
+        std::string query,
+        TaskPriority priority
+    ) const;
+#endif
     
     // Sorting and ranking
     void rankResults(std::vector<RecommendationResult>& results) const;
@@ -71,11 +200,30 @@ private:
     double calculateRelevanceScore(const Book& book, const std::string& query) const;
     
     // Helper methods
+    std::shared_ptr<const Book> getBook(const std::shared_ptr<const Document>& document) const;
+    CachedBook getCachedBook(const std::shared_ptr<const Document>& document) const;
+    static Book bookFromDocument(const Document& document);
+    template <typename SearchResults>
     std::vector<RecommendationResult> processSearchResults(
-        const std::vector<BookVectorStore::SearchResult>& results,
-        const std::string& query,
+        const SearchResults& results,
         const QueryFilter& filter
     ) const;
+    bool neighborsFromGraph(
+        const SimilarBooksIndex& index,
+        const std::string& book_id,
+        int top_k,
+        std::pmr::vector<BookVectorStore::SearchResult>& results
+    ) const;
+    void addExplanations(
+        std::vector<RecommendationResult>& recommendations,
+        const std::string& query,
+        TaskPriority priority = TaskPriority::Interactive,
+        const std::function<void(size_t index)>& on_explained = nullptr
+    ) const;
+    std::string joinStrings(
+        const std::vector<std::string>& strings,
+        const std::string& delimiter
+    ) const;
 };
 
 }
\ No newline at end of file
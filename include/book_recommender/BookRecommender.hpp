@@ -2,9 +2,17 @@
 
 #include <string>
 #include <memory>
+#include <atomic>
+#include <functional>
+#include "BookCatalog.hpp"
 #include "BookDataLoader.hpp"
 #include "BookQueryEngine.hpp"
 #include "BookVectorStore.hpp"
+#include "ConcurrencyLimiter.hpp"
+#include "IndexBundle.hpp"
+#include "ResponseCache.hpp"
+#include "SingleFlight.hpp"
+#include "UserProfileStore.hpp"
 
 namespace book_recommender {
 
@@ -17,24 +25,91 @@ public:
         std::string language_filter = "en";
         int min_ratings = 100;
         bool load_existing_index = true;
+        double trace_sample_rate = 0.0;    // 0 disables tracing
+        std::string trace_output_path = "traces.jsonl";
+        std::string similarity_graph_path;  // empty: similar books always use live search
+        std::string genre_taxonomy_path;    // empty: GenreTaxonomy::defaultTaxonomy()
+        size_t response_cache_bytes = 64 * 1024 * 1024;  // 0 disables response caching
+        int response_cache_ttl_seconds = 300;
+        int negative_cache_ttl_seconds = 30;
+        // Non-empty: attach read-only to the bundles a loader publishes here
+        // instead of loading the catalog and building indexes in-process
+        std::string index_bundle_dir;
+        // Admission control: the number of requests computed at once adapts
+        // between the concurrency limits, and requests that cannot get a
+        // slot within their queue timeout fail with OverloadError
+        bool admission_control = true;
+        int concurrency_limit = 20;
+        int max_concurrency_limit = 200;
+        size_t max_queued_requests = 256;
+        int interactive_queue_timeout_ms = 50;
+        int background_queue_timeout_ms = 2000;
+        // Reader profiles for personalized recommendations: up to
+        // max_user_interests interest clusters each, with the least recently
+        // used profiles evicted beyond max_user_profiles
+        size_t max_user_profiles = 100000;
+        size_t max_user_interests = 4;
     };
 
     explicit BookRecommender(const RecommenderConfig& config = RecommenderConfig{});
     ~BookRecommender();
 
-    // Core recommendation methods
+    // Core recommendation methods. When admission control sheds a request
+    // these throw OverloadError; any other failure yields an empty result.
     std::vector<BookQueryEngine::RecommendationResult> getRecommendations(
         const std::string& query,
         const BookQueryEngine::QueryFilter& filter = {},
         int top_k = 5
     );
 
+    // getRecommendations with progress callbacks (see BookQueryEngine). A
+    // cached answer is replayed through the same callbacks. Streamed
+    // requests are never coalesced with others.
+    std::vector<BookQueryEngine::RecommendationResult> streamRecommendations(
+        const std::string& query,
+        const BookQueryEngine::RecommendationStream& stream,
+        const BookQueryEngine::QueryFilter& filter = {},
+        int top_k = 5
+    );
+
+#ifdef BOOK_RECOMMENDER_COROUTINES
+    // Non-blocking getRecommendations for callers that are coroutines or
+    // hold many requests in flight (use spawn() to get a future). Served
+    // from and stored into the response cache, but misses are not
+    // coalesced, since joining another request would block a thread.
+    AsyncTask<std::vector<BookQueryEngine::RecommendationResult>> getRecommendationsAsync(
+        std::string query,
+        BookQueryEngine::QueryFilter filter = {},
+        int top_k = 5
+    );
+#endif
+
+    std::vector<std::vector<BookQueryEngine::RecommendationResult>> getRecommendationsBatch(
+        const std::vector<std::string>& queries,
+        const BookQueryEngine::QueryFilter& filter = {},
+        int top_k = 5
+    );
+
     std::vector<BookQueryEngine::RecommendationResult> getSimilarBooks(
         const std::string& book_id,
         const BookQueryEngine::QueryFilter& filter = {},
         int top_k = 5
     );
 
+    // Personalized recommendations from the reader's history, never
+    // including books they have read. Empty for readers without a history.
+    std::vector<BookQueryEngine::RecommendationResult> getPersonalizedRecommendations(
+        const std::string& user_id,
+        const BookQueryEngine::QueryFilter& filter = {},
+        int top_k = 5
+    );
+
+    // Reading histories. The loader is consulted for readers whose profile
+    // is not in memory; set it before serving.
+    void setReadingHistoryLoader(UserProfileStore::HistoryLoader loader);
+    void setReadingHistory(const std::string& user_id, const std::vector<ReadEvent>& history);
+    void recordRead(const std::string& user_id, const std::string& book_id, float weight = 1.0f);
+
     // Specialized recommendation methods
     std::vector<BookQueryEngine::RecommendationResult> getAuthorRecommendations(
         const std::string& author,
@@ -49,7 +124,7 @@ public:
     );
 
     // Book search and filtering
-    std::vector<Book> searchBooks(
+    std::vector<std::shared_ptr<const Book>> searchBooks(
         const std::string& query,
         const BookQueryEngine::QueryFilter& filter = {}
     );
@@ -62,15 +137,36 @@ public:
     void saveIndex(const std::string& path);
     void loadIndex(const std::string& path);
     void rebuildIndex();
+    void loadSimilarityGraph(const std::string& path);
     void updateBook(const Book& book);
     void removeBook(const std::string& book_id);
 
+    // Multi-process serving. The loader publishes its catalog and vectors
+    // as an immutable bundle; workers configured with index_bundle_dir
+    // attach to it and call refreshIndexBundle() to follow new generations.
+    uint64_t publishIndexBundle(const std::string& dir, size_t keep = 2) const;
+    bool refreshIndexBundle();
+
 private:
     RecommenderConfig config_;
     std::unique_ptr<BookDataLoader> data_loader_;
     std::shared_ptr<BookVectorStore> vector_store_;
     std::unique_ptr<BookQueryEngine> query_engine_;
-    std::vector<Book> books_;
+    std::unique_ptr<UserProfileStore> profiles_;
+    BookCatalog catalog_;
+    std::unique_ptr<BundleDirectory> bundles_;  // set in attached mode
+
+    using Recommendations = std::vector<BookQueryEngine::RecommendationResult>;
+
+    // Identical concurrent recommendation requests share one computation
+    SingleFlight<std::string, Recommendations> inflight_;
+
+    // Admission control; null when disabled
+    std::unique_ptr<ConcurrencyLimiter> limiter_;
+
+    // Finished answers, valid until the catalog version moves on
+    ResponseCache<Recommendations> response_cache_;
+    std::atomic<uint64_t> catalog_version_{0};
 
     // Initialization
     void initialize();
@@ -82,6 +178,21 @@ private:
     void validateConfig() const;
     std::string getDefaultIndexPath() const;
     void processBooks(const std::vector<Book>& books);
+    void bumpCatalogVersion();
+    Recommendations serveRecommendations(
+        const std::string& key,
+        const std::function<Recommendations()>& compute,
+        bool& coalesced,
+        bool& cache_hit
+    );
+    Recommendations computeRecommendations(
+        const std::string& key,
+        uint64_t version,
+        const std::function<Recommendations()>& compute
+    );
+    ConcurrencyLimiter::Permit admit(TaskPriority priority);
+    std::shared_ptr<const Recommendations> cachedRecommendations(const std::string& key, uint64_t version);
+    void storeRecommendations(const std::string& key, const Recommendations& results, uint64_t version);
     void updatePopularityMetrics();
 };
 
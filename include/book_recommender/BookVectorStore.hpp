@@ -4,19 +4,61 @@
 #include <vector>
 #include <memory>
 #include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_set>
 #include <faiss/IndexFlat.h>
 #include <faiss/IndexIVFFlat.h>
 #include <faiss/utils/distances.h>
 #include "Document.hpp"
+#include "IndexBundle.hpp"
+#include "SimilarityGraph.hpp"
+#include "VectorKernels.hpp"
 
 namespace book_recommender {
 
 class BookVectorStore {
 public:
+    // Documents are immutable once indexed and shared between the store, the
+    // cache and every result that references them
     struct SearchResult {
         std::string doc_id;
         float similarity;
-        Document document;
+        std::shared_ptr<const Document> document;
+    };
+
+    struct CacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    // How per-field similarities combine into one score. Each field scores
+    // its best-matching vector (max-sim), so one strong description chunk
+    // is enough to surface a book.
+    enum class FusionMode {
+        // Best single field; weights only select which fields take part
+        MaxSim,
+        // Weighted mean over the fields a book has vectors for
+        WeightedSum
+    };
+
+    struct FusionOptions {
+        // "combined" is the document's main embedding; the other keys are
+        // the field names documents were indexed with. Fields without a
+        // positive weight are ignored.
+        std::map<std::string, float> field_weights{
+            {"combined", 0.4f}, {"title", 0.3f}, {"description", 0.3f}
+        };
+        FusionMode mode = FusionMode::WeightedSum;
+        // Nearest vectors fetched from each field's index before fusion;
+        // 0 means 4 * top_k
+        int candidates_per_field = 0;
     };
 
     BookVectorStore(int dimension = 384, int cache_size = 1000);
@@ -31,14 +73,86 @@ public:
     // Search operations
     std::vector<SearchResult> search(const std::vector<float>& query_vector, int top_k = 5, bool use_approximate = false);
     std::vector<SearchResult> searchSimilar(const std::string& doc_id, int top_k = 5);
+
+    // Same searches, with the result list and scratch buffers allocated from
+    // `resource` (normally a per-request RequestArena)
+    std::pmr::vector<SearchResult> search(
+        const std::vector<float>& query_vector,
+        int top_k,
+        bool use_approximate,
+        std::pmr::memory_resource* resource
+    );
+    std::pmr::vector<SearchResult> searchSimilar(
+        const std::string& doc_id,
+        int top_k,
+        std::pmr::memory_resource* resource
+    );
+
+    // Late-fusion search over the per-field sub-indexes. Candidates are
+    // gathered from every weighted field, then each candidate is scored
+    // exactly on all of its fields before fusing. Falls back to the plain
+    // search when no document has field vectors or a bundle is attached.
+    // Not cached.
+    std::vector<SearchResult> search(
+        const std::vector<float>& query_vector,
+        int top_k,
+        const FusionOptions& fusion
+    );
+    std::pmr::vector<SearchResult> search(
+        const std::vector<float>& query_vector,
+        int top_k,
+        const FusionOptions& fusion,
+        std::pmr::memory_resource* resource
+    );
     
     // Batch operations
     void batchAddDocuments(const std::vector<Document>& documents, int batch_size = 100);
+    // Runs every query through one FAISS call and materializes the per-query
+    // results in parallel. Bypasses the search cache, since bulk queries are
+    // rarely repeated and would only evict interactive entries.
+    std::vector<std::vector<SearchResult>> batchSearch(
+        const std::vector<std::vector<float>>& query_vectors,
+        int top_k = 5,
+        bool use_approximate = false
+    );
+
+    // batchSearch with the late-fusion scoring of the FusionOptions search,
+    // one fused search per query. Falls back to the plain batchSearch under
+    // the same conditions.
     std::vector<std::vector<SearchResult>> batchSearch(
         const std::vector<std::vector<float>>& query_vectors,
-        int top_k = 5
+        int top_k,
+        const FusionOptions& fusion
     );
 
+    // batchSearch where the documents in `exclude` never appear in any
+    // query's results. FAISS skips them through a bitmap selector during the
+    // scan, so a long exclusion list costs no extra candidates.
+    std::vector<std::vector<SearchResult>> batchSearchExcluding(
+        const std::vector<std::vector<float>>& query_vectors,
+        const std::unordered_set<std::string>& exclude,
+        int top_k = 5,
+        bool use_approximate = false
+    );
+
+    // All-pairs top-k over the whole index, searched in blocks of
+    // `block_size` queries so the flat index runs GEMM tiles
+    SimilarityGraph buildSimilarityGraph(int k, size_t block_size = 1024, bool use_approximate = false) const;
+
+    std::shared_ptr<const Document> getDocument(const std::string& doc_id) const;
+    size_t size() const;
+    int dimension() const { return dimension_; }
+    // Whether any indexed document carries per-field vectors
+    bool hasFieldVectors() const;
+
+    // Copies the stored embedding of `doc_id` into `out`; false if unknown
+    bool getVector(const std::string& doc_id, float* out) const;
+
+    // Serves searches and document lookups from a mapped bundle instead of
+    // the in-process indexes; pass nullptr to detach. Clears the cache.
+    void attachBundle(std::shared_ptr<const IndexBundle> bundle);
+    std::shared_ptr<const IndexBundle> attachedBundle() const { return std::atomic_load(&bundle_); }
+
     // Index management
     void optimizeIndex();
     void saveIndex(const std::string& path);
@@ -47,44 +161,84 @@ public:
     // Cache management
     void clearCache();
     void setCacheSize(int size);
+    CacheStats getCacheStats() const;
+    // Lookups performed by the calling thread, for per-operation attribution
+    static CacheStats getThreadCacheStats();
 
 private:
     // Index configuration
     int dimension_;
     int cache_size_;
     bool is_trained_;
+    VectorKernels kernels_;  // picked for dimension_ at construction
 
     // FAISS indices
     std::unique_ptr<faiss::IndexFlatIP> flat_index_;
     std::unique_ptr<faiss::IndexIVFFlat> ivf_index_;
+
+    // One flat sub-index per named field. `owners` maps each row back to its
+    // document and `rows` lists the rows each document holds, so removal
+    // can swap rows out without scanning the whole field.
+    struct FieldIndex {
+        std::unique_ptr<faiss::IndexFlatIP> index;
+        std::vector<std::string> owners;
+        std::unordered_map<std::string, std::vector<size_t>> rows;
+    };
+    std::map<std::string, FieldIndex> field_indexes_;
     
     // Document storage
-    std::unordered_map<std::string, Document> document_store_;
+    std::unordered_map<std::string, std::shared_ptr<const Document>> document_store_;
     std::unordered_map<std::string, size_t> doc_id_to_index_;
     std::vector<std::string> index_to_doc_id_;
+    mutable std::shared_mutex index_mutex_;
+
+    // When set, takes over from the FAISS indexes and document store
+    std::shared_ptr<const IndexBundle> bundle_;
 
     // Cache for search results
     struct CacheEntry {
-        std::vector<SearchResult> results;
+        std::shared_ptr<const std::vector<SearchResult>> results;
         std::chrono::system_clock::time_point timestamp;
     };
     std::unordered_map<std::string, CacheEntry> search_cache_;
+    uint64_t cache_generation_ = 0;  // bumped by clearCache
+    mutable std::mutex cache_mutex_;
+    mutable std::atomic<uint64_t> cache_hits_{0};
+    mutable std::atomic<uint64_t> cache_misses_{0};
 
     // Helper methods
     void initializeFlatIndex();
     void initializeIVFIndex();
+    void validateDocument(const Document& doc) const;
     std::vector<float> getDocumentVector(const Document& doc) const;
     void updateDocumentMapping(const std::string& doc_id, size_t index);
-    std::vector<SearchResult> processSearchResults(
+    void removeDocumentLocked(const std::string& doc_id);
+    void addFieldVectorsLocked(const Document& doc);
+    float fieldSimilarity(const Document& doc, const std::string& field, const float* query) const;
+    std::pmr::vector<SearchResult> fusedSearch(
+        const std::vector<float>& query_vector,
+        int top_k,
+        const FusionOptions& fusion,
+        std::pmr::memory_resource* resource
+    ) const;
+    std::pmr::vector<SearchResult> processSearchResults(
         const float* distances,
         const faiss::idx_t* indices,
-        size_t n_results
+        size_t n_results,
+        std::pmr::memory_resource* resource
     ) const;
+    static std::pmr::vector<SearchResult> processBundleResults(
+        const IndexBundle& bundle,
+        const float* scores,
+        const int64_t* rows,
+        size_t n_results,
+        std::pmr::memory_resource* resource
+    );
     
     // Cache helpers
     std::string generateCacheKey(const std::vector<float>& query_vector, int top_k) const;
-    void addToCache(const std::string& key, const std::vector<SearchResult>& results);
-    std::optional<std::vector<SearchResult>> getFromCache(const std::string& key) const;
+    void addToCache(const std::string& key, const std::pmr::vector<SearchResult>& results, uint64_t generation);
+    bool getFromCache(const std::string& key, std::pmr::vector<SearchResult>& results, uint64_t& generation) const;
     void cleanupCache();
 };
 
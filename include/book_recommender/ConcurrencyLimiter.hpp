@@ -0,0 +1,131 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include "TaskExecutor.hpp"
+
+namespace book_recommender {
+
+// Thrown when admission control turns a request away. Callers should back
+// off for at least retry_after before trying again.
+class OverloadError : public std::runtime_error {
+public:
+    OverloadError(const std::string& message, std::chrono::milliseconds retry_after)
+        : std::runtime_error(message), retry_after_(retry_after) {}
+
+    std::chrono::milliseconds retryAfter() const { return retry_after_; }
+
+private:
+    std::chrono::milliseconds retry_after_;
+};
+
+struct ConcurrencyLimiterConfig {
+    int initial_limit = 20;
+    int min_limit = 4;
+    int max_limit = 200;
+    // Requests waiting for a slot, over all priorities
+    size_t max_queued = 256;
+    // How long a request may wait for a slot before it is shed. Interactive
+    // callers would rather fail fast than sit behind a backlog.
+    std::chrono::milliseconds interactive_queue_timeout{50};
+    std::chrono::milliseconds background_queue_timeout{2000};
+    // Forget the no-load latency every this many samples, so that the
+    // baseline can rise again after a permanent slowdown (a bigger catalog,
+    // a slower Groq model)
+    uint64_t baseline_reset_samples = 5000;
+};
+
+// Adaptive concurrency limit in the style of TCP Vegas. The latency of an
+// uncontended request is tracked as a baseline; a request that took longer
+// means work queued somewhere downstream (Groq, FAISS, the executor), with
+// roughly limit * (1 - baseline / latency) requests' worth of backlog. The
+// limit grows while that backlog is small and shrinks when it builds up, so
+// it settles near the concurrency the backends actually sustain.
+//
+// Requests beyond the limit wait in per-priority FIFO queues. Freed slots
+// go to interactive waiters first. Requests are shed with an OverloadError
+// when the queue is full or when their queue timeout expires.
+class ConcurrencyLimiter {
+public:
+    // Holds one slot until destroyed; the time it was held is the latency
+    // sample fed back into the limit
+    class Permit {
+    public:
+        Permit() = default;
+        Permit(Permit&& other) noexcept;
+        Permit& operator=(Permit&& other) noexcept;
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+        ~Permit() { release(); }
+
+        explicit operator bool() const { return limiter_ != nullptr; }
+
+        // Returns the slot without a latency sample, for requests that
+        // failed before doing representative work
+        void abandon();
+
+    private:
+        friend class ConcurrencyLimiter;
+        Permit(ConcurrencyLimiter* limiter, std::chrono::steady_clock::time_point start)
+            : limiter_(limiter), start_(start) {}
+
+        void release();
+
+        ConcurrencyLimiter* limiter_ = nullptr;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    struct Stats {
+        int limit = 0;
+        int in_flight = 0;
+        size_t queued = 0;
+        uint64_t rejected = 0;
+    };
+
+    explicit ConcurrencyLimiter(const ConcurrencyLimiterConfig& config = {});
+
+    ConcurrencyLimiter(const ConcurrencyLimiter&) = delete;
+    ConcurrencyLimiter& operator=(const ConcurrencyLimiter&) = delete;
+
+    // Blocks until a slot is free; throws OverloadError when the request
+    // is shed instead
+    Permit acquire(TaskPriority priority = TaskPriority::Interactive);
+
+    // Never waits: throws OverloadError unless a slot is free right now.
+    // For callers that must not block a thread, such as coroutines.
+    Permit tryAcquire(TaskPriority priority = TaskPriority::Interactive);
+
+    Stats stats() const;
+
+private:
+    static constexpr size_t PRIORITY_COUNT = 2;
+
+    struct Waiter {
+        std::condition_variable ready;
+        bool granted = false;
+    };
+
+    ConcurrencyLimiterConfig config_;
+    mutable std::mutex mutex_;
+    double limit_;
+    int in_flight_ = 0;
+    std::deque<Waiter*> waiting_[PRIORITY_COUNT];
+    size_t queued_ = 0;
+    uint64_t rejected_ = 0;
+
+    std::chrono::steady_clock::duration baseline_ = std::chrono::steady_clock::duration::max();
+    uint64_t samples_ = 0;
+
+    void release(std::chrono::steady_clock::duration elapsed, bool sample);
+    void updateLimit(std::chrono::steady_clock::duration elapsed);
+    void grantWaiters();
+    [[noreturn]] void reject(TaskPriority priority, const char* reason);
+    void publishGauges() const;
+};
+
+}
@@ -12,6 +12,9 @@ class Document {
 public:
     using Metadata = std::map<std::string, nlohmann::json>;
     using Embedding = std::vector<float>;
+    // Named per-field vectors ("title", "description", "genres"); a field
+    // may hold several vectors, e.g. one per description chunk
+    using FieldEmbeddings = std::map<std::string, std::vector<Embedding>>;
     using TimePoint = std::chrono::system_clock::time_point;
 
     Document(
@@ -26,10 +29,12 @@ public:
     const std::string& getText() const { return text_; }
     const Metadata& getMetadata() const { return metadata_; }
     const std::optional<Embedding>& getEmbedding() const { return embedding_; }
+    const FieldEmbeddings& getFieldEmbeddings() const { return field_embeddings_; }
     const TimePoint& getTimestamp() const { return timestamp_; }
 
     // Setters
     void setEmbedding(Embedding embedding);
+    void setFieldEmbeddings(const std::string& field, std::vector<Embedding> embeddings);
     void updateMetadata(const Metadata& new_metadata);
 
     // Utility functions
@@ -49,6 +54,7 @@ private:
     std::string text_;
     Metadata metadata_;
     std::optional<Embedding> embedding_;
+    FieldEmbeddings field_embeddings_;
     TimePoint timestamp_;
 
     static constexpr double ENGAGEMENT_THRESHOLD = 5.0;
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace book_recommender {
+
+// Levenshtein distance. Strings of up to 64 bytes on the shorter side use
+// Myers' bit-parallel algorithm (one machine word per column, Hyyrö's
+// formulation), which is O(n) rather than O(n·m); longer ones fall back to
+// the two-row dynamic program. Works on bytes, not code points.
+size_t editDistance(std::string_view a, std::string_view b);
+
+// BK-tree over a fixed vocabulary. Edit distance is a metric, so a subtree
+// whose edge label differs from the query's distance to its root by more
+// than the search radius cannot hold a match and is skipped.
+class BKTree {
+public:
+    // Called for each word within the radius with its insertion index and
+    // distance; returns the radius to continue with, so a nearest-neighbour
+    // search can tighten it as better matches turn up
+    using Visitor = std::function<size_t(size_t index, size_t distance)>;
+
+    // Returns the word's insertion index; duplicates keep their first index
+    size_t insert(std::string word);
+    void search(std::string_view query, size_t radius, const Visitor& visit) const;
+
+    const std::string& word(size_t index) const { return nodes_[index].word; }
+    size_t size() const { return nodes_.size(); }
+
+private:
+    struct Node {
+        std::string word;
+        std::vector<std::pair<size_t, size_t>> children;  // (distance, node index)
+    };
+
+    std::vector<Node> nodes_;
+};
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace book_recommender {
+
+// Dense bitset over taxonomy genre ids
+class GenreSet {
+public:
+    GenreSet() = default;
+    explicit GenreSet(size_t genre_count) : words_((genre_count + 63) / 64, 0) {}
+
+    void insert(uint32_t id) { words_[id >> 6] |= uint64_t{1} << (id & 63); }
+    bool contains(uint32_t id) const {
+        return (id >> 6) < words_.size() && (words_[id >> 6] >> (id & 63)) & 1;
+    }
+
+    void merge(const GenreSet& other) {
+        if (other.words_.size() > words_.size()) words_.resize(other.words_.size(), 0);
+        for (size_t i = 0; i < other.words_.size(); ++i) words_[i] |= other.words_[i];
+    }
+
+    bool intersects(const GenreSet& other) const {
+        size_t n = std::min(words_.size(), other.words_.size());
+        for (size_t i = 0; i < n; ++i) {
+            if (words_[i] & other.words_[i]) return true;
+        }
+        return false;
+    }
+
+    bool empty() const {
+        for (uint64_t word : words_) {
+            if (word) return false;
+        }
+        return true;
+    }
+
+private:
+    std::vector<uint64_t> words_;
+};
+
+// Genre hierarchy (epic-fantasy ⊂ fantasy ⊂ fiction), compiled at load into
+// dense ids with the ancestor and descendant closure of every genre as a
+// bitset. A genre may have several parents; cycles are rejected. Names are
+// matched case-insensitively.
+class GenreTaxonomy {
+public:
+    using GenreId = uint32_t;
+    // (child, parent)
+    using Edge = std::pair<std::string, std::string>;
+
+    // `genres` adds standalone genres that appear in no edge
+    explicit GenreTaxonomy(const std::vector<Edge>& edges, const std::vector<std::string>& genres = {});
+
+    // One "child parent" pair per line, like config/genre_mappings.txt;
+    // blank lines and lines starting with '#' are skipped. A line with a
+    // single genre declares it without a parent.
+    static GenreTaxonomy loadFromFile(const std::string& path);
+
+    // The standard genres of BookPreprocessor under "fiction" and
+    // "non-fiction", plus common sub-genres
+    static GenreTaxonomy defaultTaxonomy();
+
+    std::optional<GenreId> find(std::string_view genre) const;
+    const std::string& name(GenreId id) const { return names_[id]; }
+    size_t size() const { return names_.size(); }
+
+    // Both closures include the genre itself
+    const GenreSet& ancestors(GenreId id) const { return ancestors_[id]; }
+    const GenreSet& descendants(GenreId id) const { return descendants_[id]; }
+    bool isA(GenreId genre, GenreId ancestor) const { return ancestors_[genre].contains(ancestor); }
+
+    // Ids of the known genres in `genres`; unknown names are skipped
+    GenreSet genreSet(const std::vector<std::string>& genres) const;
+
+    // Genres a filter on `genres` accepts: each genre and everything below
+    // it. A book matches when its genreSet intersects this. Names not in
+    // the taxonomy are appended to `unknown` when given.
+    GenreSet matchSet(const std::vector<std::string>& genres, std::vector<std::string>* unknown = nullptr) const;
+
+private:
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, GenreId> ids_;
+    std::vector<GenreSet> ancestors_;
+    std::vector<GenreSet> descendants_;
+
+    GenreId intern(const std::string& genre);
+};
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace book_recommender {
+
+// High dynamic range histogram with a fixed number of significant digits.
+// Values are bucketed on a log2 scale with linear sub-buckets, so recording
+// is O(1) and memory stays a few tens of KB regardless of the value range.
+// Not thread-safe; merge per-thread instances with add().
+class HdrHistogram {
+public:
+    HdrHistogram(
+        int64_t lowest_trackable_value = 1,
+        int64_t highest_trackable_value = 3600LL * 1000 * 1000,
+        int significant_digits = 3
+    );
+
+    // Recording (values above the trackable range are clamped)
+    void recordValue(int64_t value);
+    void recordValues(int64_t value, int64_t count);
+    void recordCorrectedValue(int64_t value, int64_t expected_interval);
+    void add(const HdrHistogram& other);
+    void reset();
+
+    // Statistics
+    int64_t getTotalCount() const { return total_count_; }
+    int64_t getMin() const;
+    int64_t getMax() const { return max_value_; }
+    double getMean() const;
+    int64_t getValueAtPercentile(double percentile) const;
+
+    // Bucket layout, shared with concurrent recorders that keep their own counts
+    size_t countsLength() const { return counts_.size(); }
+    size_t countsIndexFor(int64_t value) const;
+    int64_t valueFromIndex(size_t index) const;
+    int64_t countAtIndex(size_t index) const { return counts_[index]; }
+    int64_t highestEquivalentValue(int64_t value) const;
+    int64_t getHighestTrackableValue() const { return highest_trackable_value_; }
+
+private:
+    int64_t lowest_trackable_value_;
+    int64_t highest_trackable_value_;
+    int significant_digits_;
+
+    int unit_magnitude_;
+    int sub_bucket_half_count_magnitude_;
+    int64_t sub_bucket_count_;
+    int64_t sub_bucket_half_count_;
+    int64_t sub_bucket_mask_;
+    int bucket_count_;
+
+    std::vector<int64_t> counts_;
+    int64_t total_count_ = 0;
+    int64_t min_value_ = INT64_MAX;
+    int64_t max_value_ = 0;
+
+    int getBucketIndex(int64_t value) const;
+    int64_t lowestEquivalentValue(int64_t value) const;
+    int64_t sizeOfEquivalentValueRange(int64_t value) const;
+};
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+#include "WorkerPool.hpp"
+
+namespace web::http {
+class http_request;
+}
+
+namespace web::http::experimental::listener {
+class http_listener;
+}
+
+namespace book_recommender {
+
+struct HttpServerConfig {
+    std::string address = "0.0.0.0";
+    int port = 8080;
+    size_t worker_threads = 0;        // 0: hardware concurrency
+    size_t max_queued_requests = 256; // beyond this requests get 503
+    size_t gzip_min_bytes = 1024;     // smaller bodies are sent as is
+    int request_timeout_seconds = 30;
+};
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::unordered_map<std::string, std::string> params;  // decoded query string
+    std::string body;
+
+    std::string param(const std::string& name, const std::string& fallback = "") const;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string body;
+    std::string content_type = "application/json";
+    int retry_after_seconds = 0;  // > 0 adds a Retry-After header
+
+    static HttpResponse json(const nlohmann::json& body, int status = 200);
+    static HttpResponse error(int status, const std::string& message);
+};
+
+using HttpHandler = std::function<HttpResponse(const HttpRequest&)>;
+
+// Server-sent events channel for streaming handlers. The response headers
+// go out with the first event, so a handler that throws before sending
+// anything still gets an ordinary error response; one that throws later
+// ends the stream with an "error" event. send() may be called from any
+// thread.
+class HttpEventStream {
+public:
+    virtual ~HttpEventStream() = default;
+
+    // `data` goes out as one data line, so it must not contain newlines
+    // (compact JSON never does)
+    virtual void send(const std::string& event, const std::string& data) = 0;
+};
+
+using HttpStreamHandler = std::function<void(const HttpRequest&, HttpEventStream&)>;
+
+// Embedded HTTP front-end. cpprest's listener owns the sockets and parses
+// requests on its own I/O threads (HTTP/1.1 connections stay open between
+// requests); handlers run on a bounded worker pool so a slow recommendation
+// never stalls the listener. When the pool's queue is full the request is
+// answered with 503 and Retry-After straight from the I/O thread. Handlers
+// that throw OverloadError get the same answer.
+class HttpServer {
+public:
+    explicit HttpServer(const HttpServerConfig& config = HttpServerConfig{});
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Routes must be registered before start()
+    void route(const std::string& method, const std::string& path, HttpHandler handler);
+    // Streaming responses hold their worker until the handler returns
+    void streamRoute(const std::string& method, const std::string& path, HttpStreamHandler handler);
+
+    void start();
+    void stop();
+
+    std::string url() const;
+    size_t queuedRequests() const { return workers_ ? workers_->queueDepth() : 0; }
+    const HttpServerConfig& config() const { return config_; }
+
+private:
+    HttpServerConfig config_;
+    std::unordered_map<std::string, HttpHandler> routes_;  // "METHOD /path"
+    std::unordered_map<std::string, HttpStreamHandler> stream_routes_;
+    std::unique_ptr<WorkerPool> workers_;
+    std::unique_ptr<web::http::experimental::listener::http_listener> listener_;
+
+    void dispatch(const web::http::http_request& request);
+    void serve(const web::http::http_request& request, std::chrono::steady_clock::time_point accepted) const;
+    // Rethrows, with nothing sent yet, when the handler fails before its
+    // first event
+    void serveStream(
+        const web::http::http_request& request,
+        const HttpRequest& parsed,
+        const HttpStreamHandler& handler
+    ) const;
+};
+
+}
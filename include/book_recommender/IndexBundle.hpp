@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Book.hpp"
+#include "BookCatalog.hpp"
+#include "Document.hpp"
+
+namespace book_recommender {
+
+// Immutable, memory-mapped snapshot of everything needed to serve: the
+// embedding matrix, the catalog's numeric columns, a deduplicated string
+// heap and an id index. Nothing is copied out of the mapping when a bundle
+// is opened, so any number of worker processes attached to the same file
+// share one physical copy of it.
+class IndexBundle {
+public:
+    // Fills `out` (dimension floats) with the embedding of `id`; false when
+    // the book has none, which leaves it out of the bundle
+    using VectorSource = std::function<bool(const std::string& id, float* out)>;
+
+    static void write(
+        const std::string& path,
+        const BookCatalog& catalog,
+        int dimension,
+        const VectorSource& vectors,
+        uint64_t generation = 0
+    );
+    static std::shared_ptr<const IndexBundle> open(const std::string& path);
+
+    IndexBundle(const IndexBundle&) = delete;
+    IndexBundle& operator=(const IndexBundle&) = delete;
+
+    size_t size() const { return row_count_; }
+    int dimension() const { return dimension_; }
+    uint64_t generation() const { return generation_; }
+    size_t mappedBytes() const;
+
+    std::optional<uint32_t> rowOf(std::string_view id) const;
+    std::string_view id(uint32_t row) const;
+    const float* vector(uint32_t row) const { return vectors_ + size_t(row) * dimension_; }
+    double averageRating(uint32_t row) const;
+    int ratingsCount(uint32_t row) const;
+
+    Book book(uint32_t row) const;
+    // Built on first use and kept for the bundle's lifetime, so repeated
+    // lookups of a row hand out the same Document and the query engine's
+    // per-document caches keep hitting
+    std::shared_ptr<const Document> document(uint32_t row) const;
+
+    // Exact inner-product top-k over the mapped vectors for `n_queries`
+    // queries laid out back to back. Each query gets top_k slots in `scores`
+    // and `rows`, best first; slots past the last match hold -1.
+    void search(const float* queries, size_t n_queries, int top_k, float* scores, int64_t* rows) const;
+
+    // Same rankings as the BookRecommender catalog queries
+    std::vector<std::string> popularGenres(int top_k) const;
+    std::vector<std::string> popularAuthors(int top_k) const;
+    std::vector<uint32_t> topRatedRows(int limit) const;
+
+private:
+    struct Row;
+    struct Text;
+
+    IndexBundle() = default;
+
+    std::shared_ptr<const void> mapping_;
+    const char* base_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    uint64_t generation_ = 0;
+    size_t row_count_ = 0;
+    int dimension_ = 0;
+
+    const float* vectors_ = nullptr;
+    const Row* rows_ = nullptr;
+    const Text* genres_ = nullptr;
+    size_t genre_count_ = 0;
+    const uint32_t* id_order_ = nullptr;  // rows sorted by id
+    const char* text_ = nullptr;
+    size_t text_bytes_ = 0;
+
+    // One slot per row, filled with atomic shared_ptr operations
+    mutable std::unique_ptr<std::shared_ptr<const Document>[]> documents_;
+
+    std::string_view text(const Text& ref) const;
+    Document materialize(uint32_t row) const;
+};
+
+// Directory through which a loader process hands bundles to workers. Each
+// publish writes bundle-<generation>.bin next to a CURRENT file naming the
+// live one; both are replaced by rename, so a worker sees either the old
+// bundle or the complete new one. Workers poll refresh() and swap in new
+// generations; an old mapping is released once its last reader finishes.
+class BundleDirectory {
+public:
+    explicit BundleDirectory(std::string path);
+
+    // Loader side. Returns the new generation; keeps the `keep` newest
+    // bundle files and deletes the rest (mapped files stay readable until
+    // their workers let go).
+    uint64_t publish(
+        const BookCatalog& catalog,
+        int dimension,
+        const IndexBundle::VectorSource& vectors,
+        size_t keep = 2
+    );
+
+    // Worker side. True when a newer generation was attached.
+    bool refresh();
+    std::shared_ptr<const IndexBundle> current() const { return std::atomic_load(&current_); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+    std::shared_ptr<const IndexBundle> current_;
+    std::string current_file_;  // bundle file current_ was opened from
+
+    std::optional<std::string> readCurrent() const;
+    void removeStaleBundles(uint64_t newest, size_t keep) const;
+};
+
+}
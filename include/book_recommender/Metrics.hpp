@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "HdrHistogram.hpp"
+
+namespace book_recommender {
+
+using MetricLabels = std::map<std::string, std::string>;
+
+// Monotonic counter striped across cache lines so concurrent increments
+// from different threads do not contend on one atomic.
+class Counter {
+public:
+    void increment(uint64_t amount = 1);
+    uint64_t value() const;
+
+private:
+    static constexpr size_t STRIPES = 16;
+    struct alignas(64) Stripe {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Stripe, STRIPES> stripes_;
+};
+
+// Point-in-time value such as the index size
+class Gauge {
+public:
+    void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    void add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// Latency histogram in microseconds. Each recording thread writes to its
+// own shard with relaxed atomics; shards are merged into an HdrHistogram
+// only when the registry is scraped.
+class Histogram {
+public:
+    Histogram();
+    ~Histogram();
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    void record(int64_t micros);
+    void record(std::chrono::steady_clock::duration elapsed);
+    HdrHistogram snapshot() const;
+    double sumSeconds() const;
+
+private:
+    struct Shard;
+
+    const uint64_t id_;
+    const HdrHistogram layout_;
+    mutable std::mutex shards_mutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    Shard& localShard();
+};
+
+// Records the lifetime of the enclosing scope into a histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() { histogram_.record(std::chrono::steady_clock::now() - start_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+class MetricsRegistry {
+public:
+    static MetricsRegistry& getInstance() {
+        static MetricsRegistry instance;
+        return instance;
+    }
+
+    // Returned references stay valid for the life of the process; call
+    // sites are expected to look them up once and keep them.
+    Counter& counter(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    Gauge& gauge(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    Histogram& histogram(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+
+    // Prometheus text exposition format (version 0.0.4)
+    std::string scrapePrometheus() const;
+
+private:
+    MetricsRegistry() = default;
+
+    enum class MetricType { Counter, Gauge, Summary };
+
+    struct Family {
+        std::string help;
+        MetricType type;
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;
+
+    Family& getFamily(const std::string& name, const std::string& help, MetricType type);
+    static std::string formatLabels(const MetricLabels& labels);
+};
+
+}
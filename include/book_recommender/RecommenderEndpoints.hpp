@@ -0,0 +1,21 @@
+#pragma once
+
+#include "BookRecommender.hpp"
+#include "HttpServer.hpp"
+
+namespace book_recommender {
+
+// Exposes `recommender` as a JSON API on `server`:
+//
+//   GET /recommend?q=TEXT      GET /similar?id=BOOK_ID   GET /author?name=NAME
+//   GET /series?name=NAME      GET /search?q=TEXT        GET /popular?kind=genres|authors|books
+//   GET /personalized?user=USER_ID   POST /reads?user=USER_ID&book=BOOK_ID&weight=W
+//   GET /metrics               GET /healthz
+//   GET /recommend/stream?q=TEXT   (server-sent events)
+//
+// Recommendation endpoints take top_k plus the QueryFilter fields as query
+// parameters (genres and authors comma separated). The recommender must
+// outlive the server.
+void registerRecommenderEndpoints(HttpServer& server, BookRecommender& recommender);
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+
+namespace book_recommender {
+
+// Monotonic arena for allocations that die with a single request. The first
+// INLINE_CAPACITY bytes come from storage inside the arena itself (usually
+// on the caller's stack); anything beyond that is taken from the upstream
+// resource in growing chunks. Nothing is freed until the arena goes away,
+// and then everything is released at once.
+class RequestArena {
+public:
+    static constexpr size_t INLINE_CAPACITY = 16 * 1024;
+
+    explicit RequestArena(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : resource_(buffer_.data(), buffer_.size(), upstream) {}
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &resource_; }
+
+private:
+    alignas(std::max_align_t) std::array<std::byte, INLINE_CAPACITY> buffer_;
+    std::pmr::monotonic_buffer_resource resource_;
+};
+
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace book_recommender {
+
+struct ResponseCacheConfig {
+    size_t max_bytes = 64 * 1024 * 1024;  // 0 disables the cache
+    std::chrono::milliseconds ttl{std::chrono::minutes(5)};
+    // Empty answers are cached too, but briefly: they are cheap to get wrong
+    // (a transient upstream failure looks the same as "no matches")
+    std::chrono::milliseconds negative_ttl{std::chrono::seconds(30)};
+};
+
+// Byte-budgeted LRU cache of complete API responses. Every entry is tagged
+// with the catalog version it was computed against; lookups under any other
+// version miss, so a catalog update retires all older answers at once
+// without having to walk the cache.
+template <typename Value>
+class ResponseCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    explicit ResponseCache(const ResponseCacheConfig& config = {}) : config_(config) {}
+
+    std::shared_ptr<const Value> get(const std::string& key, uint64_t catalog_version) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            ++stats_.misses;
+            return nullptr;
+        }
+
+        auto& entry = it->second;
+        if (entry.catalog_version != catalog_version || Clock::now() >= entry.expires) {
+            erase(it);
+            ++stats_.misses;
+            return nullptr;
+        }
+
+        lru_.splice(lru_.begin(), lru_, entry.position);
+        ++stats_.hits;
+        return entry.value;
+    }
+
+    // `bytes` is the caller's estimate of the value's footprint; the key is
+    // added on top. Values larger than the whole budget are not cached.
+    void put(
+        const std::string& key,
+        std::shared_ptr<const Value> value,
+        size_t bytes,
+        bool negative,
+        uint64_t catalog_version
+    ) {
+        bytes += key.size() + sizeof(Entry);
+        if (bytes > config_.max_bytes) return;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto existing = entries_.find(key);
+        if (existing != entries_.end()) {
+            erase(existing);
+        }
+
+        while (bytes_ + bytes > config_.max_bytes && !lru_.empty()) {
+            erase(entries_.find(lru_.back()));
+            ++stats_.evictions;
+        }
+
+        lru_.push_front(key);
+        entries_.emplace(key, Entry{
+            std::move(value),
+            bytes,
+            catalog_version,
+            Clock::now() + (negative ? config_.negative_ttl : config_.ttl),
+            lru_.begin()
+        });
+        bytes_ += bytes;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        lru_.clear();
+        bytes_ = 0;
+    }
+
+    bool enabled() const { return config_.max_bytes > 0; }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats stats = stats_;
+        stats.entries = entries_.size();
+        stats.bytes = bytes_;
+        return stats;
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<const Value> value;
+        size_t bytes;
+        uint64_t catalog_version;
+        Clock::time_point expires;
+        std::list<std::string>::iterator position;
+    };
+
+    ResponseCacheConfig config_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_;  // most recently used first
+    size_t bytes_ = 0;
+    Stats stats_;
+
+    void erase(typename std::unordered_map<std::string, Entry>::iterator it) {
+        bytes_ -= it->second.bytes;
+        lru_.erase(it->second.position);
+        entries_.erase(it);
+    }
+};
+
+}
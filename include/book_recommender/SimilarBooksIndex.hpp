@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SimilarityGraph.hpp"
+
+namespace book_recommender {
+
+// Serves similar-book lists from an immutable SimilarityGraph while the
+// catalog keeps changing. Upserted books get fresh rows in an in-memory
+// overlay and are merged into their neighbours' rows; every entry remembers
+// the version of the book it points at, so entries for books changed since
+// the graph was built are dropped at lookup instead of served stale.
+class SimilarBooksIndex {
+public:
+    struct Neighbor {
+        std::string doc_id;
+        float score;
+    };
+
+    explicit SimilarBooksIndex(std::shared_ptr<const SimilarityGraph> graph);
+
+    // Fills up to top_k neighbours, best first. Returns false when top_k is
+    // more than the graph's k, the book is not covered, or stale entries
+    // left fewer than the row would have held; callers then fall back to a
+    // live search.
+    bool lookup(const std::string& doc_id, int top_k, std::vector<Neighbor>& neighbors) const;
+
+    // Replaces the book's neighbour list (e.g. from a live search after an
+    // upsert) and inserts the book into each neighbour's row
+    void patch(const std::string& doc_id, const std::vector<Neighbor>& neighbors);
+    void invalidate(const std::string& doc_id);
+
+    const SimilarityGraph& graph() const { return *graph_; }
+    size_t patchedRows() const;
+
+private:
+    struct Entry {
+        std::string doc_id;
+        float score;
+        uint64_t version;
+    };
+
+    static constexpr uint64_t BASE_VERSION = 0;
+    static constexpr uint64_t REMOVED = UINT64_MAX;
+
+    std::shared_ptr<const SimilarityGraph> graph_;
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, uint64_t> versions_;  // books absent here are as built
+    std::unordered_map<std::string, std::vector<Entry>> rows_;  // overrides graph rows
+    uint64_t next_version_ = 1;
+
+    uint64_t versionOf(const std::string& doc_id) const;
+    // Overlay row if there is one, otherwise the graph row; false if neither
+    bool rowOf(const std::string& doc_id, std::vector<Entry>& row) const;
+};
+
+}
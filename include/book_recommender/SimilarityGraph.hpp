@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace book_recommender {
+
+// Precomputed k-nearest-neighbour graph over the catalog. Every book owns a
+// slot holding up to k neighbour slots with their similarity scores, sorted
+// best first; unused entries hold NO_NEIGHBOR. A loaded graph is immutable
+// and its neighbour arrays are mapped straight from the file, so processes
+// serving the same graph share its pages.
+class SimilarityGraph {
+public:
+    static constexpr uint32_t NO_NEIGHBOR = UINT32_MAX;
+
+    SimilarityGraph() = default;
+    SimilarityGraph(std::vector<std::string> doc_ids, int k);
+
+    // Row pointers may refer to owned storage, so only moves are allowed
+    SimilarityGraph(const SimilarityGraph&) = delete;
+    SimilarityGraph& operator=(const SimilarityGraph&) = delete;
+    SimilarityGraph(SimilarityGraph&&) = default;
+    SimilarityGraph& operator=(SimilarityGraph&&) = default;
+
+    size_t size() const { return doc_ids_.size(); }
+    int k() const { return k_; }
+
+    const std::string& docId(uint32_t slot) const { return doc_ids_[slot]; }
+    std::optional<uint32_t> slotOf(const std::string& doc_id) const;
+
+    // Neighbour rows are k entries long; stop at the first NO_NEIGHBOR
+    const uint32_t* neighborSlots(uint32_t slot) const { return neighbor_data_ + size_t(slot) * k_; }
+    const float* neighborScores(uint32_t slot) const { return score_data_ + size_t(slot) * k_; }
+    int neighborCount(uint32_t slot) const;
+
+    // Fills a slot from raw search output, skipping the book itself and
+    // invalid labels. Distinct slots may be written concurrently. Only valid
+    // on graphs built in memory, not on loaded ones.
+    void setNeighbors(uint32_t slot, const int64_t* labels, const float* scores, size_t count);
+
+    // Binary format: fixed header, then the neighbour and score arrays
+    // (64-byte aligned), then length-prefixed doc ids
+    void save(const std::string& path) const;
+    static SimilarityGraph load(const std::string& path);
+
+private:
+    int k_ = 0;
+    std::vector<std::string> doc_ids_;
+    std::unordered_map<std::string, uint32_t> slots_;
+
+    // Either point into the owned vectors (built graphs) or into mapping_
+    const uint32_t* neighbor_data_ = nullptr;
+    const float* score_data_ = nullptr;
+    std::vector<uint32_t> neighbors_;
+    std::vector<float> scores_;
+    std::shared_ptr<const void> mapping_;
+
+    void indexSlots();
+};
+
+}
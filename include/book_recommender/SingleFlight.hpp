@@ -0,0 +1,72 @@
+#pragma once
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace book_recommender {
+
+// Coalesces concurrent calls that share a key: the first caller runs the
+// work, later callers with the same key block until it finishes and receive
+// a copy of its result (or its exception). Nothing is cached; once the call
+// completes the next caller starts a fresh one.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class SingleFlight {
+public:
+    // `coalesced`, when given, is set to whether this caller piggybacked on
+    // another caller's work
+    template <typename Fn>
+    Value run(const Key& key, Fn&& fn, bool* coalesced = nullptr) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = calls_.find(key);
+        if (it != calls_.end()) {
+            ++it->second.waiters;
+            auto result = it->second.result;
+            lock.unlock();
+            if (coalesced) *coalesced = true;
+            return result.get();
+        }
+
+        std::promise<Value> promise;
+        calls_.emplace(key, Call{promise.get_future().share(), 0});
+        lock.unlock();
+        if (coalesced) *coalesced = false;
+
+        try {
+            Value value = std::forward<Fn>(fn)();
+            promise.set_value(value);
+            finish(key);
+            return value;
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+            finish(key);
+            throw;
+        }
+    }
+
+    // Callers currently waiting on the in-flight call for `key`
+    size_t waiters(const Key& key) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = calls_.find(key);
+        return it == calls_.end() ? 0 : it->second.waiters;
+    }
+
+private:
+    struct Call {
+        std::shared_future<Value> result;
+        size_t waiters;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<Key, Call, Hash> calls_;
+
+    void finish(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        calls_.erase(key);
+    }
+};
+
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace book_recommender {
+
+// Interactive work (user-facing queries) is always taken before background
+// work (ingest, index and graph rebuilds, batch jobs). Tasks are never
+// interrupted, so preemption happens at task boundaries; background jobs
+// should be split into reasonably small tasks.
+enum class TaskPriority {
+    Interactive = 0,
+    Background = 1
+};
+
+// Work-stealing thread pool. Every worker owns a deque per priority: tasks
+// it spawns go to the back of its own deque and it pops from the back
+// (newest first, cache-warm), while idle workers steal from the front
+// (oldest first, usually the largest pieces of work). Tasks posted from
+// outside the pool land in a global injection queue.
+//
+// A task runs in the trace and allocation context of the thread that
+// posted it, so work fanned out for a request is traced and counted as
+// part of that request.
+class TaskExecutor {
+public:
+    struct Stats {
+        uint64_t executed = 0;
+        uint64_t stolen = 0;
+    };
+
+    // CPU-bound work; sized to the hardware
+    static TaskExecutor& getInstance();
+
+    // Blocking remote calls (Groq), which spend their time waiting on the
+    // network. Kept apart so they never occupy the CPU workers.
+    static TaskExecutor& getBlockingInstance();
+
+    // `threads` of 0 uses the hardware concurrency
+    explicit TaskExecutor(size_t threads = 0);
+    ~TaskExecutor();
+
+    TaskExecutor(const TaskExecutor&) = delete;
+    TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+    // Fire and forget; exceptions are logged and dropped
+    void post(std::function<void()> task, TaskPriority priority = TaskPriority::Interactive);
+
+    template <typename Fn>
+    auto submit(Fn&& fn, TaskPriority priority = TaskPriority::Interactive)
+        -> std::future<std::invoke_result_t<Fn>> {
+        using Result = std::invoke_result_t<Fn>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+        auto future = task->get_future();
+        post([task] { (*task)(); }, priority);
+        return future;
+    }
+
+    // Runs one queued task of at least `priority` on the calling thread
+    bool runPendingTask(TaskPriority priority = TaskPriority::Background);
+
+    // Calls body(i) for every i in [begin, end) in chunks of `grain`; the
+    // calling thread helps until all chunks are done
+    template <typename Body>
+    void parallelFor(size_t begin, size_t end, Body&& body,
+                     TaskPriority priority = TaskPriority::Interactive, size_t grain = 1);
+
+    size_t threadCount() const { return threads_.size(); }
+    Stats stats() const;
+
+private:
+    friend class TaskGroup;
+
+    static constexpr size_t PRIORITY_COUNT = 2;
+    using Task = std::function<void()>;
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> queues[PRIORITY_COUNT];
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+
+    std::mutex global_mutex_;
+    std::deque<Task> global_[PRIORITY_COUNT];
+
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<bool> stopping_{false};
+
+    std::atomic<uint64_t> executed_{0};
+    std::atomic<uint64_t> stolen_{0};
+
+    // Queues a task as is, without capturing the caller's context
+    void enqueue(Task task, TaskPriority priority);
+    // Index of the calling thread's worker in this executor, or -1
+    int currentWorker() const;
+    bool take(int self, size_t priority, Task& task);
+    void execute(Task& task, size_t level);
+    void workerLoop(size_t index);
+};
+
+// Fork-join scope: run() spawns tasks, wait() blocks until all of them are
+// done and rethrows the first exception any of them threw. The waiting
+// thread runs the group's own tasks that no worker has started yet, but
+// never another group's: helping with unrelated requests would tie this
+// caller's latency to theirs. Groups nest inside tasks, since a waiter
+// only ever waits for tasks that are already running.
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskPriority priority = TaskPriority::Interactive,
+                       TaskExecutor& executor = TaskExecutor::getInstance());
+
+    ~TaskGroup() {
+        try {
+            wait();
+        } catch (...) {
+            // Only reachable when wait() was never called; nobody is left to
+            // receive the error
+        }
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename Fn>
+    void run(Fn&& fn) {
+        spawn(std::function<void()>(std::forward<Fn>(fn)));
+    }
+
+    void wait();
+
+private:
+    struct State;
+
+    TaskExecutor& executor_;
+    TaskPriority priority_;
+    // Shared with the executor's queue entries, which may outlive the group
+    std::shared_ptr<State> state_;
+
+    void spawn(std::function<void()> task);
+};
+
+template <typename Body>
+void TaskExecutor::parallelFor(size_t begin, size_t end, Body&& body, TaskPriority priority, size_t grain) {
+    if (begin >= end) return;
+    grain = std::max<size_t>(grain, 1);
+    if (end - begin <= grain) {
+        for (size_t i = begin; i < end; ++i) body(i);
+        return;
+    }
+
+    TaskGroup group(priority, *this);
+    for (size_t start = begin; start < end; start += grain) {
+        size_t stop = std::min(end, start + grain);
+        group.run([&body, start, stop] {
+            for (size_t i = start; i < stop; ++i) body(i);
+        });
+    }
+    group.wait();
+}
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace book_recommender {
+
+// Splits text on ASCII whitespace. Tokens are views into the text, so
+// nothing is copied; the text must outlive them.
+class Tokenizer {
+public:
+    explicit Tokenizer(std::string_view text) : text_(text) {}
+
+    bool next(std::string_view& token) {
+        while (pos_ < text_.size() && isSpace(text_[pos_])) ++pos_;
+        if (pos_ == text_.size()) return false;
+        size_t start = pos_;
+        while (pos_ < text_.size() && !isSpace(text_[pos_])) ++pos_;
+        token = text_.substr(start, pos_ - start);
+        return true;
+    }
+
+private:
+    static bool isSpace(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
+// English stop words in normalized form (lowercase, apostrophes stripped:
+// "dont", "youre"). The lookup is one hash into a collision-free table
+// built at compile time, plus one string compare.
+bool isStopWord(std::string_view word);
+
+// Porter2 (Snowball English) stem of a lowercase ASCII word, written to
+// `out`. Bytes outside a-z are treated as consonants.
+void stemWord(std::string_view word, std::string& out);
+
+// Bounded memo over stemWord: two-way set-associative, least recently used
+// way evicted. Natural-language text is dominated by a few thousand
+// distinct words, so most tokens are answered by a hash and a compare;
+// words longer than MAX_CACHED_WORD bytes are stemmed every time.
+// Not thread-safe: use one per thread.
+class StemCache {
+public:
+    static constexpr size_t MAX_CACHED_WORD = 22;
+
+    // Capacity, in words, is rounded up to a power of two
+    explicit StemCache(size_t capacity = 4096);
+
+    // The view is valid until the next call
+    std::string_view stem(std::string_view word);
+
+private:
+    struct Entry {
+        uint8_t word_size = 0;
+        uint8_t stem_size = 0;
+        char word[MAX_CACHED_WORD];
+        char stem[MAX_CACHED_WORD];
+    };
+
+    std::vector<Entry> entries_;  // sets of two, most recently used first
+    std::string scratch_;
+};
+
+// Calls emit(std::string_view term) for each index term of normalized text
+// (see normalizeText): every token that is not a stop word, stemmed. Both
+// document preprocessing and term indexing (e.g. BM25) go through this, so
+// they agree on what a term is.
+template <typename Emit>
+void forEachTerm(std::string_view normalized_text, StemCache& stems, Emit&& emit) {
+    Tokenizer tokens(normalized_text);
+    std::string_view token;
+    while (tokens.next(token)) {
+        if (!isStopWord(token)) {
+            emit(stems.stem(token));
+        }
+    }
+}
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace book_recommender {
+
+// Single-pass text normalization shared by query and document preprocessing:
+// case folding, punctuation removal, and whitespace collapsing (runs of
+// whitespace become one space; leading and trailing whitespace is dropped).
+//
+// Input is UTF-8. Latin-1, Latin Extended-A, Greek, and Cyrillic capitals
+// are folded to lowercase. Unicode punctuation (general punctuation, Latin-1
+// marks such as « » ¿, CJK brackets) is stripped, and Unicode spaces count
+// as whitespace. Other code points and malformed bytes pass through
+// unchanged. Runs of 16 ASCII bytes take an SSE2 path where available.
+//
+// The output is never longer than the input.
+
+// Writes the normalized text to `out`, which must hold text.size() bytes,
+// and returns the number of bytes written
+size_t normalizeText(std::string_view text, char* out);
+
+// Replaces the contents of `out`, reusing its capacity
+void normalizeText(std::string_view text, std::string& out);
+
+std::string normalizeText(std::string_view text);
+
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace book_recommender {
+
+struct TracingConfig {
+    double sample_rate = 0.0;              // fraction of root requests traced
+    std::string output_path = "traces.jsonl";
+    std::string service_name = "book_recommender";
+};
+
+struct TraceState;
+
+// Identifies the active span so work handed to another thread can be
+// attached to the same trace
+struct TraceContext {
+    std::shared_ptr<TraceState> trace;
+    uint64_t span_id = 0;
+    bool unsampled = false;  // inside a request that lost the sampling draw
+};
+
+// Process-wide tracer. Completed traces are appended to a local file, one
+// OTLP/JSON ExportTraceServiceRequest per line.
+class Tracer {
+public:
+    static Tracer& getInstance() {
+        static Tracer instance;
+        return instance;
+    }
+
+    void configure(const TracingConfig& config);
+    void disable();
+    bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+private:
+    friend class Span;
+
+    Tracer() = default;
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<double> sample_rate_{0.0};
+    std::mutex sink_mutex_;
+    std::ofstream sink_;
+    std::string service_name_ = "book_recommender";
+
+    bool shouldSample() const;
+    void exportTrace(TraceState& trace);
+};
+
+// RAII span. Outside an active trace a span becomes a sampled root; inside
+// one it becomes a child of the current span. When tracing is disabled or
+// the request was not sampled the span is inert and every call is a no-op,
+// and so are all spans nested in an unsampled root.
+class Span {
+public:
+    using AttributeValue = std::variant<std::string, int64_t, double, bool>;
+
+    explicit Span(const char* name);
+    ~Span();
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    bool isRecording() const { return trace_ != nullptr; }
+
+    void setAttribute(const char* key, const std::string& value);
+    void setAttribute(const char* key, const char* value);
+    void setAttribute(const char* key, int64_t value);
+    void setAttribute(const char* key, int value) { setAttribute(key, static_cast<int64_t>(value)); }
+    void setAttribute(const char* key, size_t value) { setAttribute(key, static_cast<int64_t>(value)); }
+    void setAttribute(const char* key, double value);
+    void setAttribute(const char* key, bool value);
+    void setError(const std::string& message);
+
+    // Trace id of the calling thread's active request, or "" when untraced
+    static std::string currentTraceId();
+    static TraceContext currentContext();
+
+private:
+    std::shared_ptr<TraceState> trace_;
+    const char* name_;
+    uint64_t span_id_ = 0;
+    uint64_t parent_id_ = 0;
+    int64_t start_ns_ = 0;
+    bool is_root_ = false;
+    bool has_error_ = false;
+    std::string error_message_;
+    std::vector<std::pair<const char*, AttributeValue>> attributes_;
+};
+
+// Makes a captured context current on this thread for the scope's lifetime
+class ScopedTraceContext {
+public:
+    explicit ScopedTraceContext(TraceContext context);
+    ~ScopedTraceContext();
+
+    ScopedTraceContext(const ScopedTraceContext&) = delete;
+    ScopedTraceContext& operator=(const ScopedTraceContext&) = delete;
+
+private:
+    TraceContext previous_;
+};
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "BookVectorStore.hpp"
+
+namespace book_recommender {
+
+struct ReadEvent {
+    std::string book_id;
+    // How much the read says about the reader's taste, e.g. derived from
+    // their rating. Reads with a non-positive weight only mark the book read.
+    float weight = 1.0f;
+};
+
+// A reader's taste as one or more interests in embedding space. Profiles
+// are immutable once published; updates replace them.
+struct UserProfile {
+    struct Interest {
+        std::vector<float> centroid;  // unit length
+        float weight = 0.0f;          // read weight assigned to this interest
+    };
+
+    std::vector<Interest> interests;
+    std::unordered_set<std::string> read_books;
+    // Unique per published profile, so cached answers can key on it
+    uint64_t version = 0;
+};
+
+struct UserProfileConfig {
+    // 1 keeps a single weighted centroid
+    size_t max_interests = 4;
+    // Reads needed per interest before a history is split into more of them
+    size_t min_reads_per_interest = 5;
+    size_t kmeans_batch_size = 64;
+    size_t kmeans_iterations = 20;
+    // A new read whose cosine similarity to every interest is below this
+    // opens a new interest, as long as the profile has room for one
+    float new_interest_threshold = 0.3f;
+    // Profiles kept in memory; the least recently used are evicted and
+    // rebuilt through the history loader when next needed
+    size_t max_profiles = 100000;
+};
+
+// Builds and caches reader profiles from reading histories. A full history
+// is clustered with mini-batch k-means; single reads are folded into the
+// nearest interest incrementally. Profiles live in mutex-sharded LRU maps so
+// lookups from many threads rarely contend.
+class UserProfileStore {
+public:
+    using HistoryLoader = std::function<std::vector<ReadEvent>(const std::string& user_id)>;
+
+    explicit UserProfileStore(std::shared_ptr<BookVectorStore> vector_store,
+                              const UserProfileConfig& config = {});
+
+    // Source of histories for users whose profile is not cached. Set it
+    // before the store starts serving.
+    void setHistoryLoader(HistoryLoader loader);
+
+    // Replaces the profile with one clustered from the whole history
+    std::shared_ptr<const UserProfile> setHistory(const std::string& user_id,
+                                                  const std::vector<ReadEvent>& history);
+
+    // Folds one read into the profile without reclustering. Books already
+    // read, and books without a vector, leave it unchanged.
+    std::shared_ptr<const UserProfile> recordRead(const std::string& user_id, const ReadEvent& read);
+
+    // Cached profile, built through the history loader on a miss; null when
+    // the user is unknown
+    std::shared_ptr<const UserProfile> getProfile(const std::string& user_id);
+    void removeProfile(const std::string& user_id);
+    size_t size() const;
+
+    // Nearest unread books for the profile: one batched search with every
+    // interest as a query. Result slots are shared out in proportion to the
+    // interests' weights, so a minor interest still gets represented.
+    std::vector<BookVectorStore::SearchResult> search(const UserProfile& profile, int top_k) const;
+
+private:
+    static constexpr size_t SHARD_COUNT = 16;
+
+    struct Entry {
+        std::shared_ptr<const UserProfile> profile;
+        std::list<std::string>::iterator lru_position;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Entry> profiles;
+        std::list<std::string> lru;  // most recently used first
+    };
+
+    std::shared_ptr<BookVectorStore> vector_store_;
+    UserProfileConfig config_;
+    HistoryLoader loader_;
+    Shard shards_[SHARD_COUNT];
+    std::atomic<uint64_t> next_version_{1};
+
+    Shard& shardFor(const std::string& user_id);
+    std::shared_ptr<const UserProfile> cached(const std::string& user_id);
+    // Publishes the profile unless `only_if_absent` and one is already cached;
+    // returns the profile that ends up cached
+    std::shared_ptr<const UserProfile> store(const std::string& user_id,
+                                             std::shared_ptr<UserProfile> profile,
+                                             bool only_if_absent = false);
+    // Caller must hold the shard's mutex
+    std::shared_ptr<const UserProfile> publishLocked(Shard& shard, const std::string& user_id,
+                                                     std::shared_ptr<const UserProfile> profile);
+    std::shared_ptr<UserProfile> buildProfile(const std::vector<ReadEvent>& history) const;
+    // Unit-length embedding of the book, or empty if it has none
+    std::vector<float> bookVector(const std::string& book_id) const;
+};
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+namespace book_recommender {
+
+// Inner-product kernels for one embedding dimension, selected once when a
+// store is built. The common embedding sizes (128, 256, 384, 768, 1024) get
+// instantiations with the dimension as a template parameter: the loop is
+// unrolled completely at compile time into blocks of independent partial
+// sums, which the compiler keeps in vector registers. A single running sum
+// could not be vectorized without reassociating it. dotRows also scores four
+// rows per pass over the query, so each query block is loaded once for all
+// four. Any other dimension uses the plain loop.
+//
+// For a given pair of vectors, dot and dotRows return the same value, bit
+// for bit.
+class VectorKernels {
+public:
+    static constexpr size_t SPECIALIZED_DIMENSIONS[] = {128, 256, 384, 768, 1024};
+
+    explicit VectorKernels(size_t dimension = 0);
+
+    // The plain loop whatever the dimension; the baseline in benchmarks
+    static VectorKernels generic(size_t dimension);
+
+    size_t dimension() const { return dimension_; }
+    bool specialized() const { return specialized_; }
+
+    float dot(const float* a, const float* b) const { return dot_(a, b, dimension_); }
+
+    // out[i] = dot(query, rows + i * dimension) for `count` contiguous rows
+    void dotRows(const float* query, const float* rows, size_t count, float* out) const {
+        dot_rows_(query, rows, count, dimension_, out);
+    }
+
+private:
+    using DotFn = float (*)(const float* a, const float* b, size_t dimension);
+    using DotRowsFn = void (*)(const float* query, const float* rows, size_t count, size_t dimension, float* out);
+
+    size_t dimension_;
+    bool specialized_ = false;
+    DotFn dot_;
+    DotRowsFn dot_rows_;
+
+    template <size_t D>
+    void useFixed();
+};
+
+}
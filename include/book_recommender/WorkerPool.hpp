@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace book_recommender {
+
+// Fixed set of threads draining a bounded FIFO queue. trySubmit never
+// blocks: once the queue is full it refuses the task, so callers can shed
+// load instead of letting latency grow without bound.
+class WorkerPool {
+public:
+    // `threads` of 0 uses the hardware concurrency
+    WorkerPool(size_t threads, size_t max_queue);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // False when the queue is full or the pool is shutting down
+    bool trySubmit(std::function<void()> task);
+
+    // Runs everything already queued, then joins the threads
+    void shutdown();
+
+    size_t queueDepth() const;
+    size_t threadCount() const { return threads_.size(); }
+    size_t maxQueue() const { return max_queue_; }
+
+private:
+    const size_t max_queue_;
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> queue_;
+    std::vector<std::thread> threads_;
+    bool stopping_ = false;
+
+    void workerLoop();
+};
+
+}
@@ -38,30 +38,46 @@ Book::Book(
     is_ebook_(is_ebook) {}
 
 double Book::getEngagementScore() const {
+    return engagementScore(average_rating_, ratings_count_, review_count_);
+}
+
+double Book::getPopularityScore() const {
+    return popularityScore(average_rating_, ratings_count_);
+}
+
+bool Book::isHighlyRated() const {
+    return isHighlyRated(average_rating_, ratings_count_);
+}
+
+int Book::getPublicationYear() const {
+    return publicationYear(publication_date_);
+}
+
+double Book::engagementScore(double average_rating, int ratings_count, int review_count) {
     // Calculate engagement based on ratings and reviews
-    double rating_weight = std::min(ratings_count_ / static_cast<double>(MIN_RATINGS_FOR_RELIABLE), 1.0);
-    double review_ratio = review_count_ > 0 ? static_cast<double>(review_count_) / ratings_count_ : 0.0;
+    double rating_weight = std::min(ratings_count / static_cast<double>(MIN_RATINGS_FOR_RELIABLE), 1.0);
+    double review_ratio = review_count > 0 ? static_cast<double>(review_count) / ratings_count : 0.0;
     
-    return (average_rating_ * rating_weight + review_ratio * 5.0) / 2.0;
+    return (average_rating * rating_weight + review_ratio * 5.0) / 2.0;
 }
 
-double Book::getPopularityScore() const {
+double Book::popularityScore(double average_rating, int ratings_count) {
     // Normalize ratings count to a 0-1 scale (assuming 10000 ratings is very popular)
-    double normalized_ratings = std::min(ratings_count_ / 10000.0, 1.0);
+    double normalized_ratings = std::min(ratings_count / 10000.0, 1.0);
     
     // Combine rating and popularity metrics
-    return (normalized_ratings * 0.7 + (average_rating_ / 5.0) * 0.3) * 100.0;
+    return (normalized_ratings * 0.7 + (average_rating / 5.0) * 0.3) * 100.0;
 }
 
-bool Book::isHighlyRated() const {
-    return average_rating_ >= HIGH_RATING_THRESHOLD && 
-           ratings_count_ >= MIN_RATINGS_FOR_RELIABLE;
+bool Book::isHighlyRated(double average_rating, int ratings_count) {
+    return average_rating >= HIGH_RATING_THRESHOLD && 
+           ratings_count >= MIN_RATINGS_FOR_RELIABLE;
 }
 
-int Book::getPublicationYear() const {
+int Book::publicationYear(const std::string& publication_date) {
     std::regex year_regex("\\d{4}");
     std::smatch match;
-    if (std::regex_search(publication_date_, match, year_regex)) {
+    if (std::regex_search(publication_date, match, year_regex)) {
         return std::stoi(match[0]);
     }
     return 0;
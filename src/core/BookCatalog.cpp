@@ -0,0 +1,413 @@
+#include "book_recommender/BookCatalog.hpp"
+#include <limits>
+#include <stdexcept>
+
+namespace book_recommender {
+
+uint32_t StringPool::intern(const std::string& value) {
+    auto it = ids_.find(value);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+
+    auto id = static_cast<uint32_t>(strings_.size());
+    strings_.push_back(value);
+    ids_.emplace(strings_.back(), id);
+    return id;
+}
+
+std::optional<uint32_t> StringPool::find(std::string_view value) const {
+    auto it = ids_.find(value);
+    if (it == ids_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+size_t StringPool::memoryUsage() const {
+    size_t bytes = ids_.size() * (sizeof(std::string_view) + sizeof(uint32_t) + sizeof(void*));
+    for (const auto& value : strings_) {
+        bytes += sizeof(std::string);
+        if (value.capacity() > std::string().capacity()) {
+            bytes += value.capacity();
+        }
+    }
+    return bytes;
+}
+
+std::string_view BookView::getId() const {
+    return catalog_->text(catalog_->text_[row_].id);
+}
+
+std::string_view BookView::getTitle() const {
+    return catalog_->text(catalog_->text_[row_].title);
+}
+
+const std::string& BookView::getAuthor() const {
+    return catalog_->authors_.get(catalog_->author_ids_[row_]);
+}
+
+std::vector<std::string_view> BookView::getGenres() const {
+    std::vector<std::string_view> genres;
+    for (auto it = catalog_->genreIdsBegin(row_); it != catalog_->genreIdsEnd(row_); ++it) {
+        genres.push_back(catalog_->genres_.get(*it));
+    }
+    return genres;
+}
+
+std::string_view BookView::getDescription() const {
+    return catalog_->text(catalog_->text_[row_].description);
+}
+
+int BookView::getPageCount() const {
+    return catalog_->page_counts_[row_];
+}
+
+double BookView::getAverageRating() const {
+    return catalog_->average_ratings_[row_];
+}
+
+int BookView::getRatingsCount() const {
+    return catalog_->ratings_counts_[row_];
+}
+
+int BookView::getReviewCount() const {
+    return catalog_->review_counts_[row_];
+}
+
+std::optional<std::string_view> BookView::getSeries() const {
+    const auto& series = catalog_->text_[row_].series;
+    if (series.offset == BookCatalog::NO_SERIES) {
+        return std::nullopt;
+    }
+    return catalog_->text(series);
+}
+
+const std::string& BookView::getLanguage() const {
+    return catalog_->languages_.get(catalog_->language_ids_[row_]);
+}
+
+const std::string& BookView::getPublisher() const {
+    return catalog_->publishers_.get(catalog_->publisher_ids_[row_]);
+}
+
+std::string_view BookView::getPublicationDate() const {
+    return catalog_->text(catalog_->text_[row_].publication_date);
+}
+
+std::string_view BookView::getIsbn13() const {
+    return catalog_->text(catalog_->text_[row_].isbn13);
+}
+
+bool BookView::isEbook() const {
+    return catalog_->is_ebook_[row_] != 0;
+}
+
+double BookView::getEngagementScore() const {
+    return Book::engagementScore(getAverageRating(), getRatingsCount(), getReviewCount());
+}
+
+double BookView::getPopularityScore() const {
+    return Book::popularityScore(getAverageRating(), getRatingsCount());
+}
+
+bool BookView::isHighlyRated() const {
+    return Book::isHighlyRated(getAverageRating(), getRatingsCount());
+}
+
+int BookView::getPublicationYear() const {
+    return catalog_->publication_years_[row_];
+}
+
+Book BookView::toBook() const {
+    std::vector<std::string> genres;
+    for (auto it = catalog_->genreIdsBegin(row_); it != catalog_->genreIdsEnd(row_); ++it) {
+        genres.push_back(catalog_->genres_.get(*it));
+    }
+
+    std::optional<std::string> series;
+    if (auto value = getSeries()) {
+        series = std::string(*value);
+    }
+
+    return Book(
+        std::string(getId()),
+        std::string(getTitle()),
+        getAuthor(),
+        std::move(genres),
+        std::string(getDescription()),
+        getPageCount(),
+        getAverageRating(),
+        getRatingsCount(),
+        getReviewCount(),
+        std::move(series),
+        getLanguage(),
+        getPublisher(),
+        std::string(getPublicationDate()),
+        std::string(getIsbn13()),
+        isEbook()
+    );
+}
+
+void BookCatalog::assign(const std::vector<Book>& books) {
+    clear();
+
+    size_t text_bytes = 0;
+    for (const auto& book : books) {
+        text_bytes += book.getId().size() + book.getTitle().size() +
+                      book.getDescription().size() + book.getPublicationDate().size() +
+                      book.getIsbn13().size() + book.getSeries().value_or("").size();
+    }
+    text_heap_.reserve(text_bytes);
+
+    text_.reserve(books.size());
+    row_by_id_.reserve(books.size());
+    average_ratings_.reserve(books.size());
+    ratings_counts_.reserve(books.size());
+    review_counts_.reserve(books.size());
+    page_counts_.reserve(books.size());
+    publication_years_.reserve(books.size());
+    is_ebook_.reserve(books.size());
+    author_ids_.reserve(books.size());
+    language_ids_.reserve(books.size());
+    publisher_ids_.reserve(books.size());
+    genre_ranges_.reserve(books.size());
+
+    for (const auto& book : books) {
+        upsert(book);
+    }
+}
+
+void BookCatalog::upsert(const Book& book) {
+    auto it = row_by_id_.find(book.getId());
+    if (it != row_by_id_.end()) {
+        overwrite(it->second, book);
+    } else {
+        append(book);
+    }
+    compact();
+}
+
+bool BookCatalog::remove(const std::string& id) {
+    auto it = row_by_id_.find(id);
+    if (it == row_by_id_.end()) {
+        return false;
+    }
+
+    uint32_t row = it->second;
+    uint32_t last = static_cast<uint32_t>(size() - 1);
+    retire(row);
+    row_by_id_.erase(it);
+
+    // Keep columns dense by moving the last row into the hole
+    if (row != last) {
+        moveRow(last, row);
+        row_by_id_[std::string(text(text_[row].id))] = row;
+    }
+    popRow();
+    compact();
+    return true;
+}
+
+void BookCatalog::clear() {
+    text_heap_.clear();
+    dead_text_bytes_ = 0;
+    dead_genre_ids_ = 0;
+    text_.clear();
+    row_by_id_.clear();
+    average_ratings_.clear();
+    ratings_counts_.clear();
+    review_counts_.clear();
+    page_counts_.clear();
+    publication_years_.clear();
+    is_ebook_.clear();
+    author_ids_.clear();
+    language_ids_.clear();
+    publisher_ids_.clear();
+    genre_ranges_.clear();
+    genre_ids_.clear();
+}
+
+std::optional<BookView> BookCatalog::find(const std::string& id) const {
+    auto it = row_by_id_.find(id);
+    if (it == row_by_id_.end()) {
+        return std::nullopt;
+    }
+    return BookView(*this, it->second);
+}
+
+size_t BookCatalog::memoryUsage() const {
+    size_t bytes = text_heap_.capacity();
+    bytes += text_.capacity() * sizeof(TextFields);
+    bytes += average_ratings_.capacity() * sizeof(double);
+    bytes += (ratings_counts_.capacity() + review_counts_.capacity() + page_counts_.capacity()) * sizeof(int32_t);
+    bytes += publication_years_.capacity() * sizeof(int16_t);
+    bytes += is_ebook_.capacity();
+    bytes += (author_ids_.capacity() + language_ids_.capacity() + publisher_ids_.capacity()) * sizeof(uint32_t);
+    bytes += genre_ranges_.capacity() * sizeof(GenreRange);
+    bytes += genre_ids_.capacity() * sizeof(uint32_t);
+
+    for (const auto& [id, row] : row_by_id_) {
+        bytes += sizeof(std::string) + sizeof(row) + sizeof(void*);
+        if (id.capacity() > std::string().capacity()) {
+            bytes += id.capacity();
+        }
+    }
+
+    bytes += authors_.memoryUsage() + genres_.memoryUsage() +
+             languages_.memoryUsage() + publishers_.memoryUsage();
+    return bytes;
+}
+
+BookCatalog::TextRef BookCatalog::appendText(const std::string& value) {
+    if (text_heap_.size() + value.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("BookCatalog text heap exceeds 4 GiB");
+    }
+    TextRef ref{static_cast<uint32_t>(text_heap_.size()), static_cast<uint32_t>(value.size())};
+    text_heap_.append(value);
+    return ref;
+}
+
+std::string_view BookCatalog::text(TextRef ref) const {
+    return std::string_view(text_heap_.data() + ref.offset, ref.length);
+}
+
+size_t BookCatalog::textBytes(const TextFields& fields) const {
+    size_t bytes = fields.id.length + fields.title.length + fields.description.length +
+                   fields.publication_date.length + fields.isbn13.length;
+    if (fields.series.offset != NO_SERIES) {
+        bytes += fields.series.length;
+    }
+    return bytes;
+}
+
+BookCatalog::GenreRange BookCatalog::appendGenres(const std::vector<std::string>& genres) {
+    GenreRange range{static_cast<uint32_t>(genre_ids_.size()), static_cast<uint32_t>(genres.size())};
+    for (const auto& genre : genres) {
+        genre_ids_.push_back(genres_.intern(genre));
+    }
+    return range;
+}
+
+void BookCatalog::append(const Book& book) {
+    auto row = static_cast<uint32_t>(size());
+
+    text_.emplace_back();
+    average_ratings_.emplace_back();
+    ratings_counts_.emplace_back();
+    review_counts_.emplace_back();
+    page_counts_.emplace_back();
+    publication_years_.emplace_back();
+    is_ebook_.emplace_back();
+    author_ids_.emplace_back();
+    language_ids_.emplace_back();
+    publisher_ids_.emplace_back();
+    genre_ranges_.emplace_back();
+
+    row_by_id_.emplace(book.getId(), row);
+    overwrite(row, book);
+}
+
+void BookCatalog::overwrite(uint32_t row, const Book& book) {
+    TextFields fields;
+    fields.id = appendText(book.getId());
+    fields.title = appendText(book.getTitle());
+    fields.description = appendText(book.getDescription());
+    if (book.getSeries()) {
+        fields.series = appendText(*book.getSeries());
+    } else {
+        fields.series.offset = NO_SERIES;
+    }
+    fields.publication_date = appendText(book.getPublicationDate());
+    fields.isbn13 = appendText(book.getIsbn13());
+
+    // Rows created by append() start zeroed, so retiring them is a no-op
+    retire(row);
+    text_[row] = fields;
+    genre_ranges_[row] = appendGenres(book.getGenres());
+
+    average_ratings_[row] = book.getAverageRating();
+    ratings_counts_[row] = book.getRatingsCount();
+    review_counts_[row] = book.getReviewCount();
+    page_counts_[row] = book.getPageCount();
+    publication_years_[row] = static_cast<int16_t>(book.getPublicationYear());
+    is_ebook_[row] = book.isEbook() ? 1 : 0;
+    author_ids_[row] = authors_.intern(book.getAuthor());
+    language_ids_[row] = languages_.intern(book.getLanguage());
+    publisher_ids_[row] = publishers_.intern(book.getPublisher());
+}
+
+void BookCatalog::retire(uint32_t row) {
+    dead_text_bytes_ += textBytes(text_[row]);
+    dead_genre_ids_ += genre_ranges_[row].length;
+}
+
+void BookCatalog::moveRow(uint32_t from, uint32_t to) {
+    text_[to] = text_[from];
+    average_ratings_[to] = average_ratings_[from];
+    ratings_counts_[to] = ratings_counts_[from];
+    review_counts_[to] = review_counts_[from];
+    page_counts_[to] = page_counts_[from];
+    publication_years_[to] = publication_years_[from];
+    is_ebook_[to] = is_ebook_[from];
+    author_ids_[to] = author_ids_[from];
+    language_ids_[to] = language_ids_[from];
+    publisher_ids_[to] = publisher_ids_[from];
+    genre_ranges_[to] = genre_ranges_[from];
+}
+
+void BookCatalog::popRow() {
+    text_.pop_back();
+    average_ratings_.pop_back();
+    ratings_counts_.pop_back();
+    review_counts_.pop_back();
+    page_counts_.pop_back();
+    publication_years_.pop_back();
+    is_ebook_.pop_back();
+    author_ids_.pop_back();
+    language_ids_.pop_back();
+    publisher_ids_.pop_back();
+    genre_ranges_.pop_back();
+}
+
+void BookCatalog::compact() {
+    if (dead_text_bytes_ * 2 > text_heap_.size()) {
+        std::string heap;
+        heap.reserve(text_heap_.size() - dead_text_bytes_);
+
+        auto move = [&](TextRef& ref) {
+            uint32_t offset = static_cast<uint32_t>(heap.size());
+            heap.append(text_heap_, ref.offset, ref.length);
+            ref.offset = offset;
+        };
+        for (auto& fields : text_) {
+            move(fields.id);
+            move(fields.title);
+            move(fields.description);
+            if (fields.series.offset != NO_SERIES) {
+                move(fields.series);
+            }
+            move(fields.publication_date);
+            move(fields.isbn13);
+        }
+
+        text_heap_.swap(heap);
+        dead_text_bytes_ = 0;
+    }
+
+    if (dead_genre_ids_ * 2 > genre_ids_.size()) {
+        std::vector<uint32_t> ids;
+        ids.reserve(genre_ids_.size() - dead_genre_ids_);
+        for (auto& range : genre_ranges_) {
+            uint32_t offset = static_cast<uint32_t>(ids.size());
+            ids.insert(ids.end(), genre_ids_.begin() + range.offset,
+                       genre_ids_.begin() + range.offset + range.length);
+            range.offset = offset;
+        }
+
+        genre_ids_.swap(ids);
+        dead_genre_ids_ = 0;
+    }
+}
+
+}
@@ -2,13 +2,153 @@
 #include "book_recommender/Document.hpp"
 #include <filesystem>
 #include <algorithm>
-#include <unordered_map>
+#include <cctype>
 #include <spdlog/spdlog.h>
+#include "book_recommender/AllocationTracking.hpp"
+#include "book_recommender/Metrics.hpp"
+#include "book_recommender/TaskExecutor.hpp"
+#include "book_recommender/Tracing.hpp"
 
 namespace book_recommender {
 
+namespace {
+
+struct OperationMetrics {
+    Counter& requests;
+    Counter& allocations;
+    Counter& allocated_bytes;
+    Counter& coalesced;
+};
+
+OperationMetrics makeOperationMetrics(const char* operation) {
+    auto& registry = MetricsRegistry::getInstance();
+    MetricLabels labels{{"operation", operation}};
+    return {
+        registry.counter("book_recommender_requests_total",
+                         "Requests served by BookRecommender", labels),
+        registry.counter("book_recommender_request_allocations_total",
+                         "Heap allocations made while serving requests", labels),
+        registry.counter("book_recommender_request_allocated_bytes_total",
+                         "Heap bytes allocated while serving requests", labels),
+        registry.counter("book_recommender_coalesced_requests_total",
+                         "Requests answered by joining an identical in-flight request", labels)
+    };
+}
+
+// Trims and collapses internal whitespace; free-text queries are also
+// lowercased since case does not change their meaning
+std::string normalizeInput(const std::string& input, bool lowercase) {
+    std::string normalized;
+    normalized.reserve(input.size());
+    bool pending_space = false;
+    for (unsigned char c : input) {
+        if (std::isspace(c)) {
+            pending_space = !normalized.empty();
+            continue;
+        }
+        if (pending_space) {
+            normalized.push_back(' ');
+            pending_space = false;
+        }
+        normalized.push_back(lowercase ? static_cast<char>(std::tolower(c)) : static_cast<char>(c));
+    }
+    return normalized;
+}
+
+struct ResponseCacheMetrics {
+    Counter& hits;
+    Counter& misses;
+    Gauge& bytes;
+};
+
+ResponseCacheMetrics& responseCacheMetrics() {
+    auto& registry = MetricsRegistry::getInstance();
+    static ResponseCacheMetrics metrics{
+        registry.counter("book_recommender_response_cache_lookups_total",
+                         "Response cache lookups", {{"result", "hit"}}),
+        registry.counter("book_recommender_response_cache_lookups_total",
+                         "Response cache lookups", {{"result", "miss"}}),
+        registry.gauge("book_recommender_response_cache_bytes",
+                       "Estimated bytes held by the response cache")
+    };
+    return metrics;
+}
+
+ResponseCacheConfig responseCacheConfig(const BookRecommender::RecommenderConfig& config) {
+    ResponseCacheConfig cache_config;
+    cache_config.max_bytes = config.response_cache_bytes;
+    cache_config.ttl = std::chrono::seconds(config.response_cache_ttl_seconds);
+    cache_config.negative_ttl = std::chrono::seconds(config.negative_cache_ttl_seconds);
+    return cache_config;
+}
+
+ConcurrencyLimiterConfig limiterConfig(const BookRecommender::RecommenderConfig& config) {
+    ConcurrencyLimiterConfig limiter_config;
+    limiter_config.initial_limit = config.concurrency_limit;
+    limiter_config.max_limit = config.max_concurrency_limit;
+    limiter_config.max_queued = config.max_queued_requests;
+    limiter_config.interactive_queue_timeout = std::chrono::milliseconds(config.interactive_queue_timeout_ms);
+    limiter_config.background_queue_timeout = std::chrono::milliseconds(config.background_queue_timeout_ms);
+    return limiter_config;
+}
+
+// Books are shared with the query engine, so only the result records and
+// explanation text count against the budget
+size_t estimateBytes(const std::vector<BookQueryEngine::RecommendationResult>& results) {
+    size_t bytes = sizeof(results) + results.capacity() * sizeof(BookQueryEngine::RecommendationResult);
+    for (const auto& result : results) {
+        bytes += result.explanation.capacity();
+    }
+    return bytes;
+}
+
+std::string requestKey(
+    const char* operation,
+    const std::string& input,
+    const BookQueryEngine::QueryFilter& filter,
+    int top_k
+) {
+    // The input is length-prefixed, so it cannot forge a separator
+    std::string key = operation;
+    key += '\x1f';
+    key += std::to_string(input.size());
+    key += ':';
+    key += input;
+    key += '\x1f';
+    key += filter.digest();
+    key += '\x1f';
+    key += std::to_string(top_k);
+    return key;
+}
+
+// Counts the request and, in allocation-tracking builds, the heap traffic
+// it caused on the calling thread
+class RequestRecorder {
+public:
+    explicit RequestRecorder(OperationMetrics& metrics) : metrics_(metrics) {}
+
+    ~RequestRecorder() {
+        metrics_.requests.increment();
+        if (AllocationScope::isTrackingEnabled()) {
+            auto stats = allocations_.stats();
+            metrics_.allocations.increment(stats.allocations);
+            metrics_.allocated_bytes.increment(stats.bytes);
+        }
+    }
+
+private:
+    OperationMetrics& metrics_;
+    AllocationScope allocations_;
+};
+
+}
+
 BookRecommender::BookRecommender(const RecommenderConfig& config)
-    : config_(config) {
+    : config_(config),
+      response_cache_(responseCacheConfig(config)) {
+    if (config_.admission_control) {
+        limiter_ = std::make_unique<ConcurrencyLimiter>(limiterConfig(config_));
+    }
     validateConfig();
     initialize();
 }
@@ -17,6 +157,13 @@ BookRecommender::~BookRecommender() = default;
 
 void BookRecommender::initialize() {
     try {
+        if (config_.trace_sample_rate > 0.0) {
+            TracingConfig tracing;
+            tracing.sample_rate = config_.trace_sample_rate;
+            tracing.output_path = config_.trace_output_path;
+            Tracer::getInstance().configure(tracing);
+        }
+
         data_loader_ = std::make_unique<BookDataLoader>(config_.data_file);
         data_loader_->setMinRatings(config_.min_ratings);
         data_loader_->setLanguageFilter(config_.language_filter);
@@ -27,12 +174,30 @@ void BookRecommender::initialize() {
         );
 
         query_engine_ = std::make_unique<BookQueryEngine>(vector_store_);
+        if (!config_.genre_taxonomy_path.empty()) {
+            query_engine_->setGenreTaxonomy(std::make_shared<const GenreTaxonomy>(
+                GenreTaxonomy::loadFromFile(config_.genre_taxonomy_path)));
+        }
 
-        if (config_.load_existing_index && tryLoadExistingIndex()) {
+        UserProfileConfig profile_config;
+        profile_config.max_profiles = config_.max_user_profiles;
+        profile_config.max_interests = config_.max_user_interests;
+        profiles_ = std::make_unique<UserProfileStore>(vector_store_, profile_config);
+
+        if (!config_.index_bundle_dir.empty()) {
+            bundles_ = std::make_unique<BundleDirectory>(config_.index_bundle_dir);
+            if (!refreshIndexBundle()) {
+                throw std::runtime_error("No index bundle published in " + config_.index_bundle_dir);
+            }
+        } else if (config_.load_existing_index && tryLoadExistingIndex()) {
             spdlog::info("Successfully loaded existing index");
         } else {
             createNewIndex();
         }
+
+        if (!config_.similarity_graph_path.empty()) {
+            loadSimilarityGraph(config_.similarity_graph_path);
+        }
     } catch (const std::exception& e) {
         spdlog::error("Failed to initialize BookRecommender: {}", e.what());
         throw;
@@ -44,35 +209,269 @@ std::vector<BookQueryEngine::RecommendationResult> BookRecommender::getRecommend
     const BookQueryEngine::QueryFilter& filter,
     int top_k
 ) {
+    static OperationMetrics metrics = makeOperationMetrics("recommend");
+    RequestRecorder recorder(metrics);
+    Span span("BookRecommender.getRecommendations");
+    span.setAttribute("query", query);
+    span.setAttribute("top_k", top_k);
     try {
-        return query_engine_->getRecommendations(query, filter, top_k);
+        bool coalesced = false;
+        bool cache_hit = false;
+        auto results = serveRecommendations(
+            requestKey("recommend", normalizeInput(query, true), filter, top_k),
+            [&] { return query_engine_->getRecommendations(query, filter, top_k); },
+            coalesced,
+            cache_hit
+        );
+        if (coalesced) metrics.coalesced.increment();
+        span.setAttribute("coalesced", coalesced);
+        span.setAttribute("cache_hit", cache_hit);
+        span.setAttribute("result_count", results.size());
+        return results;
+    } catch (const OverloadError& e) {
+        span.setError(e.what());
+        throw;
     } catch (const std::exception& e) {
+        span.setError(e.what());
         spdlog::error("Error getting recommendations: {}", e.what());
         return {};
     }
 }
 
+std::vector<BookQueryEngine::RecommendationResult> BookRecommender::streamRecommendations(
+    const std::string& query,
+    const BookQueryEngine::RecommendationStream& stream,
+    const BookQueryEngine::QueryFilter& filter,
+    int top_k
+) {
+    static OperationMetrics metrics = makeOperationMetrics("recommend_stream");
+    RequestRecorder recorder(metrics);
+    Span span("BookRecommender.streamRecommendations");
+    span.setAttribute("query", query);
+    span.setAttribute("top_k", top_k);
+    try {
+        auto key = requestKey("recommend", normalizeInput(query, true), filter, top_k);
+        uint64_t version = catalog_version_.load(std::memory_order_acquire);
+        if (auto cached = cachedRecommendations(key, version)) {
+            span.setAttribute("cache_hit", true);
+            if (stream.on_results) stream.on_results(*cached);
+            if (stream.on_explanation) {
+                for (size_t i = 0; i < cached->size(); ++i) {
+                    stream.on_explanation(i, (*cached)[i]);
+                }
+            }
+            return *cached;
+        }
+
+        auto results = computeRecommendations(key, version, [&] {
+            return query_engine_->streamRecommendations(query, stream, filter, top_k);
+        });
+        span.setAttribute("result_count", results.size());
+        return results;
+    } catch (const OverloadError& e) {
+        span.setError(e.what());
+        throw;
+    } catch (const std::exception& e) {
+        span.setError(e.what());
+        spdlog::error("Error streaming recommendations: {}", e.what());
+        return {};
+    }
+}
+
+#ifdef BOOK_RECOMMENDER_COROUTINES
+AsyncTask<std::vector<BookQueryEngine::RecommendationResult>> BookRecommender::getRecommendationsAsync(
+    std::string query,
+    BookQueryEngine::QueryFilter filter,
+    int top_k
+) {
+    static OperationMetrics metrics = makeOperationMetrics("recommend_async");
+    metrics.requests.increment();
+    try {
+        auto key = requestKey("recommend", normalizeInput(query, true), filter, top_k);
+        uint64_t version = catalog_version_.load(std::memory_order_acquire);
+        if (auto cached = cachedRecommendations(key, version)) {
+            co_return *cached;
+        }
+
+        // Waiting for a slot would block the thread, so async callers are
+        // shed as soon as the limit is reached
+        auto permit = limiter_ ? limiter_->tryAcquire(TaskPriority::Interactive) : ConcurrencyLimiter::Permit();
+        Recommendations results;
+        try {
+            results = co_await query_engine_->getRecommendationsAsync(
+                std::move(query), std::move(filter), top_k);
+        } catch (...) {
+            permit.abandon();
+            throw;
+        }
+        // The coroutine may finish on another thread, so the engine's
+        // failure count can't tell an error from an empty answer here.
+        // Empty answers are neither cached nor sampled.
+        if (results.empty()) {
+            permit.abandon();
+        } else {
+            storeRecommendations(key, results, version);
+        }
+        co_return results;
+    } catch (const OverloadError&) {
+        throw;
+    } catch (const std::exception& e) {
+        spdlog::error("Error getting recommendations: {}", e.what());
+    }
+    co_return Recommendations{};
+}
+#endif
+
+std::vector<std::vector<BookQueryEngine::RecommendationResult>> BookRecommender::getRecommendationsBatch(
+    const std::vector<std::string>& queries,
+    const BookQueryEngine::QueryFilter& filter,
+    int top_k
+) {
+    static OperationMetrics metrics = makeOperationMetrics("recommend_batch");
+    RequestRecorder recorder(metrics);
+    Span span("BookRecommender.getRecommendationsBatch");
+    span.setAttribute("queries", queries.size());
+    span.setAttribute("top_k", top_k);
+    try {
+        // A batch holds one slot for many queries' worth of work, so its
+        // latency says nothing about a single request's and is not sampled
+        auto permit = admit(TaskPriority::Background);
+        std::vector<std::vector<BookQueryEngine::RecommendationResult>> results;
+        try {
+            results = query_engine_->getRecommendationsBatch(queries, filter, top_k);
+        } catch (...) {
+            permit.abandon();
+            throw;
+        }
+        permit.abandon();
+        return results;
+    } catch (const OverloadError& e) {
+        span.setError(e.what());
+        throw;
+    } catch (const std::exception& e) {
+        span.setError(e.what());
+        spdlog::error("Error getting batch recommendations: {}", e.what());
+        return std::vector<std::vector<BookQueryEngine::RecommendationResult>>(queries.size());
+    }
+}
+
 std::vector<BookQueryEngine::RecommendationResult> BookRecommender::getSimilarBooks(
     const std::string& book_id,
     const BookQueryEngine::QueryFilter& filter,
     int top_k
 ) {
+    static OperationMetrics metrics = makeOperationMetrics("similar");
+    RequestRecorder recorder(metrics);
+    Span span("BookRecommender.getSimilarBooks");
+    span.setAttribute("book_id", book_id);
+    span.setAttribute("top_k", top_k);
     try {
-        return query_engine_->getSimilarBooks(book_id, filter, top_k);
+        bool coalesced = false;
+        bool cache_hit = false;
+        auto results = serveRecommendations(
+            requestKey("similar", normalizeInput(book_id, false), filter, top_k),
+            [&] { return query_engine_->getSimilarBooks(book_id, filter, top_k); },
+            coalesced,
+            cache_hit
+        );
+        if (coalesced) metrics.coalesced.increment();
+        span.setAttribute("coalesced", coalesced);
+        span.setAttribute("cache_hit", cache_hit);
+        span.setAttribute("result_count", results.size());
+        return results;
+    } catch (const OverloadError& e) {
+        span.setError(e.what());
+        throw;
     } catch (const std::exception& e) {
+        span.setError(e.what());
         spdlog::error("Error getting similar books: {}", e.what());
         return {};
     }
 }
 
+std::vector<BookQueryEngine::RecommendationResult> BookRecommender::getPersonalizedRecommendations(
+    const std::string& user_id,
+    const BookQueryEngine::QueryFilter& filter,
+    int top_k
+) {
+    static OperationMetrics metrics = makeOperationMetrics("personalized");
+    RequestRecorder recorder(metrics);
+    Span span("BookRecommender.getPersonalizedRecommendations");
+    span.setAttribute("user_id", user_id);
+    span.setAttribute("top_k", top_k);
+    try {
+        auto profile = profiles_->getProfile(user_id);
+        if (!profile) {
+            span.setAttribute("result_count", 0);
+            return {};
+        }
+
+        // Every profile update gets a new version, so answers cached for an
+        // older profile are never served after a read
+        bool coalesced = false;
+        bool cache_hit = false;
+        auto results = serveRecommendations(
+            requestKey("personalized", user_id + '\x1e' + std::to_string(profile->version), filter, top_k),
+            [&] { return query_engine_->getPersonalizedRecommendations(*profiles_, *profile, filter, top_k); },
+            coalesced,
+            cache_hit
+        );
+        if (coalesced) metrics.coalesced.increment();
+        span.setAttribute("coalesced", coalesced);
+        span.setAttribute("cache_hit", cache_hit);
+        span.setAttribute("result_count", results.size());
+        return results;
+    } catch (const OverloadError& e) {
+        span.setError(e.what());
+        throw;
+    } catch (const std::exception& e) {
+        span.setError(e.what());
+        spdlog::error("Error getting personalized recommendations: {}", e.what());
+        return {};
+    }
+}
+
+void BookRecommender::setReadingHistoryLoader(UserProfileStore::HistoryLoader loader) {
+    profiles_->setHistoryLoader(std::move(loader));
+}
+
+void BookRecommender::setReadingHistory(const std::string& user_id, const std::vector<ReadEvent>& history) {
+    profiles_->setHistory(user_id, history);
+}
+
+void BookRecommender::recordRead(const std::string& user_id, const std::string& book_id, float weight) {
+    profiles_->recordRead(user_id, {book_id, weight});
+}
+
 std::vector<BookQueryEngine::RecommendationResult> BookRecommender::getAuthorRecommendations(
     const std::string& author,
     const BookQueryEngine::QueryFilter& filter,
     int top_k
 ) {
+    static OperationMetrics metrics = makeOperationMetrics("author");
+    RequestRecorder recorder(metrics);
+    Span span("BookRecommender.getAuthorRecommendations");
+    span.setAttribute("author", author);
+    span.setAttribute("top_k", top_k);
     try {
-        return query_engine_->getAuthorRecommendations(author, filter, top_k);
+        bool coalesced = false;
+        bool cache_hit = false;
+        auto results = serveRecommendations(
+            requestKey("author", normalizeInput(author, false), filter, top_k),
+            [&] { return query_engine_->getAuthorRecommendations(author, filter, top_k); },
+            coalesced,
+            cache_hit
+        );
+        if (coalesced) metrics.coalesced.increment();
+        span.setAttribute("coalesced", coalesced);
+        span.setAttribute("cache_hit", cache_hit);
+        span.setAttribute("result_count", results.size());
+        return results;
+    } catch (const OverloadError& e) {
+        span.setError(e.what());
+        throw;
     } catch (const std::exception& e) {
+        span.setError(e.what());
         spdlog::error("Error getting author recommendations: {}", e.what());
         return {};
     }
@@ -83,43 +482,93 @@ std::vector<BookQueryEngine::RecommendationResult> BookRecommender::getSeriesRec
     const BookQueryEngine::QueryFilter& filter,
     int top_k
 ) {
+    static OperationMetrics metrics = makeOperationMetrics("series");
+    RequestRecorder recorder(metrics);
+    Span span("BookRecommender.getSeriesRecommendations");
+    span.setAttribute("series", series);
+    span.setAttribute("top_k", top_k);
     try {
-        return query_engine_->getSeriesRecommendations(series, filter, top_k);
+        bool coalesced = false;
+        bool cache_hit = false;
+        auto results = serveRecommendations(
+            requestKey("series", normalizeInput(series, false), filter, top_k),
+            [&] { return query_engine_->getSeriesRecommendations(series, filter, top_k); },
+            coalesced,
+            cache_hit
+        );
+        if (coalesced) metrics.coalesced.increment();
+        span.setAttribute("coalesced", coalesced);
+        span.setAttribute("cache_hit", cache_hit);
+        span.setAttribute("result_count", results.size());
+        return results;
+    } catch (const OverloadError& e) {
+        span.setError(e.what());
+        throw;
     } catch (const std::exception& e) {
+        span.setError(e.what());
         spdlog::error("Error getting series recommendations: {}", e.what());
         return {};
     }
 }
 
-std::vector<Book> BookRecommender::searchBooks(
+std::vector<std::shared_ptr<const Book>> BookRecommender::searchBooks(
     const std::string& query,
     const BookQueryEngine::QueryFilter& filter
 ) {
+    static OperationMetrics metrics = makeOperationMetrics("search");
+    RequestRecorder recorder(metrics);
+    Span span("BookRecommender.searchBooks");
+    span.setAttribute("query", query);
     try {
-        auto results = query_engine_->getRecommendations(query, filter, 100);
-        std::vector<Book> books;
+        // Same answer as a 100-result recommendation, so share its cache
+        // entries and in-flight computations
+        bool coalesced = false;
+        bool cache_hit = false;
+        auto results = serveRecommendations(
+            requestKey("recommend", normalizeInput(query, true), filter, 100),
+            [&] { return query_engine_->getRecommendations(query, filter, 100); },
+            coalesced,
+            cache_hit
+        );
+        if (coalesced) metrics.coalesced.increment();
+        span.setAttribute("coalesced", coalesced);
+        span.setAttribute("cache_hit", cache_hit);
+        span.setAttribute("result_count", results.size());
+        std::vector<std::shared_ptr<const Book>> books;
         books.reserve(results.size());
-        std::transform(results.begin(), results.end(), std::back_inserter(books),
-                      [](const auto& result) { return result.book; });
+        for (auto& result : results) {
+            books.push_back(std::move(result.book));
+        }
         return books;
+    } catch (const OverloadError& e) {
+        span.setError(e.what());
+        throw;
     } catch (const std::exception& e) {
+        span.setError(e.what());
         spdlog::error("Error searching books: {}", e.what());
         return {};
     }
 }
 
 std::vector<std::string> BookRecommender::getPopularGenres(int top_k) const {
-    std::unordered_map<std::string, int> genre_counts;
-    
-    for (const auto& book : books_) {
-        for (const auto& genre : book.getGenres()) {
-            genre_counts[genre]++;
+    if (auto bundle = vector_store_->attachedBundle()) {
+        return bundle->popularGenres(top_k);
+    }
+
+    // Count by interned id; names are only looked up for the winners
+    std::vector<int> genre_counts(catalog_.genres().size(), 0);
+    for (uint32_t row = 0; row < catalog_.size(); ++row) {
+        for (auto it = catalog_.genreIdsBegin(row); it != catalog_.genreIdsEnd(row); ++it) {
+            genre_counts[*it]++;
         }
     }
 
-    std::vector<std::pair<std::string, int>> genre_pairs(
-        genre_counts.begin(), genre_counts.end()
-    );
+    std::vector<std::pair<uint32_t, int>> genre_pairs;
+    for (uint32_t id = 0; id < genre_counts.size(); ++id) {
+        if (genre_counts[id] > 0) {
+            genre_pairs.emplace_back(id, genre_counts[id]);
+        }
+    }
     
     std::partial_sort(
         genre_pairs.begin(),
@@ -131,22 +580,28 @@ std::vector<std::string> BookRecommender::getPopularGenres(int top_k) const {
     std::vector<std::string> popular_genres;
     popular_genres.reserve(top_k);
     for (int i = 0; i < top_k && i < static_cast<int>(genre_pairs.size()); ++i) {
-        popular_genres.push_back(genre_pairs[i].first);
+        popular_genres.push_back(catalog_.genres().get(genre_pairs[i].first));
     }
     
     return popular_genres;
 }
 
 std::vector<std::string> BookRecommender::getPopularAuthors(int top_k) const {
-    std::unordered_map<std::string, int> author_counts;
-    
-    for (const auto& book : books_) {
-        author_counts[book.getAuthor()]++;
+    if (auto bundle = vector_store_->attachedBundle()) {
+        return bundle->popularAuthors(top_k);
     }
 
-    std::vector<std::pair<std::string, int>> author_pairs(
-        author_counts.begin(), author_counts.end()
-    );
+    std::vector<int> author_counts(catalog_.authors().size(), 0);
+    for (uint32_t id : catalog_.authorIds()) {
+        author_counts[id]++;
+    }
+
+    std::vector<std::pair<uint32_t, int>> author_pairs;
+    for (uint32_t id = 0; id < author_counts.size(); ++id) {
+        if (author_counts[id] > 0) {
+            author_pairs.emplace_back(id, author_counts[id]);
+        }
+    }
     
     std::partial_sort(
         author_pairs.begin(),
@@ -158,28 +613,49 @@ std::vector<std::string> BookRecommender::getPopularAuthors(int top_k) const {
     std::vector<std::string> popular_authors;
     popular_authors.reserve(top_k);
     for (int i = 0; i < top_k && i < static_cast<int>(author_pairs.size()); ++i) {
-        popular_authors.push_back(author_pairs[i].first);
+        popular_authors.push_back(catalog_.authors().get(author_pairs[i].first));
     }
     
     return popular_authors;
 }
 
 std::vector<Book> BookRecommender::getTopRatedBooks(int limit) const {
-    std::vector<Book> top_books = books_;
-    
+    if (auto bundle = vector_store_->attachedBundle()) {
+        std::vector<Book> top_books;
+        for (uint32_t row : bundle->topRatedRows(limit)) {
+            top_books.push_back(bundle->book(row));
+        }
+        return top_books;
+    }
+
+    // Rank row numbers against the rating columns and only materialize
+    // the books that make the cut
+    const auto& ratings = catalog_.averageRatings();
+    const auto& counts = catalog_.ratingsCounts();
+
+    std::vector<uint32_t> rows(catalog_.size());
+    for (uint32_t row = 0; row < rows.size(); ++row) {
+        rows[row] = row;
+    }
+
+    size_t count = std::min(static_cast<size_t>(std::max(limit, 0)), rows.size());
     std::partial_sort(
-        top_books.begin(),
-        top_books.begin() + std::min(limit, static_cast<int>(top_books.size())),
-        top_books.end(),
-        [](const Book& a, const Book& b) {
-            if (a.getAverageRating() == b.getAverageRating()) {
-                return a.getRatingsCount() > b.getRatingsCount();
+        rows.begin(),
+        rows.begin() + count,
+        rows.end(),
+        [&](uint32_t a, uint32_t b) {
+            if (ratings[a] == ratings[b]) {
+                return counts[a] > counts[b];
             }
-            return a.getAverageRating() > b.getAverageRating();
+            return ratings[a] > ratings[b];
         }
     );
 
-    top_books.resize(std::min(limit, static_cast<int>(top_books.size())));
+    std::vector<Book> top_books;
+    top_books.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        top_books.push_back(catalog_[rows[i]].toBook());
+    }
     return top_books;
 }
 
@@ -189,39 +665,61 @@ void BookRecommender::saveIndex(const std::string& path) {
 
 void BookRecommender::loadIndex(const std::string& path) {
     vector_store_->loadIndex(path);
+    bumpCatalogVersion();
 }
 
 void BookRecommender::rebuildIndex() {
     createNewIndex();
+    bumpCatalogVersion();
+}
+
+void BookRecommender::loadSimilarityGraph(const std::string& path) {
+    auto graph = std::make_shared<const SimilarityGraph>(SimilarityGraph::load(path));
+    spdlog::info("Loaded similarity graph with {} books (k={}) from {}", graph->size(), graph->k(), path);
+    query_engine_->setSimilarityGraph(std::move(graph));
+    bumpCatalogVersion();
 }
 
 void BookRecommender::updateBook(const Book& book) {
-    // Find and update book in books_ vector
-    auto it = std::find_if(books_.begin(), books_.end(),
-                          [&](const Book& b) { return b.getId() == book.getId(); });
-    
-    if (it != books_.end()) {
-        *it = book;
-    } else {
-        books_.push_back(book);
+    if (bundles_) {
+        throw std::logic_error("Catalog is read-only while attached to an index bundle");
     }
+    catalog_.upsert(book);
 
     // Update vector store
-    std::vector<Document> doc = data_loader_->getPreprocessor().createDocument(book);
+    Document doc = data_loader_->getPreprocessor().createDocument(book);
     vector_store_->addDocuments({doc});
+    query_engine_->onBookUpserted(book.getId());
+    bumpCatalogVersion();
 }
 
 void BookRecommender::removeBook(const std::string& book_id) {
-    books_.erase(
-        std::remove_if(
-            books_.begin(),
-            books_.end(),
-            [&](const Book& b) { return b.getId() == book_id; }
-        ),
-        books_.end()
-    );
-    
+    if (bundles_) {
+        throw std::logic_error("Catalog is read-only while attached to an index bundle");
+    }
+    catalog_.remove(book_id);
     vector_store_->removeDocument(book_id);
+    query_engine_->onBookRemoved(book_id);
+    bumpCatalogVersion();
+}
+
+uint64_t BookRecommender::publishIndexBundle(const std::string& dir, size_t keep) const {
+    BundleDirectory directory(dir);
+    return directory.publish(
+        catalog_,
+        config_.embedding_dimension,
+        [this](const std::string& id, float* out) { return vector_store_->getVector(id, out); },
+        keep
+    );
+}
+
+bool BookRecommender::refreshIndexBundle() {
+    if (!bundles_ || !bundles_->refresh()) {
+        return false;
+    }
+    vector_store_->attachBundle(bundles_->current());
+    bumpCatalogVersion();
+    return true;
 }
 
 void BookRecommender::validateConfig() const {
@@ -234,6 +732,9 @@ void BookRecommender::validateConfig() const {
     if (config_.min_ratings < 0) {
         throw std::invalid_argument("Invalid minimum ratings");
     }
+    if (config_.response_cache_ttl_seconds < 0 || config_.negative_cache_ttl_seconds < 0) {
+        throw std::invalid_argument("Invalid response cache TTL");
+    }
 }
 
 std::string BookRecommender::getDefaultIndexPath() const {
@@ -241,14 +742,24 @@ std::string BookRecommender::getDefaultIndexPath() const {
 }
 
 void BookRecommender::processBooks(const std::vector<Book>& books) {
+    // Preprocessing is independent per book; ingest runs at background
+    // priority so it never holds up live queries
+    std::vector<std::optional<Document>> prepared(books.size());
+    TaskExecutor::getInstance().parallelFor(0, books.size(), [&](size_t i) {
+        prepared[i].emplace(data_loader_->getPreprocessor().createDocument(books[i]));
+    }, TaskPriority::Background, 64);
+
     std::vector<Document> documents;
     documents.reserve(books.size());
-
-    for (const auto& book : books) {
-        documents.push_back(data_loader_->getPreprocessor().createDocument(book));
+    for (auto& document : prepared) {
+        documents.push_back(std::move(*document));
     }
 
     vector_store_->batchAddDocuments(documents);
+    catalog_.assign(books);
+    bumpCatalogVersion();
+    spdlog::info("Catalog holds {} books in {:.1f} MiB",
+                 catalog_.size(), catalog_.memoryUsage() / (1024.0 * 1024.0));
     updatePopularityMetrics();
 }
 
@@ -257,4 +768,95 @@ void BookRecommender::updatePopularityMetrics() {
     vector_store_->optimizeIndex();
 }
 
-}
\ No newline at end of file
+void BookRecommender::bumpCatalogVersion() {
+    // Bumped after the change is applied, so answers still being computed
+    // from the old catalog are filed under the old version and never served.
+    // Clearing just releases the memory of entries that are now unreachable.
+    catalog_version_.fetch_add(1, std::memory_order_acq_rel);
+    response_cache_.clear();
+    responseCacheMetrics().bytes.set(0);
+}
+
+BookRecommender::Recommendations BookRecommender::serveRecommendations(
+    const std::string& key,
+    const std::function<Recommendations()>& compute,
+    bool& coalesced,
+    bool& cache_hit
+) {
+    uint64_t version = catalog_version_.load(std::memory_order_acquire);
+    if (auto cached = cachedRecommendations(key, version)) {
+        cache_hit = true;
+        return *cached;
+    }
+
+    // Only computations take an admission slot: cache hits and callers
+    // joining an in-flight request add no load downstream, and their fast
+    // responses would skew the limiter's latency baseline. Requests arriving
+    // after a catalog change start their own computation rather than join
+    // one running against the old catalog.
+    std::string flight_key = key;
+    flight_key += '\x1f';
+    flight_key += std::to_string(version);
+    return inflight_.run(flight_key, [&] {
+        return computeRecommendations(key, version, compute);
+    }, &coalesced);
+}
+
+// Runs `compute` under an admission slot and caches its answer. The engine
+// answers a failed query with an empty list too, so failures are told apart
+// by its failure count: they return the slot without a latency sample, and
+// are not cached as negative answers.
+BookRecommender::Recommendations BookRecommender::computeRecommendations(
+    const std::string& key,
+    uint64_t version,
+    const std::function<Recommendations()>& compute
+) {
+    auto permit = admit(TaskPriority::Interactive);
+    uint64_t failures = BookQueryEngine::getThreadFailureCount();
+    Recommendations results;
+    try {
+        results = compute();
+    } catch (...) {
+        permit.abandon();
+        throw;
+    }
+    if (BookQueryEngine::getThreadFailureCount() != failures) {
+        permit.abandon();
+        return results;
+    }
+    storeRecommendations(key, results, version);
+    return results;
+}
+
+std::shared_ptr<const BookRecommender::Recommendations> BookRecommender::cachedRecommendations(
+    const std::string& key,
+    uint64_t version
+) {
+    if (!response_cache_.enabled()) return nullptr;
+    auto& cache_metrics = responseCacheMetrics();
+    auto cached = response_cache_.get(key, version);
+    (cached ? cache_metrics.hits : cache_metrics.misses).increment();
+    return cached;
+}
+
+ConcurrencyLimiter::Permit BookRecommender::admit(TaskPriority priority) {
+    return limiter_ ? limiter_->acquire(priority) : ConcurrencyLimiter::Permit();
+}
+
+void BookRecommender::storeRecommendations(
+    const std::string& key,
+    const Recommendations& results,
+    uint64_t version
+) {
+    if (!response_cache_.enabled()) return;
+    response_cache_.put(
+        key,
+        std::make_shared<const Recommendations>(results),
+        estimateBytes(results),
+        results.empty(),
+        version
+    );
+    responseCacheMetrics().bytes.set(static_cast<int64_t>(response_cache_.stats().bytes));
+}
+
+}
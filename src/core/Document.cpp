@@ -22,6 +22,14 @@ void Document::setEmbedding(Embedding embedding) {
     embedding_ = std::move(embedding);
 }
 
+void Document::setFieldEmbeddings(const std::string& field, std::vector<Embedding> embeddings) {
+    if (embeddings.empty()) {
+        field_embeddings_.erase(field);
+    } else {
+        field_embeddings_[field] = std::move(embeddings);
+    }
+}
+
 void Document::updateMetadata(const Metadata& new_metadata) {
     metadata_.insert(new_metadata.begin(), new_metadata.end());
 }
@@ -135,6 +143,9 @@ nlohmann::json Document::toJson() const {
     if (embedding_) {
         j["embedding"] = *embedding_;
     }
+    if (!field_embeddings_.empty()) {
+        j["field_embeddings"] = field_embeddings_;
+    }
     j["timestamp"] = std::chrono::system_clock::to_time_t(timestamp_);
     
     // Add computed fields
@@ -156,12 +167,18 @@ Document Document::fromJson(const nlohmann::json& j) {
         embedding = j["embedding"].get<Embedding>();
     }
 
-    return Document(
+    Document document(
         j["id"].get<std::string>(),
         j["text"].get<std::string>(),
         j["metadata"].get<Metadata>(),
         embedding
     );
+    if (j.contains("field_embeddings")) {
+        for (auto& [field, embeddings] : j["field_embeddings"].get<FieldEmbeddings>()) {
+            document.setFieldEmbeddings(field, std::move(embeddings));
+        }
+    }
+    return document;
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "book_recommender/GenreTaxonomy.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace book_recommender {
+
+namespace {
+
+std::string lowercase(std::string_view text) {
+    std::string result(text);
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return result;
+}
+
+}
+
+GenreTaxonomy::GenreTaxonomy(const std::vector<Edge>& edges, const std::vector<std::string>& genres) {
+    for (const auto& genre : genres) {
+        intern(genre);
+    }
+    std::vector<std::pair<GenreId, GenreId>> links;
+    links.reserve(edges.size());
+    for (const auto& [child, parent] : edges) {
+        links.emplace_back(intern(child), intern(parent));
+    }
+
+    size_t n = names_.size();
+    std::vector<std::vector<GenreId>> parents(n);
+    std::vector<std::vector<GenreId>> children(n);
+    std::vector<size_t> pending_parents(n, 0);
+    for (const auto& [child, parent] : links) {
+        if (child == parent) {
+            throw std::invalid_argument("Genre taxonomy has a self-loop on " + names_[child]);
+        }
+        parents[child].push_back(parent);
+        children[parent].push_back(child);
+        ++pending_parents[child];
+    }
+
+    // Kahn's algorithm: every genre comes after all of its parents
+    std::vector<GenreId> order;
+    order.reserve(n);
+    for (GenreId id = 0; id < n; ++id) {
+        if (pending_parents[id] == 0) order.push_back(id);
+    }
+    for (size_t i = 0; i < order.size(); ++i) {
+        for (GenreId child : children[order[i]]) {
+            if (--pending_parents[child] == 0) order.push_back(child);
+        }
+    }
+    if (order.size() != n) {
+        auto stuck = std::find_if(pending_parents.begin(), pending_parents.end(), [](size_t p) { return p > 0; });
+        throw std::invalid_argument("Genre taxonomy has a cycle through " + names_[stuck - pending_parents.begin()]);
+    }
+
+    ancestors_.assign(n, GenreSet(n));
+    descendants_.assign(n, GenreSet(n));
+    for (GenreId id : order) {
+        ancestors_[id].insert(id);
+        for (GenreId parent : parents[id]) {
+            ancestors_[id].merge(ancestors_[parent]);
+        }
+    }
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        descendants_[*it].insert(*it);
+        for (GenreId child : children[*it]) {
+            descendants_[*it].merge(descendants_[child]);
+        }
+    }
+}
+
+GenreTaxonomy GenreTaxonomy::loadFromFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Could not open genre taxonomy: " + path);
+    }
+
+    std::vector<Edge> edges;
+    std::vector<std::string> genres;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string child, parent;
+        if (!(iss >> child) || child[0] == '#') continue;
+        if (iss >> parent) {
+            edges.emplace_back(child, parent);
+        } else {
+            genres.push_back(child);
+        }
+    }
+    return GenreTaxonomy(edges, genres);
+}
+
+GenreTaxonomy GenreTaxonomy::defaultTaxonomy() {
+    return GenreTaxonomy({
+        {"mystery", "fiction"},
+        {"thriller", "fiction"},
+        {"romance", "fiction"},
+        {"science-fiction", "fiction"},
+        {"fantasy", "fiction"},
+        {"horror", "fiction"},
+        {"historical-fiction", "fiction"},
+        {"literary-fiction", "fiction"},
+        {"drama", "fiction"},
+        {"comedy", "fiction"},
+        {"adventure", "fiction"},
+        {"crime", "fiction"},
+        {"contemporary", "fiction"},
+        {"classics", "fiction"},
+        {"biography", "non-fiction"},
+        {"history", "non-fiction"},
+        {"science", "non-fiction"},
+        {"technology", "non-fiction"},
+        {"business", "non-fiction"},
+        {"self-help", "non-fiction"},
+        {"epic-fantasy", "fantasy"},
+        {"urban-fantasy", "fantasy"},
+        {"cozy-mystery", "mystery"},
+        {"detective", "mystery"},
+        {"detective", "crime"},
+        {"space-opera", "science-fiction"},
+        {"cyberpunk", "science-fiction"},
+        {"dystopian", "science-fiction"},
+        {"memoir", "biography"},
+        {"true-crime", "non-fiction"},
+        {"programming", "technology"}
+    }, {"young-adult", "children", "poetry"});
+}
+
+std::optional<GenreTaxonomy::GenreId> GenreTaxonomy::find(std::string_view genre) const {
+    auto it = ids_.find(lowercase(genre));
+    if (it == ids_.end()) return std::nullopt;
+    return it->second;
+}
+
+GenreSet GenreTaxonomy::genreSet(const std::vector<std::string>& genres) const {
+    GenreSet set(size());
+    for (const auto& genre : genres) {
+        if (auto id = find(genre)) set.insert(*id);
+    }
+    return set;
+}
+
+GenreSet GenreTaxonomy::matchSet(const std::vector<std::string>& genres, std::vector<std::string>* unknown) const {
+    GenreSet set(size());
+    for (const auto& genre : genres) {
+        if (auto id = find(genre)) {
+            set.merge(descendants_[*id]);
+        } else if (unknown) {
+            unknown->push_back(genre);
+        }
+    }
+    return set;
+}
+
+GenreTaxonomy::GenreId GenreTaxonomy::intern(const std::string& genre) {
+    auto key = lowercase(genre);
+    auto [it, inserted] = ids_.emplace(key, static_cast<GenreId>(names_.size()));
+    if (inserted) {
+        names_.push_back(std::move(key));
+    }
+    return it->second;
+}
+
+}
@@ -1,15 +1,37 @@
 #include "book_recommender/BookPreprocessor.hpp"
 #include <algorithm>
-#include <regex>
 #include <set>
 #include <sstream>
 #include <cctype>
+#include <cmath>
 #include <fstream>
-#include <Levenshtein.hpp>
+#include <limits>
+#include <stdexcept>
 #include <spdlog/spdlog.h>
 
 namespace book_recommender {
 
+namespace {
+
+// Per-thread scratch so ingest threads preprocess without locking or
+// reallocating
+std::string& normalizedScratch() {
+    thread_local std::string normalized;
+    return normalized;
+}
+
+StemCache& stemCache() {
+    thread_local StemCache stems;
+    return stems;
+}
+
+void appendToken(std::string& text, std::string_view token) {
+    if (!text.empty()) text.push_back(' ');
+    text.append(token);
+}
+
+}
+
 BookPreprocessor::BookPreprocessor() {
     initializeGenreMappings();
     loadCustomGenreMappings();
@@ -64,6 +86,14 @@ void BookPreprocessor::initializeGenreMappings() {
         {"mysteries", "mystery"},
         {"detective", "mystery"}
     };
+
+    // Pre-normalized once here instead of on every comparison
+    for (const auto& genre : standard_genres_) {
+        auto key = genreKey(genre);
+        standard_genre_keys_.emplace(key, genre);
+        longest_genre_key_ = std::max(longest_genre_key_, key.size());
+        standard_genre_index_.insert(std::move(key));
+    }
 }
 
 void BookPreprocessor::loadCustomGenreMappings() {
@@ -78,7 +108,10 @@ void BookPreprocessor::loadCustomGenreMappings() {
             if (iss >> raw >> mapped) {
                 if (std::find(standard_genres_.begin(), standard_genres_.end(), mapped) 
                     != standard_genres_.end()) {
+                    std::lock_guard<std::mutex> lock(genre_mutex_);
                     genre_mapping_[toLowerCase(raw)] = mapped;
+                    genre_cache_.clear();
+                    ++genre_cache_generation_;
                 }
             }
         }
@@ -90,7 +123,12 @@ void BookPreprocessor::loadCustomGenreMappings() {
 void BookPreprocessor::updateGenreMapping(const std::string& raw_genre, const std::string& normalized_genre) {
     if (std::find(standard_genres_.begin(), standard_genres_.end(), normalized_genre) 
         != standard_genres_.end()) {
-        genre_mapping_[raw_genre] = normalized_genre;
+        {
+            std::lock_guard<std::mutex> lock(genre_mutex_);
+            genre_mapping_[raw_genre] = normalized_genre;
+            genre_cache_.clear();
+            ++genre_cache_generation_;
+        }
         
         // Save to custom mappings file
         try {
@@ -102,35 +140,150 @@ void BookPreprocessor::updateGenreMapping(const std::string& raw_genre, const st
     }
 }
 
+std::vector<std::string> BookPreprocessor::normalizeGenres(const std::vector<std::string>& genres) {
+    std::vector<std::string> normalized;
+    normalized.reserve(genres.size());
+
+    for (const auto& raw : genres) {
+        std::string genre;
+        bool cached = false;
+        uint64_t generation = 0;
+        {
+            std::lock_guard<std::mutex> lock(genre_mutex_);
+            auto it = genre_cache_.find(raw);
+            if (it != genre_cache_.end()) {
+                genre = it->second;
+                cached = true;
+            }
+            generation = genre_cache_generation_;
+        }
+        if (!cached) {
+            genre = resolveGenre(raw);
+            // A mapping changed while resolving, so the result may be stale
+            std::lock_guard<std::mutex> lock(genre_mutex_);
+            if (genre_cache_generation_ == generation) {
+                genre_cache_.emplace(raw, genre);
+            }
+        }
+
+        if (!genre.empty() && std::find(normalized.begin(), normalized.end(), genre) == normalized.end()) {
+            normalized.push_back(std::move(genre));
+        }
+    }
+    return normalized;
+}
+
+std::string BookPreprocessor::genreKey(const std::string& genre) {
+    return normalizeText(genre);
+}
+
+std::string BookPreprocessor::resolveGenre(const std::string& raw_genre) {
+    auto key = genreKey(raw_genre);
+    if (key.empty()) return "";
+
+    // Explicit mappings are keyed by the lowercased raw form
+    auto lowered = toLowerCase(raw_genre);
+    {
+        std::lock_guard<std::mutex> lock(genre_mutex_);
+        for (const auto* candidate : {&lowered, &key}) {
+            auto mapped = genre_mapping_.find(*candidate);
+            if (mapped != genre_mapping_.end()) return mapped->second;
+        }
+    }
+
+    auto standard = standard_genre_keys_.find(key);
+    if (standard != standard_genre_keys_.end()) return standard->second;
+
+    return findClosestGenre(raw_genre);
+}
+
+// Standard genre with the lowest length-normalized edit distance, earliest
+// in standard_genres_ on ties. A match must score below the best so far,
+// i.e. have distance < best * max(len), so the BK-tree radius shrinks to
+// best * (longest possible max(len)) as matches improve.
 std::string BookPreprocessor::findClosestGenre(const std::string& raw_genre) {
-    std::string closest = standard_genres_[0];
-    double min_distance = std::numeric_limits<double>::max();
-    
-    for (const auto& standard : standard_genres_) {
-        double distance = calculateGenreSimilarity(raw_genre, standard);
-        
-        if (distance < min_distance) {
-            min_distance = distance;
-            closest = standard;
+    auto key = genreKey(raw_genre);
+    size_t longest = std::max(key.size(), longest_genre_key_);
+    double best_score = std::numeric_limits<double>::max();
+    size_t best_index = 0;
+
+    standard_genre_index_.search(key, longest, [&](size_t index, size_t distance) {
+        size_t max_length = std::max(key.size(), standard_genre_index_.word(index).size());
+        double score = max_length == 0 ? 1.0 : static_cast<double>(distance) / max_length;
+        if (score < best_score || (score == best_score && index < best_index)) {
+            best_score = score;
+            best_index = index;
+        }
+        return static_cast<size_t>(std::floor(best_score * longest + 1e-9));
+    });
+
+    return standard_genres_[best_index];
+}
+
+std::string BookPreprocessor::preprocessText(const std::string& text) {
+    auto& normalized = normalizedScratch();
+    normalizeText(text, normalized);
+
+    std::string result;
+    result.reserve(normalized.size());
+    forEachTerm(normalized, stemCache(), [&](std::string_view term) { appendToken(result, term); });
+    return result;
+}
+
+std::string BookPreprocessor::toLowerCase(const std::string& text) {
+    std::string result(text);
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return result;
+}
+
+std::map<std::string, std::vector<std::string>> BookPreprocessor::createFieldTexts(const Book& book) {
+    std::map<std::string, std::vector<std::string>> fields;
+    fields["title"] = {book.getTitle() + " by " + book.getAuthor()};
+
+    auto chunks = chunkText(book.getDescription());
+    if (!chunks.empty()) {
+        fields["description"] = std::move(chunks);
+    }
+
+    auto genres = normalizeGenres(book.getGenres());
+    if (!genres.empty()) {
+        std::ostringstream tags;
+        for (size_t i = 0; i < genres.size(); ++i) {
+            if (i > 0) tags << ", ";
+            tags << genres[i];
+        }
+        fields["genres"] = {tags.str()};
+    }
+    return fields;
+}
+
+std::vector<std::string> BookPreprocessor::chunkText(const std::string& text, size_t max_words, size_t overlap) {
+    if (max_words == 0) {
+        throw std::invalid_argument("Chunks need at least one word");
+    }
+    overlap = std::min(overlap, max_words - 1);
+
+    std::vector<std::string> words;
+    std::istringstream stream(text);
+    std::string word;
+    while (stream >> word) {
+        words.push_back(std::move(word));
+    }
+
+    std::vector<std::string> chunks;
+    size_t stride = max_words - overlap;
+    for (size_t start = 0; start < words.size(); start += stride) {
+        size_t end = std::min(words.size(), start + max_words);
+        std::string chunk = words[start];
+        for (size_t i = start + 1; i < end; ++i) {
+            chunk += ' ';
+            chunk += words[i];
         }
+        chunks.push_back(std::move(chunk));
+        if (end == words.size()) break;
     }
-    
-    return closest;
-}
-
-double BookPreprocessor::calculateGenreSimilarity(const std::string& genre1, const std::string& genre2) {
-    // Normalize strings
-    std::string g1 = toLowerCase(removePunctuation(genre1));
-    std::string g2 = toLowerCase(removePunctuation(genre2));
-    
-    // Calculate Levenshtein distance
-    int distance = Levenshtein::distance(g1, g2);
-    
-    // Normalize by length of longer string
-    int max_length = std::max(g1.length(), g2.length());
-    if (max_length == 0) return 1.0;
-    
-    return static_cast<double>(distance) / max_length;
-}
-
-}
\ No newline at end of file
+    return chunks;
+}
+
+}
@@ -1,18 +1,83 @@
 #include "book_recommender/BookVectorStore.hpp"
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstring>
 #include <fstream>
 #include <spdlog/spdlog.h>
 #include <faiss/impl/AuxIndexStructures.h>
+#include <faiss/impl/IDSelector.h>
 #include <faiss/index_io.h>
+#include "book_recommender/Metrics.hpp"
+#include "book_recommender/TaskExecutor.hpp"
+#include "book_recommender/Tracing.hpp"
 
 namespace book_recommender {
 
+namespace {
+
+thread_local BookVectorStore::CacheStats thread_cache_stats;
+
+// IVF training needs roughly 39 points per centroid to be meaningful
+constexpr faiss::idx_t MIN_TRAINING_POINTS_PER_LIST = 39;
+
+struct VectorStoreMetrics {
+    Counter& cache_hits;
+    Counter& cache_misses;
+    Gauge& index_size;
+    Histogram& search_latency;
+    Histogram& batch_search_latency;
+};
+
+VectorStoreMetrics& vectorStoreMetrics() {
+    auto& registry = MetricsRegistry::getInstance();
+    static VectorStoreMetrics metrics{
+        registry.counter("book_recommender_vector_cache_lookups_total",
+                         "Vector search cache lookups", {{"result", "hit"}}),
+        registry.counter("book_recommender_vector_cache_lookups_total",
+                         "Vector search cache lookups", {{"result", "miss"}}),
+        registry.gauge("book_recommender_vector_index_size",
+                       "Number of vectors in the flat index"),
+        registry.histogram("book_recommender_vector_search_seconds",
+                           "Vector search latency, cache misses only"),
+        registry.histogram("book_recommender_vector_batch_search_seconds",
+                           "Batched vector search latency, one sample per batch")
+    };
+    return metrics;
+}
+
+// Overwrites row `to` of a flat index with row `from`
+void moveRow(faiss::IndexFlat& index, size_t from, size_t to) {
+    float* vectors = index.get_xb();
+    std::memcpy(vectors + to * index.d, vectors + from * index.d, index.d * sizeof(float));
+}
+
+// Drops the last `count` rows; nothing before them moves
+void dropTail(faiss::IndexFlat& index, size_t count) {
+    if (count == 0) return;
+    faiss::IDSelectorRange tail(index.ntotal - static_cast<faiss::idx_t>(count), index.ntotal);
+    index.remove_ids(tail);
+}
+
+// read_index returns whatever index type the file holds
+template <typename IndexType>
+std::unique_ptr<IndexType> readIndexAs(const std::string& path) {
+    std::unique_ptr<faiss::Index> index(faiss::read_index(path.c_str()));
+    auto* typed = dynamic_cast<IndexType*>(index.get());
+    if (!typed) {
+        throw std::runtime_error("Unexpected index type in " + path);
+    }
+    index.release();
+    return std::unique_ptr<IndexType>(typed);
+}
+
+}
+
 BookVectorStore::BookVectorStore(int dimension, int cache_size)
     : dimension_(dimension)
     , cache_size_(cache_size)
-    , is_trained_(false) {
+    , is_trained_(false)
+    , kernels_(static_cast<size_t>(std::max(dimension, 0))) {
     initializeFlatIndex();
     initializeIVFIndex();
 }
@@ -28,9 +93,666 @@ void BookVectorStore::initializeIVFIndex() {
     ivf_index_ = std::make_unique<faiss::IndexIVFFlat>(
         quantizer, dimension_, 100, faiss::METRIC_INNER_PRODUCT
     );
+    ivf_index_->own_fields = true;
+}
+
+void BookVectorStore::initializeIndex(const std::vector<Document>& documents) {
+    clearIndex();
+    addDocuments(documents);
+    optimizeIndex();
+}
+
+void BookVectorStore::addDocuments(const std::vector<Document>& documents) {
+    if (documents.empty()) return;
+
+    // Validate the whole batch before touching the index, so a bad
+    // document leaves the store as it was
+    std::vector<float> vectors;
+    vectors.reserve(documents.size() * dimension_);
+    for (const auto& doc : documents) {
+        validateDocument(doc);
+        const auto& embedding = *doc.getEmbedding();
+        vectors.insert(vectors.end(), embedding.begin(), embedding.end());
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(index_mutex_);
+
+        // Replace existing documents rather than indexing them twice
+        for (const auto& doc : documents) {
+            if (doc_id_to_index_.count(doc.getId())) {
+                removeDocumentLocked(doc.getId());
+            }
+        }
+
+        size_t next_index = static_cast<size_t>(flat_index_->ntotal);
+        for (const auto& doc : documents) {
+            updateDocumentMapping(doc.getId(), next_index++);
+            document_store_.insert_or_assign(doc.getId(), std::make_shared<const Document>(doc));
+            addFieldVectorsLocked(doc);
+        }
+
+        auto n = static_cast<faiss::idx_t>(documents.size());
+        flat_index_->add(n, vectors.data());
+        if (is_trained_) {
+            ivf_index_->add(n, vectors.data());
+        }
+        vectorStoreMetrics().index_size.set(flat_index_->ntotal);
+    }
+
+    clearCache();
+}
+
+void BookVectorStore::batchAddDocuments(const std::vector<Document>& documents, int batch_size) {
+    batch_size = std::max(batch_size, 1);
+    for (size_t start = 0; start < documents.size(); start += batch_size) {
+        size_t end = std::min(documents.size(), start + static_cast<size_t>(batch_size));
+        addDocuments(std::vector<Document>(documents.begin() + start, documents.begin() + end));
+    }
+}
+
+void BookVectorStore::removeDocument(const std::string& doc_id) {
+    {
+        std::unique_lock<std::shared_mutex> lock(index_mutex_);
+        removeDocumentLocked(doc_id);
+        vectorStoreMetrics().index_size.set(flat_index_->ntotal);
+    }
+    clearCache();
+}
+
+// Caller must hold index_mutex_ exclusively
+void BookVectorStore::removeDocumentLocked(const std::string& doc_id) {
+    auto it = doc_id_to_index_.find(doc_id);
+    if (it == doc_id_to_index_.end()) return;
+
+    // The last row is moved into the hole, so exactly one other document
+    // changes position instead of every later one
+    size_t index = it->second;
+    size_t last = index_to_doc_id_.size() - 1;
+    doc_id_to_index_.erase(it);
+    if (index != last) {
+        moveRow(*flat_index_, last, index);
+        index_to_doc_id_[index] = std::move(index_to_doc_id_[last]);
+        doc_id_to_index_[index_to_doc_id_[index]] = index;
+    }
+    dropTail(*flat_index_, 1);
+    index_to_doc_id_.pop_back();
+    document_store_.erase(doc_id);
+
+    for (auto field = field_indexes_.begin(); field != field_indexes_.end();) {
+        auto& entry = field->second;
+        auto owned = entry.rows.find(doc_id);
+        if (owned != entry.rows.end()) {
+            // Highest rows first, so the tail never holds one of this
+            // document's rows that is still waiting to be removed
+            auto doomed = std::move(owned->second);
+            entry.rows.erase(owned);
+            std::sort(doomed.rbegin(), doomed.rend());
+            size_t size = entry.owners.size();
+            for (size_t row : doomed) {
+                size_t tail = --size;
+                if (row == tail) continue;
+                moveRow(*entry.index, tail, row);
+                auto& moved = entry.rows[entry.owners[tail]];
+                *std::find(moved.begin(), moved.end(), tail) = row;
+                entry.owners[row] = std::move(entry.owners[tail]);
+            }
+            dropTail(*entry.index, doomed.size());
+            entry.owners.resize(size);
+        }
+        field = entry.owners.empty() ? field_indexes_.erase(field) : std::next(field);
+    }
+
+    // IVF ids no longer line up with the flat index until it is retrained
+    is_trained_ = false;
+}
+
+void BookVectorStore::clearIndex() {
+    {
+        std::unique_lock<std::shared_mutex> lock(index_mutex_);
+        flat_index_->reset();
+        ivf_index_->reset();
+        field_indexes_.clear();
+        document_store_.clear();
+        doc_id_to_index_.clear();
+        index_to_doc_id_.clear();
+        is_trained_ = false;
+        vectorStoreMetrics().index_size.set(0);
+    }
+    clearCache();
+}
+
+void BookVectorStore::optimizeIndex() {
+    std::unique_lock<std::shared_mutex> lock(index_mutex_);
+
+    faiss::idx_t n = flat_index_->ntotal;
+    if (n < static_cast<faiss::idx_t>(ivf_index_->nlist) * MIN_TRAINING_POINTS_PER_LIST) {
+        // Too few vectors for IVF to beat a flat scan
+        is_trained_ = false;
+        return;
+    }
+
+    std::vector<float> vectors(static_cast<size_t>(n) * dimension_);
+    flat_index_->reconstruct_n(0, n, vectors.data());
+
+    ivf_index_->reset();
+    ivf_index_->train(n, vectors.data());
+    ivf_index_->add(n, vectors.data());
+    is_trained_ = true;
+    spdlog::info("Trained IVF index over {} vectors", n);
+}
+
+std::vector<BookVectorStore::SearchResult> BookVectorStore::search(
+    const std::vector<float>& query_vector,
+    int top_k,
+    bool use_approximate
+) {
+    auto results = search(query_vector, top_k, use_approximate, std::pmr::get_default_resource());
+    return std::vector<SearchResult>(
+        std::make_move_iterator(results.begin()),
+        std::make_move_iterator(results.end())
+    );
+}
+
+std::pmr::vector<BookVectorStore::SearchResult> BookVectorStore::search(
+    const std::vector<float>& query_vector,
+    int top_k,
+    bool use_approximate,
+    std::pmr::memory_resource* resource
+) {
+    if (query_vector.size() != static_cast<size_t>(dimension_)) {
+        throw std::invalid_argument("Query vector dimension mismatch");
+    }
+
+    std::pmr::vector<SearchResult> results(resource);
+    if (top_k <= 0) return results;
+
+    Span span("BookVectorStore.search");
+    span.setAttribute("top_k", top_k);
+    span.setAttribute("approximate", use_approximate);
+
+    auto cache_key = generateCacheKey(query_vector, top_k);
+    uint64_t generation;
+    if (getFromCache(cache_key, results, generation)) {
+        span.setAttribute("cache_hit", true);
+        return results;
+    }
+    span.setAttribute("cache_hit", false);
+
+    if (auto bundle = attachedBundle()) {
+        ScopedTimer timer(vectorStoreMetrics().search_latency);
+        std::pmr::vector<float> scores(top_k, resource);
+        std::pmr::vector<int64_t> rows(top_k, resource);
+        bundle->search(query_vector.data(), 1, top_k, scores.data(), rows.data());
+        results = processBundleResults(*bundle, scores.data(), rows.data(), rows.size(), resource);
+        span.setAttribute("index", "bundle");
+        span.setAttribute("result_count", results.size());
+        addToCache(cache_key, results, generation);
+        return results;
+    }
+
+    {
+        ScopedTimer timer(vectorStoreMetrics().search_latency);
+        std::shared_lock<std::shared_mutex> lock(index_mutex_);
+
+        faiss::Index* index = (use_approximate && is_trained_)
+            ? static_cast<faiss::Index*>(ivf_index_.get())
+            : static_cast<faiss::Index*>(flat_index_.get());
+        if (index->ntotal == 0) return results;
+
+        faiss::idx_t k = std::min<faiss::idx_t>(top_k, index->ntotal);
+        std::pmr::vector<float> distances(k, resource);
+        std::pmr::vector<faiss::idx_t> labels(k, resource);
+        index->search(1, query_vector.data(), k, distances.data(), labels.data());
+
+        results = processSearchResults(distances.data(), labels.data(), static_cast<size_t>(k), resource);
+        span.setAttribute("index", is_trained_ && use_approximate ? "ivf" : "flat");
+        span.setAttribute("result_count", results.size());
+    }
+
+    addToCache(cache_key, results, generation);
+    return results;
+}
+
+std::vector<BookVectorStore::SearchResult> BookVectorStore::search(
+    const std::vector<float>& query_vector,
+    int top_k,
+    const FusionOptions& fusion
+) {
+    auto results = search(query_vector, top_k, fusion, std::pmr::get_default_resource());
+    return std::vector<SearchResult>(
+        std::make_move_iterator(results.begin()),
+        std::make_move_iterator(results.end())
+    );
+}
+
+std::pmr::vector<BookVectorStore::SearchResult> BookVectorStore::search(
+    const std::vector<float>& query_vector,
+    int top_k,
+    const FusionOptions& fusion,
+    std::pmr::memory_resource* resource
+) {
+    if (attachedBundle() || !hasFieldVectors()) {
+        return search(query_vector, top_k, false, resource);
+    }
+    ScopedTimer timer(vectorStoreMetrics().search_latency);
+    return fusedSearch(query_vector, top_k, fusion, resource);
+}
+
+// Untimed, so single and batched callers record into their own histograms
+std::pmr::vector<BookVectorStore::SearchResult> BookVectorStore::fusedSearch(
+    const std::vector<float>& query_vector,
+    int top_k,
+    const FusionOptions& fusion,
+    std::pmr::memory_resource* resource
+) const {
+    if (query_vector.size() != static_cast<size_t>(dimension_)) {
+        throw std::invalid_argument("Query vector dimension mismatch");
+    }
+
+    std::pmr::vector<SearchResult> results(resource);
+    if (top_k <= 0) return results;
+
+    Span span("BookVectorStore.fusedSearch");
+    span.setAttribute("top_k", top_k);
+    span.setAttribute("mode", fusion.mode == FusionMode::MaxSim ? "max_sim" : "weighted_sum");
+    std::shared_lock<std::shared_mutex> lock(index_mutex_);
+
+    std::vector<std::pair<std::string, float>> fields;
+    for (const auto& [field, weight] : fusion.field_weights) {
+        if (weight > 0 && (field == "combined" || field_indexes_.count(field))) {
+            fields.emplace_back(field, weight);
+        }
+    }
+
+    // Candidate generation: the nearest vectors of every field
+    faiss::idx_t candidates = fusion.candidates_per_field > 0 ? fusion.candidates_per_field : 4 * top_k;
+    std::unordered_map<std::string, std::shared_ptr<const Document>> pool;
+    for (const auto& [field, weight] : fields) {
+        bool combined = field == "combined";
+        faiss::Index* index = combined
+            ? static_cast<faiss::Index*>(flat_index_.get())
+            : static_cast<faiss::Index*>(field_indexes_.at(field).index.get());
+        faiss::idx_t k = std::min(candidates, index->ntotal);
+        if (k == 0) continue;
+
+        std::pmr::vector<float> distances(k, resource);
+        std::pmr::vector<faiss::idx_t> labels(k, resource);
+        index->search(1, query_vector.data(), k, distances.data(), labels.data());
+        for (faiss::idx_t label : labels) {
+            if (label < 0) continue;
+            const auto& doc_id = combined ? index_to_doc_id_[label] : field_indexes_.at(field).owners[label];
+            pool.emplace(doc_id, document_store_.at(doc_id));
+        }
+    }
+
+    // Exact rescoring, so a book found through one field is not penalized
+    // for missing the shortlist of another
+    for (const auto& [doc_id, document] : pool) {
+        float fused = 0.0f;
+        float total_weight = 0.0f;
+        bool scored = false;
+        for (const auto& [field, weight] : fields) {
+            float similarity = fieldSimilarity(*document, field, query_vector.data());
+            if (std::isnan(similarity)) continue;
+            if (fusion.mode == FusionMode::MaxSim) {
+                fused = scored ? std::max(fused, similarity) : similarity;
+            } else {
+                fused += weight * similarity;
+                total_weight += weight;
+            }
+            scored = true;
+        }
+        if (!scored) continue;
+        if (fusion.mode == FusionMode::WeightedSum) {
+            fused /= total_weight;
+        }
+        results.push_back({doc_id, fused, document});
+    }
+
+    auto keep = std::min(results.size(), static_cast<size_t>(top_k));
+    // The pool is unordered, so equal scores are ranked by id to keep
+    // results stable from run to run
+    std::partial_sort(results.begin(), results.begin() + keep, results.end(),
+                      [](const SearchResult& a, const SearchResult& b) {
+                          if (a.similarity != b.similarity) return a.similarity > b.similarity;
+                          return a.doc_id < b.doc_id;
+                      });
+    results.resize(keep);
+
+    span.setAttribute("fields", fields.size());
+    span.setAttribute("candidates", pool.size());
+    span.setAttribute("result_count", results.size());
+    return results;
+}
+
+std::vector<std::vector<BookVectorStore::SearchResult>> BookVectorStore::batchSearch(
+    const std::vector<std::vector<float>>& query_vectors,
+    int top_k,
+    bool use_approximate
+) {
+    std::vector<std::vector<SearchResult>> results(query_vectors.size());
+    if (query_vectors.empty() || top_k <= 0) return results;
+
+    auto n_queries = static_cast<faiss::idx_t>(query_vectors.size());
+    std::vector<float> queries;
+    queries.reserve(query_vectors.size() * dimension_);
+    for (const auto& query_vector : query_vectors) {
+        if (query_vector.size() != static_cast<size_t>(dimension_)) {
+            throw std::invalid_argument("Query vector dimension mismatch");
+        }
+        queries.insert(queries.end(), query_vector.begin(), query_vector.end());
+    }
+
+    Span span("BookVectorStore.batchSearch");
+    span.setAttribute("queries", query_vectors.size());
+    span.setAttribute("top_k", top_k);
+    span.setAttribute("approximate", use_approximate);
+
+    ScopedTimer timer(vectorStoreMetrics().batch_search_latency);
+
+    if (auto bundle = attachedBundle()) {
+        std::vector<float> scores(query_vectors.size() * top_k);
+        std::vector<int64_t> rows(query_vectors.size() * top_k);
+        bundle->search(queries.data(), query_vectors.size(), top_k, scores.data(), rows.data());
+        for (size_t q = 0; q < query_vectors.size(); ++q) {
+            auto batch = processBundleResults(
+                *bundle, scores.data() + q * top_k, rows.data() + q * top_k,
+                static_cast<size_t>(top_k), std::pmr::get_default_resource()
+            );
+            results[q].assign(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+        }
+        span.setAttribute("index", "bundle");
+        return results;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(index_mutex_);
+
+    faiss::Index* index = (use_approximate && is_trained_)
+        ? static_cast<faiss::Index*>(ivf_index_.get())
+        : static_cast<faiss::Index*>(flat_index_.get());
+    if (index->ntotal == 0) return results;
+
+    // A single multi-query call lets the flat index use one GEMM for the
+    // whole batch instead of n_queries matrix-vector products
+    faiss::idx_t k = std::min<faiss::idx_t>(top_k, index->ntotal);
+    std::vector<float> distances(static_cast<size_t>(n_queries * k));
+    std::vector<faiss::idx_t> labels(static_cast<size_t>(n_queries * k));
+    index->search(n_queries, queries.data(), k, distances.data(), labels.data());
+
+    // Materialization only reads the id maps, which the shared lock protects
+    TaskExecutor::getInstance().parallelFor(0, static_cast<size_t>(n_queries), [&](size_t q) {
+        auto batch = processSearchResults(
+            distances.data() + q * k, labels.data() + q * k,
+            static_cast<size_t>(k), std::pmr::get_default_resource()
+        );
+        results[q].assign(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    }, TaskPriority::Background, 16);
+
+    span.setAttribute("index", is_trained_ && use_approximate ? "ivf" : "flat");
+    return results;
+}
+
+std::vector<std::vector<BookVectorStore::SearchResult>> BookVectorStore::batchSearch(
+    const std::vector<std::vector<float>>& query_vectors,
+    int top_k,
+    const FusionOptions& fusion
+) {
+    if (attachedBundle() || !hasFieldVectors()) {
+        return batchSearch(query_vectors, top_k, false);
+    }
+
+    std::vector<std::vector<SearchResult>> results(query_vectors.size());
+    if (query_vectors.empty() || top_k <= 0) return results;
+
+    Span span("BookVectorStore.fusedBatchSearch");
+    span.setAttribute("queries", query_vectors.size());
+    span.setAttribute("top_k", top_k);
+
+    // Fusion rescoring is per query anyway, so there is no shared FAISS call
+    // to batch; the queries just run side by side
+    ScopedTimer timer(vectorStoreMetrics().batch_search_latency);
+    TaskExecutor::getInstance().parallelFor(0, query_vectors.size(), [&](size_t q) {
+        auto fused = fusedSearch(query_vectors[q], top_k, fusion, std::pmr::get_default_resource());
+        results[q].assign(std::make_move_iterator(fused.begin()), std::make_move_iterator(fused.end()));
+    }, TaskPriority::Background);
+    return results;
+}
+
+std::vector<std::vector<BookVectorStore::SearchResult>> BookVectorStore::batchSearchExcluding(
+    const std::vector<std::vector<float>>& query_vectors,
+    const std::unordered_set<std::string>& exclude,
+    int top_k,
+    bool use_approximate
+) {
+    std::vector<std::vector<SearchResult>> results(query_vectors.size());
+    if (query_vectors.empty() || top_k <= 0) return results;
+
+    auto n_queries = static_cast<faiss::idx_t>(query_vectors.size());
+    std::vector<float> queries;
+    queries.reserve(query_vectors.size() * dimension_);
+    for (const auto& query_vector : query_vectors) {
+        if (query_vector.size() != static_cast<size_t>(dimension_)) {
+            throw std::invalid_argument("Query vector dimension mismatch");
+        }
+        queries.insert(queries.end(), query_vector.begin(), query_vector.end());
+    }
+
+    Span span("BookVectorStore.batchSearchExcluding");
+    span.setAttribute("queries", query_vectors.size());
+    span.setAttribute("excluded", exclude.size());
+    span.setAttribute("top_k", top_k);
+
+    ScopedTimer timer(vectorStoreMetrics().batch_search_latency);
+
+    if (auto bundle = attachedBundle()) {
+        // Bundles search without selectors: over-fetch by the exclusion
+        // count and drop the excluded rows afterwards
+        size_t k = std::min(bundle->size(), static_cast<size_t>(top_k) + exclude.size());
+        if (k == 0) return results;
+        std::vector<float> scores(query_vectors.size() * k);
+        std::vector<int64_t> rows(query_vectors.size() * k);
+        bundle->search(queries.data(), query_vectors.size(), static_cast<int>(k), scores.data(), rows.data());
+        for (size_t q = 0; q < query_vectors.size(); ++q) {
+            auto batch = processBundleResults(
+                *bundle, scores.data() + q * k, rows.data() + q * k, k, std::pmr::get_default_resource()
+            );
+            for (auto& result : batch) {
+                if (results[q].size() == static_cast<size_t>(top_k)) break;
+                if (!exclude.count(result.doc_id)) {
+                    results[q].push_back(std::move(result));
+                }
+            }
+        }
+        span.setAttribute("index", "bundle");
+        return results;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(index_mutex_);
+
+    faiss::idx_t n = flat_index_->ntotal;
+    if (n == 0) return results;
+
+    std::vector<uint8_t> bitmap((static_cast<size_t>(n) + 7) / 8, 0);
+    for (const auto& doc_id : exclude) {
+        auto it = doc_id_to_index_.find(doc_id);
+        if (it != doc_id_to_index_.end()) {
+            bitmap[it->second >> 3] |= static_cast<uint8_t>(1u << (it->second & 7));
+        }
+    }
+    faiss::IDSelectorBitmap excluded(static_cast<size_t>(n), bitmap.data());
+    faiss::IDSelectorNot allowed(&excluded);
+
+    // IVF indexes only accept their own parameter type
+    bool approximate = use_approximate && is_trained_;
+    faiss::SearchParametersIVF ivf_params;
+    ivf_params.nprobe = ivf_index_->nprobe;
+    faiss::SearchParameters flat_params;
+    faiss::SearchParameters& params = approximate ? ivf_params : flat_params;
+    params.sel = &allowed;
+    faiss::Index* index = approximate
+        ? static_cast<faiss::Index*>(ivf_index_.get())
+        : static_cast<faiss::Index*>(flat_index_.get());
+
+    // Rows the selector rejects come back as -1 and are skipped below
+    faiss::idx_t k = std::min<faiss::idx_t>(top_k, n);
+    std::vector<float> distances(static_cast<size_t>(n_queries * k));
+    std::vector<faiss::idx_t> labels(static_cast<size_t>(n_queries * k));
+    index->search(n_queries, queries.data(), k, distances.data(), labels.data(), &params);
+
+    for (size_t q = 0; q < query_vectors.size(); ++q) {
+        auto batch = processSearchResults(
+            distances.data() + q * k, labels.data() + q * k,
+            static_cast<size_t>(k), std::pmr::get_default_resource()
+        );
+        results[q].assign(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    }
+
+    span.setAttribute("index", approximate ? "ivf" : "flat");
+    return results;
+}
+
+SimilarityGraph BookVectorStore::buildSimilarityGraph(
+    int k,
+    size_t block_size,
+    bool use_approximate
+) const {
+    std::shared_lock<std::shared_mutex> lock(index_mutex_);
+
+    faiss::idx_t n = flat_index_->ntotal;
+    SimilarityGraph graph(index_to_doc_id_, k);
+    if (n < 2) return graph;
+
+    std::vector<float> vectors(static_cast<size_t>(n) * dimension_);
+    flat_index_->reconstruct_n(0, n, vectors.data());
+
+    faiss::Index* index = (use_approximate && is_trained_)
+        ? static_cast<faiss::Index*>(ivf_index_.get())
+        : static_cast<faiss::Index*>(flat_index_.get());
+
+    // One extra neighbour per query since every book finds itself
+    faiss::idx_t kk = std::min<faiss::idx_t>(k + 1, n);
+    auto block = static_cast<faiss::idx_t>(std::max<size_t>(block_size, 1));
+    std::vector<float> distances(static_cast<size_t>(block * kk));
+    std::vector<faiss::idx_t> labels(static_cast<size_t>(block * kk));
+
+    for (faiss::idx_t start = 0; start < n; start += block) {
+        faiss::idx_t count = std::min(block, n - start);
+        index->search(count, vectors.data() + start * dimension_, kk, distances.data(), labels.data());
+
+        TaskExecutor::getInstance().parallelFor(0, static_cast<size_t>(count), [&](size_t i) {
+            graph.setNeighbors(
+                static_cast<uint32_t>(start + i),
+                labels.data() + i * kk,
+                distances.data() + i * kk,
+                static_cast<size_t>(kk)
+            );
+        }, TaskPriority::Background, 64);
+    }
+
+    spdlog::info("Built similarity graph: {} books, k={}", n, k);
+    return graph;
+}
+
+std::shared_ptr<const Document> BookVectorStore::getDocument(const std::string& doc_id) const {
+    if (auto bundle = attachedBundle()) {
+        auto row = bundle->rowOf(doc_id);
+        return row ? bundle->document(*row) : nullptr;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(index_mutex_);
+    auto it = document_store_.find(doc_id);
+    return it == document_store_.end() ? nullptr : it->second;
+}
+
+bool BookVectorStore::hasFieldVectors() const {
+    std::shared_lock<std::shared_mutex> lock(index_mutex_);
+    return !field_indexes_.empty();
+}
+
+size_t BookVectorStore::size() const {
+    if (auto bundle = attachedBundle()) {
+        return bundle->size();
+    }
+
+    std::shared_lock<std::shared_mutex> lock(index_mutex_);
+    return index_to_doc_id_.size();
+}
+
+bool BookVectorStore::getVector(const std::string& doc_id, float* out) const {
+    if (auto bundle = attachedBundle()) {
+        auto row = bundle->rowOf(doc_id);
+        if (!row) return false;
+        std::copy_n(bundle->vector(*row), dimension_, out);
+        return true;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(index_mutex_);
+    auto it = doc_id_to_index_.find(doc_id);
+    if (it == doc_id_to_index_.end()) {
+        return false;
+    }
+    flat_index_->reconstruct(static_cast<faiss::idx_t>(it->second), out);
+    return true;
+}
+
+void BookVectorStore::attachBundle(std::shared_ptr<const IndexBundle> bundle) {
+    if (bundle && bundle->dimension() != dimension_) {
+        throw std::invalid_argument(
+            "Index bundle dimension " + std::to_string(bundle->dimension()) +
+            " does not match store dimension " + std::to_string(dimension_));
+    }
+    std::atomic_store(&bundle_, std::move(bundle));
+    clearCache();
+}
+
+std::vector<BookVectorStore::SearchResult> BookVectorStore::searchSimilar(
+    const std::string& doc_id,
+    int top_k
+) {
+    auto results = searchSimilar(doc_id, top_k, std::pmr::get_default_resource());
+    return std::vector<SearchResult>(
+        std::make_move_iterator(results.begin()),
+        std::make_move_iterator(results.end())
+    );
+}
+
+std::pmr::vector<BookVectorStore::SearchResult> BookVectorStore::searchSimilar(
+    const std::string& doc_id,
+    int top_k,
+    std::pmr::memory_resource* resource
+) {
+    std::vector<float> query_vector;
+    if (auto bundle = attachedBundle()) {
+        auto row = bundle->rowOf(doc_id);
+        if (!row) {
+            throw std::invalid_argument("Unknown document: " + doc_id);
+        }
+        query_vector.assign(bundle->vector(*row), bundle->vector(*row) + dimension_);
+    } else {
+        std::shared_lock<std::shared_mutex> lock(index_mutex_);
+        auto it = document_store_.find(doc_id);
+        if (it == document_store_.end()) {
+            throw std::invalid_argument("Unknown document: " + doc_id);
+        }
+        query_vector = getDocumentVector(*it->second);
+    }
+
+    // One extra result since the document always matches itself
+    auto results = search(query_vector, top_k + 1, false, resource);
+    results.erase(
+        std::remove_if(results.begin(), results.end(),
+                       [&](const SearchResult& r) { return r.doc_id == doc_id; }),
+        results.end()
+    );
+    if (results.size() > static_cast<size_t>(top_k)) {
+        results.resize(top_k);
+    }
+    return results;
 }
 
 void BookVectorStore::saveIndex(const std::string& path) {
+    std::shared_lock<std::shared_mutex> lock(index_mutex_);
     try {
         // Save FAISS indices
         faiss::write_index(flat_index_.get(), (path + ".flat").c_str());
@@ -41,8 +763,9 @@ void BookVectorStore::saveIndex(const std::string& path) {
         size_t doc_count = document_store_.size();
         mapping_file.write(reinterpret_cast<const char*>(&doc_count), sizeof(size_t));
 
-        for (const auto& [id, doc] : document_store_) {
-            nlohmann::json j = doc.toJson();
+        // Written in index order so positions line up with the FAISS index on load
+        for (const auto& id : index_to_doc_id_) {
+            nlohmann::json j = document_store_.at(id)->toJson();
             std::string json_str = j.dump();
             size_t str_len = json_str.length();
             mapping_file.write(reinterpret_cast<const char*>(&str_len), sizeof(size_t));
@@ -57,21 +780,24 @@ void BookVectorStore::saveIndex(const std::string& path) {
 }
 
 void BookVectorStore::loadIndex(const std::string& path) {
+    std::unique_lock<std::shared_mutex> lock(index_mutex_);
     try {
         // Load FAISS indices
-        flat_index_.reset(faiss::read_index((path + ".flat").c_str()));
-        ivf_index_.reset(dynamic_cast<faiss::IndexIVFFlat*>(
-            faiss::read_index((path + ".ivf").c_str())
-        ));
+        flat_index_ = readIndexAs<faiss::IndexFlatIP>(path + ".flat");
+        ivf_index_ = readIndexAs<faiss::IndexIVFFlat>(path + ".ivf");
 
         // Load document mappings
         std::ifstream mapping_file(path + ".mapping", std::ios::binary);
+        if (!mapping_file) {
+            throw std::runtime_error("Cannot open " + path + ".mapping");
+        }
         size_t doc_count;
         mapping_file.read(reinterpret_cast<char*>(&doc_count), sizeof(size_t));
 
         document_store_.clear();
         doc_id_to_index_.clear();
         index_to_doc_id_.clear();
+        field_indexes_.clear();
 
         for (size_t i = 0; i < doc_count; ++i) {
             size_t str_len;
@@ -82,12 +808,18 @@ void BookVectorStore::loadIndex(const std::string& path) {
             
             auto j = nlohmann::json::parse(json_str);
             Document doc = Document::fromJson(j);
+            std::string doc_id = doc.getId();
             
-            updateDocumentMapping(doc.getId(), i);
-            document_store_[doc.getId()] = doc;
+            // Field vectors are small next to the main index, so they are
+            // re-indexed from the documents rather than stored separately
+            validateDocument(doc);
+            updateDocumentMapping(doc_id, i);
+            addFieldVectorsLocked(doc);
+            document_store_.insert_or_assign(doc_id, std::make_shared<const Document>(std::move(doc)));
         }
 
-        is_trained_ = true;
+        is_trained_ = ivf_index_ && ivf_index_->is_trained && ivf_index_->ntotal == flat_index_->ntotal;
+        vectorStoreMetrics().index_size.set(flat_index_->ntotal);
         spdlog::info("Loaded index from {}", path);
     } catch (const std::exception& e) {
         spdlog::error("Failed to load index: {}", e.what());
@@ -95,6 +827,28 @@ void BookVectorStore::loadIndex(const std::string& path) {
     }
 }
 
+// Everything addDocuments would reject, checked before any mutation
+void BookVectorStore::validateDocument(const Document& doc) const {
+    const auto& embedding = doc.getEmbedding();
+    if (!embedding) {
+        throw std::invalid_argument("Document " + doc.getId() + " does not have an embedding");
+    }
+    if (embedding->size() != static_cast<size_t>(dimension_)) {
+        throw std::invalid_argument("Embedding dimension mismatch for document " + doc.getId());
+    }
+    for (const auto& [field, vectors] : doc.getFieldEmbeddings()) {
+        if (field == "combined" && !vectors.empty()) {
+            throw std::invalid_argument("\"combined\" is reserved for the main embedding");
+        }
+        for (const auto& vector : vectors) {
+            if (vector.size() != static_cast<size_t>(dimension_)) {
+                throw std::invalid_argument("Embedding dimension mismatch for field " + field +
+                                            " of document " + doc.getId());
+            }
+        }
+    }
+}
+
 std::vector<float> BookVectorStore::getDocumentVector(const Document& doc) const {
     if (!doc.getEmbedding()) {
         throw std::runtime_error("Document does not have an embedding");
@@ -102,6 +856,42 @@ std::vector<float> BookVectorStore::getDocumentVector(const Document& doc) const
     return *doc.getEmbedding();
 }
 
+// Caller must hold index_mutex_ exclusively and have validated `doc`
+void BookVectorStore::addFieldVectorsLocked(const Document& doc) {
+    for (const auto& [field, vectors] : doc.getFieldEmbeddings()) {
+        if (vectors.empty()) continue;
+        auto& entry = field_indexes_[field];
+        if (!entry.index) {
+            entry.index = std::make_unique<faiss::IndexFlatIP>(dimension_);
+        }
+        auto& rows = entry.rows[doc.getId()];
+        for (const auto& vector : vectors) {
+            entry.index->add(1, vector.data());
+            rows.push_back(entry.owners.size());
+            entry.owners.push_back(doc.getId());
+        }
+    }
+}
+
+// Best inner product between the query and the document's vectors for
+// `field`; NaN when the document has none
+float BookVectorStore::fieldSimilarity(const Document& doc, const std::string& field, const float* query) const {
+    if (field == "combined") {
+        const auto& embedding = doc.getEmbedding();
+        return embedding ? kernels_.dot(query, embedding->data()) : NAN;
+    }
+
+    const auto& fields = doc.getFieldEmbeddings();
+    auto it = fields.find(field);
+    if (it == fields.end()) return NAN;
+
+    float best = -INFINITY;
+    for (const auto& vector : it->second) {
+        best = std::max(best, kernels_.dot(query, vector.data()));
+    }
+    return best;
+}
+
 void BookVectorStore::updateDocumentMapping(const std::string& doc_id, size_t index) {
     doc_id_to_index_[doc_id] = index;
     if (index >= index_to_doc_id_.size()) {
@@ -110,16 +900,17 @@ void BookVectorStore::updateDocumentMapping(const std::string& doc_id, size_t in
     index_to_doc_id_[index] = doc_id;
 }
 
-std::vector<BookVectorStore::SearchResult> BookVectorStore::processSearchResults(
+std::pmr::vector<BookVectorStore::SearchResult> BookVectorStore::processSearchResults(
     const float* distances,
     const faiss::idx_t* indices,
-    size_t n_results
+    size_t n_results,
+    std::pmr::memory_resource* resource
 ) const {
-    std::vector<SearchResult> results;
+    std::pmr::vector<SearchResult> results(resource);
     results.reserve(n_results);
 
     for (size_t i = 0; i < n_results; ++i) {
-        if (indices[i] < 0 || indices[i] >= index_to_doc_id_.size()) {
+        if (indices[i] < 0 || static_cast<size_t>(indices[i]) >= index_to_doc_id_.size()) {
             continue;
         }
 
@@ -139,6 +930,31 @@ std::vector<BookVectorStore::SearchResult> BookVectorStore::processSearchResults
     return results;
 }
 
+std::pmr::vector<BookVectorStore::SearchResult> BookVectorStore::processBundleResults(
+    const IndexBundle& bundle,
+    const float* scores,
+    const int64_t* rows,
+    size_t n_results,
+    std::pmr::memory_resource* resource
+) {
+    std::pmr::vector<SearchResult> results(resource);
+    results.reserve(n_results);
+
+    for (size_t i = 0; i < n_results; ++i) {
+        if (rows[i] < 0 || static_cast<size_t>(rows[i]) >= bundle.size()) {
+            continue;
+        }
+        auto row = static_cast<uint32_t>(rows[i]);
+        results.push_back({
+            std::string(bundle.id(row)),
+            scores[i],
+            bundle.document(row)
+        });
+    }
+
+    return results;
+}
+
 std::string BookVectorStore::generateCacheKey(
     const std::vector<float>& query_vector,
     int top_k
@@ -152,13 +968,19 @@ std::string BookVectorStore::generateCacheKey(
     return ss.str();
 }
 
+// `generation` is the one getFromCache reported before the search ran. If
+// the cache was cleared since, the results may predate the change that
+// cleared it and are dropped.
 void BookVectorStore::addToCache(
     const std::string& key,
-    const std::vector<SearchResult>& results
+    const std::pmr::vector<SearchResult>& results,
+    uint64_t generation
 ) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    if (generation != cache_generation_) return;
     cleanupCache();
     
-    if (search_cache_.size() >= cache_size_) {
+    if (!search_cache_.empty() && search_cache_.size() >= static_cast<size_t>(cache_size_)) {
         // Remove oldest entry
         auto oldest = std::min_element(
             search_cache_.begin(),
@@ -170,22 +992,37 @@ void BookVectorStore::addToCache(
         search_cache_.erase(oldest);
     }
 
+    // Cached entries outlive the request, so copy out of the caller's arena.
+    // Only ids and document handles are copied, never the documents.
     search_cache_[key] = {
-        results,
+        std::make_shared<const std::vector<SearchResult>>(results.begin(), results.end()),
         std::chrono::system_clock::now()
     };
 }
 
-std::optional<std::vector<BookVectorStore::SearchResult>> BookVectorStore::getFromCache(
-    const std::string& key
+bool BookVectorStore::getFromCache(
+    const std::string& key,
+    std::pmr::vector<SearchResult>& results,
+    uint64_t& generation
 ) const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    generation = cache_generation_;
     auto it = search_cache_.find(key);
     if (it != search_cache_.end()) {
-        return it->second.results;
+        cache_hits_.fetch_add(1, std::memory_order_relaxed);
+        ++thread_cache_stats.hits;
+        vectorStoreMetrics().cache_hits.increment();
+        const auto& cached = *it->second.results;
+        results.assign(cached.begin(), cached.end());
+        return true;
     }
-    return std::nullopt;
+    cache_misses_.fetch_add(1, std::memory_order_relaxed);
+    ++thread_cache_stats.misses;
+    vectorStoreMetrics().cache_misses.increment();
+    return false;
 }
 
+// Caller must hold cache_mutex_
 void BookVectorStore::cleanupCache() {
     auto now = std::chrono::system_clock::now();
     auto it = search_cache_.begin();
@@ -204,12 +1041,26 @@ void BookVectorStore::cleanupCache() {
 }
 
 void BookVectorStore::clearCache() {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
     search_cache_.clear();
+    ++cache_generation_;
 }
 
 void BookVectorStore::setCacheSize(int size) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
     cache_size_ = size;
     cleanupCache();
 }
 
+BookVectorStore::CacheStats BookVectorStore::getCacheStats() const {
+    return {
+        cache_hits_.load(std::memory_order_relaxed),
+        cache_misses_.load(std::memory_order_relaxed)
+    };
+}
+
+BookVectorStore::CacheStats BookVectorStore::getThreadCacheStats() {
+    return thread_cache_stats;
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,552 @@
+#include "book_recommender/IndexBundle.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <faiss/utils/distances.h>
+#include <spdlog/spdlog.h>
+#include "../utils/MappedFile.hpp"
+
+namespace book_recommender {
+
+namespace fs = std::filesystem;
+
+struct IndexBundle::Text {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct IndexBundle::Row {
+    Text id;
+    Text title;
+    Text author;
+    Text description;
+    Text series;  // offset NO_TEXT when the book has no series
+    Text language;
+    Text publisher;
+    Text publication_date;
+    Text isbn13;
+    uint32_t genre_offset;
+    uint32_t genre_count;
+    double average_rating;
+    int32_t ratings_count;
+    int32_t review_count;
+    int32_t page_count;
+    uint32_t is_ebook;
+};
+
+namespace {
+
+constexpr char BUNDLE_MAGIC[4] = {'B', 'R', 'I', 'B'};
+constexpr uint32_t BUNDLE_VERSION = 1;
+constexpr uint64_t SECTION_ALIGNMENT = 64;
+constexpr uint32_t NO_TEXT = UINT32_MAX;
+constexpr const char* CURRENT_FILE = "CURRENT";
+constexpr const char* BUNDLE_PREFIX = "bundle-";
+constexpr const char* BUNDLE_SUFFIX = ".bin";
+
+struct Section {
+    uint64_t offset;
+    uint64_t bytes;
+};
+
+struct BundleHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t generation;
+    uint64_t row_count;
+    uint32_t dimension;
+    uint32_t reserved;
+    Section vectors;
+    Section rows;
+    Section genres;
+    Section id_order;
+    Section text;
+};
+
+uint64_t alignUp(uint64_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+void padTo(std::ofstream& file, uint64_t offset) {
+    static const char zeros[SECTION_ALIGNMENT] = {};
+    auto position = static_cast<uint64_t>(file.tellp());
+    file.write(zeros, static_cast<std::streamsize>(offset - position));
+}
+
+template <typename T>
+Section writeSection(std::ofstream& file, const T* data, size_t count) {
+    Section section{alignUp(static_cast<uint64_t>(file.tellp())), count * sizeof(T)};
+    padTo(file, section.offset);
+    file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(section.bytes));
+    return section;
+}
+
+// Builds the string heap; short repeated strings (authors, genres,
+// languages, publishers) are stored once and shared by offset
+template <typename TextRef>
+class TextHeapWriter {
+public:
+    TextRef append(std::string_view value) {
+        if (heap_.size() + value.size() > UINT32_MAX) {
+            throw std::runtime_error("Index bundle text heap exceeds 4 GiB");
+        }
+        TextRef ref{static_cast<uint32_t>(heap_.size()), static_cast<uint32_t>(value.size())};
+        heap_.append(value);
+        return ref;
+    }
+
+    TextRef intern(std::string_view value) {
+        auto it = interned_.find(std::string(value));
+        if (it != interned_.end()) return it->second;
+        auto ref = append(value);
+        interned_.emplace(std::string(value), ref);
+        return ref;
+    }
+
+    const std::string& heap() const { return heap_; }
+
+private:
+    std::string heap_;
+    std::unordered_map<std::string, TextRef> interned_;
+};
+
+uint64_t generationOf(const std::string& file_name) {
+    std::string_view name(file_name);
+    std::string_view prefix(BUNDLE_PREFIX);
+    std::string_view suffix(BUNDLE_SUFFIX);
+    if (name.size() <= prefix.size() + suffix.size() ||
+        name.substr(0, prefix.size()) != prefix ||
+        name.substr(name.size() - suffix.size()) != suffix) {
+        return 0;
+    }
+    auto digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+    if (!std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        return 0;
+    }
+    return std::stoull(std::string(digits));
+}
+
+std::string bundleFileName(uint64_t generation) {
+    return BUNDLE_PREFIX + std::to_string(generation) + BUNDLE_SUFFIX;
+}
+
+// Keeps the top `count` entries of `counts` by value, highest first
+std::vector<std::pair<uint32_t, int>> topCounts(const std::unordered_map<uint32_t, int>& counts, int count) {
+    std::vector<std::pair<uint32_t, int>> pairs(counts.begin(), counts.end());
+    auto keep = std::min(static_cast<size_t>(std::max(count, 0)), pairs.size());
+    std::partial_sort(pairs.begin(), pairs.begin() + keep, pairs.end(),
+                      [](const auto& a, const auto& b) { return a.second > b.second; });
+    pairs.resize(keep);
+    return pairs;
+}
+
+}
+
+void IndexBundle::write(
+    const std::string& path,
+    const BookCatalog& catalog,
+    int dimension,
+    const VectorSource& vectors,
+    uint64_t generation
+) {
+    if (dimension <= 0) {
+        throw std::invalid_argument("Index bundle needs a positive dimension");
+    }
+
+    std::vector<float> matrix;
+    std::vector<Row> rows;
+    std::vector<Text> genres;
+    TextHeapWriter<Text> heap;
+    std::vector<float> buffer(dimension);
+
+    for (auto view : catalog) {
+        std::string id(view.getId());
+        if (!vectors(id, buffer.data())) {
+            continue;
+        }
+        matrix.insert(matrix.end(), buffer.begin(), buffer.end());
+
+        Row row{};
+        row.id = heap.append(id);
+        row.title = heap.append(view.getTitle());
+        row.author = heap.intern(view.getAuthor());
+        row.description = heap.append(view.getDescription());
+        auto series = view.getSeries();
+        row.series = series ? heap.append(*series) : Text{NO_TEXT, 0};
+        row.language = heap.intern(view.getLanguage());
+        row.publisher = heap.intern(view.getPublisher());
+        row.publication_date = heap.append(view.getPublicationDate());
+        row.isbn13 = heap.append(view.getIsbn13());
+        row.genre_offset = static_cast<uint32_t>(genres.size());
+        for (auto genre : view.getGenres()) {
+            genres.push_back(heap.intern(genre));
+        }
+        row.genre_count = static_cast<uint32_t>(genres.size() - row.genre_offset);
+        row.average_rating = view.getAverageRating();
+        row.ratings_count = view.getRatingsCount();
+        row.review_count = view.getReviewCount();
+        row.page_count = view.getPageCount();
+        row.is_ebook = view.isEbook() ? 1 : 0;
+        rows.push_back(row);
+    }
+
+    const auto& text = heap.heap();
+    std::vector<uint32_t> id_order(rows.size());
+    for (uint32_t i = 0; i < id_order.size(); ++i) {
+        id_order[i] = i;
+    }
+    std::sort(id_order.begin(), id_order.end(), [&](uint32_t a, uint32_t b) {
+        return std::string_view(text).substr(rows[a].id.offset, rows[a].id.length) <
+               std::string_view(text).substr(rows[b].id.offset, rows[b].id.length);
+    });
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot write index bundle: " + path);
+    }
+
+    BundleHeader header{};
+    std::memcpy(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+    header.version = BUNDLE_VERSION;
+    header.generation = generation;
+    header.row_count = rows.size();
+    header.dimension = static_cast<uint32_t>(dimension);
+
+    // Sections go after the header; it is rewritten once their offsets are known
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    header.vectors = writeSection(file, matrix.data(), matrix.size());
+    header.rows = writeSection(file, rows.data(), rows.size());
+    header.genres = writeSection(file, genres.data(), genres.size());
+    header.id_order = writeSection(file, id_order.data(), id_order.size());
+    header.text = writeSection(file, text.data(), text.size());
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Failed writing index bundle: " + path);
+    }
+    syncFile(path);
+}
+
+std::shared_ptr<const IndexBundle> IndexBundle::open(const std::string& path) {
+    auto file = std::make_shared<const MappedFile>(path);
+    const char* data = file->data();
+
+    BundleHeader header{};
+    if (file->size() < sizeof(header)) {
+        throw std::runtime_error("Not an index bundle: " + path);
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) != 0) {
+        throw std::runtime_error("Not an index bundle: " + path);
+    }
+    if (header.version != BUNDLE_VERSION) {
+        throw std::runtime_error("Unsupported index bundle version " + std::to_string(header.version));
+    }
+
+    // Every size below comes from the file, so sums and products are checked
+    // for overflow before they are compared against the mapping
+    auto fits = [&](const Section& section, std::optional<uint64_t> expected_bytes) {
+        return section.offset % SECTION_ALIGNMENT == 0 &&
+               file->contains(section.offset, section.bytes) &&
+               expected_bytes && (*expected_bytes == UINT64_MAX || section.bytes == *expected_bytes);
+    };
+    auto vector_count = arrayBytes(header.row_count, header.dimension);
+    if (header.dimension == 0 || !vector_count ||
+        !fits(header.vectors, arrayBytes(*vector_count, sizeof(float))) ||
+        !fits(header.rows, arrayBytes(header.row_count, sizeof(Row))) ||
+        !fits(header.genres, UINT64_MAX) || header.genres.bytes % sizeof(Text) != 0 ||
+        !fits(header.id_order, arrayBytes(header.row_count, sizeof(uint32_t))) ||
+        !fits(header.text, UINT64_MAX)) {
+        throw std::runtime_error("Corrupt index bundle: " + path);
+    }
+
+    // Lookups index straight into these arrays, so every stored row number
+    // and genre range must stay inside the sections
+    auto rows = reinterpret_cast<const Row*>(data + header.rows.offset);
+    auto id_order = reinterpret_cast<const uint32_t*>(data + header.id_order.offset);
+    uint64_t genre_count = header.genres.bytes / sizeof(Text);
+    for (uint64_t i = 0; i < header.row_count; ++i) {
+        if (id_order[i] >= header.row_count ||
+            uint64_t(rows[i].genre_offset) + rows[i].genre_count > genre_count) {
+            throw std::runtime_error("Corrupt index bundle: " + path);
+        }
+    }
+
+    std::shared_ptr<IndexBundle> bundle(new IndexBundle());
+    bundle->base_ = data;
+    bundle->mapped_bytes_ = file->size();
+    bundle->generation_ = header.generation;
+    bundle->row_count_ = header.row_count;
+    bundle->dimension_ = static_cast<int>(header.dimension);
+    bundle->vectors_ = reinterpret_cast<const float*>(data + header.vectors.offset);
+    bundle->rows_ = rows;
+    bundle->genres_ = reinterpret_cast<const Text*>(data + header.genres.offset);
+    bundle->genre_count_ = genre_count;
+    bundle->id_order_ = id_order;
+    bundle->text_ = data + header.text.offset;
+    bundle->text_bytes_ = header.text.bytes;
+    bundle->documents_ = std::make_unique<std::shared_ptr<const Document>[]>(header.row_count);
+    bundle->mapping_ = std::move(file);
+    return bundle;
+}
+
+size_t IndexBundle::mappedBytes() const {
+    return mapped_bytes_;
+}
+
+std::string_view IndexBundle::text(const Text& ref) const {
+    if (size_t(ref.offset) + ref.length > text_bytes_) {
+        throw std::runtime_error("Corrupt index bundle: text reference out of range");
+    }
+    return std::string_view(text_ + ref.offset, ref.length);
+}
+
+std::optional<uint32_t> IndexBundle::rowOf(std::string_view id) const {
+    auto it = std::lower_bound(id_order_, id_order_ + row_count_, id,
+                               [this](uint32_t row, std::string_view key) { return this->id(row) < key; });
+    if (it == id_order_ + row_count_ || this->id(*it) != id) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+std::string_view IndexBundle::id(uint32_t row) const {
+    return text(rows_[row].id);
+}
+
+double IndexBundle::averageRating(uint32_t row) const {
+    return rows_[row].average_rating;
+}
+
+int IndexBundle::ratingsCount(uint32_t row) const {
+    return rows_[row].ratings_count;
+}
+
+Book IndexBundle::book(uint32_t row) const {
+    const Row& r = rows_[row];
+    std::vector<std::string> genres;
+    genres.reserve(r.genre_count);
+    for (uint32_t i = 0; i < r.genre_count && r.genre_offset + i < genre_count_; ++i) {
+        genres.emplace_back(text(genres_[r.genre_offset + i]));
+    }
+    std::optional<std::string> series;
+    if (r.series.offset != NO_TEXT) {
+        series = std::string(text(r.series));
+    }
+    return Book(
+        std::string(text(r.id)),
+        std::string(text(r.title)),
+        std::string(text(r.author)),
+        std::move(genres),
+        std::string(text(r.description)),
+        r.page_count,
+        r.average_rating,
+        r.ratings_count,
+        r.review_count,
+        std::move(series),
+        std::string(text(r.language)),
+        std::string(text(r.publisher)),
+        std::string(text(r.publication_date)),
+        std::string(text(r.isbn13)),
+        r.is_ebook != 0
+    );
+}
+
+std::shared_ptr<const Document> IndexBundle::document(uint32_t row) const {
+    auto& slot = documents_[row];
+    auto document = std::atomic_load(&slot);
+    if (document) {
+        return document;
+    }
+    // Racing builders agree on whichever instance lands first
+    std::shared_ptr<const Document> built = std::make_shared<const Document>(materialize(row));
+    if (std::atomic_compare_exchange_strong(&slot, &document, built)) {
+        return built;
+    }
+    return document;
+}
+
+// Same metadata layout as the documents the vector store indexes, so
+// downstream code cannot tell a bundle-backed result from a live one
+Document IndexBundle::materialize(uint32_t row) const {
+    Book b = book(row);
+    Document::Metadata metadata{
+        {"title", b.getTitle()},
+        {"author", b.getAuthor()},
+        {"genres", b.getGenres()},
+        {"page_count", b.getPageCount()},
+        {"average_rating", b.getAverageRating()},
+        {"ratings_count", b.getRatingsCount()},
+        {"review_count", b.getReviewCount()},
+        {"language", b.getLanguage()},
+        {"publisher", b.getPublisher()},
+        {"publication_date", b.getPublicationDate()},
+        {"isbn13", b.getIsbn13()},
+        {"is_ebook", b.isEbook()}
+    };
+    if (b.getSeries()) {
+        metadata["series"] = *b.getSeries();
+    }
+    return Document(b.getId(), b.getDescription(), std::move(metadata));
+}
+
+void IndexBundle::search(const float* queries, size_t n_queries, int top_k, float* scores, int64_t* rows) const {
+    auto slots = static_cast<size_t>(std::max(top_k, 0));
+    std::fill(scores, scores + n_queries * slots, 0.0f);
+    std::fill(rows, rows + n_queries * slots, int64_t(-1));
+
+    size_t k = std::min(slots, row_count_);
+    if (k == 0 || n_queries == 0) return;
+    if (k == slots) {
+        faiss::knn_inner_product(queries, vectors_, dimension_, n_queries, row_count_, k, scores, rows);
+        return;
+    }
+
+    // Fewer rows than requested: search densely, then spread into the
+    // caller's top_k-wide layout
+    std::vector<float> dense_scores(n_queries * k);
+    std::vector<int64_t> dense_rows(n_queries * k);
+    faiss::knn_inner_product(queries, vectors_, dimension_, n_queries, row_count_, k,
+                             dense_scores.data(), dense_rows.data());
+    for (size_t q = 0; q < n_queries; ++q) {
+        std::copy_n(dense_scores.data() + q * k, k, scores + q * slots);
+        std::copy_n(dense_rows.data() + q * k, k, rows + q * slots);
+    }
+}
+
+std::vector<std::string> IndexBundle::popularGenres(int top_k) const {
+    // Genre strings are interned, so their heap offset identifies them
+    std::unordered_map<uint32_t, int> counts;
+    std::unordered_map<uint32_t, uint32_t> lengths;
+    for (size_t i = 0; i < genre_count_; ++i) {
+        counts[genres_[i].offset]++;
+        lengths.emplace(genres_[i].offset, genres_[i].length);
+    }
+
+    std::vector<std::string> popular;
+    for (const auto& [offset, count] : topCounts(counts, top_k)) {
+        popular.emplace_back(text(Text{offset, lengths[offset]}));
+    }
+    return popular;
+}
+
+std::vector<std::string> IndexBundle::popularAuthors(int top_k) const {
+    std::unordered_map<uint32_t, int> counts;
+    std::unordered_map<uint32_t, uint32_t> lengths;
+    for (size_t row = 0; row < row_count_; ++row) {
+        counts[rows_[row].author.offset]++;
+        lengths.emplace(rows_[row].author.offset, rows_[row].author.length);
+    }
+
+    std::vector<std::string> popular;
+    for (const auto& [offset, count] : topCounts(counts, top_k)) {
+        popular.emplace_back(text(Text{offset, lengths[offset]}));
+    }
+    return popular;
+}
+
+std::vector<uint32_t> IndexBundle::topRatedRows(int limit) const {
+    std::vector<uint32_t> order(row_count_);
+    for (uint32_t row = 0; row < order.size(); ++row) {
+        order[row] = row;
+    }
+
+    size_t count = std::min(static_cast<size_t>(std::max(limit, 0)), order.size());
+    std::partial_sort(order.begin(), order.begin() + count, order.end(), [this](uint32_t a, uint32_t b) {
+        if (rows_[a].average_rating == rows_[b].average_rating) {
+            return rows_[a].ratings_count > rows_[b].ratings_count;
+        }
+        return rows_[a].average_rating > rows_[b].average_rating;
+    });
+    order.resize(count);
+    return order;
+}
+
+BundleDirectory::BundleDirectory(std::string path) : path_(std::move(path)) {}
+
+uint64_t BundleDirectory::publish(
+    const BookCatalog& catalog,
+    int dimension,
+    const IndexBundle::VectorSource& vectors,
+    size_t keep
+) {
+    fs::create_directories(path_);
+
+    uint64_t generation = 0;
+    for (const auto& entry : fs::directory_iterator(path_)) {
+        generation = std::max(generation, generationOf(entry.path().filename().string()));
+    }
+    ++generation;
+
+    // Write (and sync) under a temporary name and rename into place, so no
+    // reader can ever map a half-written bundle, even after a crash
+    auto name = bundleFileName(generation);
+    auto bundle_path = fs::path(path_) / name;
+    auto staging_path = fs::path(path_) / (name + ".tmp");
+    IndexBundle::write(staging_path.string(), catalog, dimension, vectors, generation);
+    fs::rename(staging_path, bundle_path);
+
+    auto current_staging = fs::path(path_) / (std::string(CURRENT_FILE) + ".tmp");
+    {
+        std::ofstream current(current_staging, std::ios::trunc);
+        current << name << "\n";
+        if (!current) {
+            throw std::runtime_error("Cannot write " + current_staging.string());
+        }
+    }
+    syncFile(current_staging.string());
+    fs::rename(current_staging, fs::path(path_) / CURRENT_FILE);
+    syncFile(path_);
+
+    spdlog::info("Published index bundle generation {} to {}", generation, bundle_path.string());
+    removeStaleBundles(generation, std::max<size_t>(keep, 1));
+    return generation;
+}
+
+bool BundleDirectory::refresh() {
+    auto name = readCurrent();
+    if (!name || *name == current_file_) {
+        return false;
+    }
+
+    try {
+        auto bundle = IndexBundle::open((fs::path(path_) / *name).string());
+        std::atomic_store(&current_, bundle);
+        current_file_ = *name;
+        spdlog::info("Attached index bundle generation {} ({} books, {:.1f} MiB mapped)",
+                     bundle->generation(), bundle->size(), bundle->mappedBytes() / (1024.0 * 1024.0));
+        return true;
+    } catch (const std::exception& e) {
+        // Usually a publish racing with cleanup; the next poll sees the
+        // newer CURRENT
+        spdlog::warn("Cannot attach index bundle {}: {}", *name, e.what());
+        return false;
+    }
+}
+
+std::optional<std::string> BundleDirectory::readCurrent() const {
+    std::ifstream current(fs::path(path_) / CURRENT_FILE);
+    std::string name;
+    if (!current || !std::getline(current, name) || name.empty()) {
+        return std::nullopt;
+    }
+    return name;
+}
+
+void BundleDirectory::removeStaleBundles(uint64_t newest, size_t keep) const {
+    for (const auto& entry : fs::directory_iterator(path_)) {
+        uint64_t generation = generationOf(entry.path().filename().string());
+        if (generation > 0 && generation + keep <= newest) {
+            std::error_code error;
+            fs::remove(entry.path(), error);
+        }
+    }
+}
+
+}
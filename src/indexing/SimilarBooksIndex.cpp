@@ -0,0 +1,138 @@
+#include "book_recommender/SimilarBooksIndex.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace book_recommender {
+
+SimilarBooksIndex::SimilarBooksIndex(std::shared_ptr<const SimilarityGraph> graph)
+    : graph_(std::move(graph)) {}
+
+bool SimilarBooksIndex::lookup(
+    const std::string& doc_id,
+    int top_k,
+    std::vector<Neighbor>& neighbors
+) const {
+    // Rows hold at most k entries, so a longer list needs a live search
+    if (top_k > graph_->k()) {
+        return false;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (versionOf(doc_id) == REMOVED) {
+        return false;
+    }
+
+    auto wanted = static_cast<size_t>(std::max(top_k, 0));
+    size_t stale = 0;
+    size_t available = 0;
+
+    auto consider = [&](const std::string& neighbor_id, float score, uint64_t version) {
+        if (versionOf(neighbor_id) != version) {
+            ++stale;
+            return;
+        }
+        ++available;
+        if (neighbors.size() < wanted) {
+            neighbors.push_back({neighbor_id, score});
+        }
+    };
+
+    auto overlay = rows_.find(doc_id);
+    if (overlay != rows_.end()) {
+        for (const auto& entry : overlay->second) {
+            consider(entry.doc_id, entry.score, entry.version);
+        }
+    } else {
+        auto slot = graph_->slotOf(doc_id);
+        if (!slot) {
+            return false;
+        }
+        const uint32_t* slots = graph_->neighborSlots(*slot);
+        const float* scores = graph_->neighborScores(*slot);
+        int count = graph_->neighborCount(*slot);
+        for (int i = 0; i < count; ++i) {
+            consider(graph_->docId(slots[i]), scores[i], BASE_VERSION);
+        }
+    }
+
+    // A short row is fine when the catalog simply has few neighbours, but
+    // not when stale entries are what made it short
+    if (neighbors.size() < wanted && stale > 0) {
+        neighbors.clear();
+        return false;
+    }
+    return true;
+}
+
+void SimilarBooksIndex::patch(const std::string& doc_id, const std::vector<Neighbor>& neighbors) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const size_t k = static_cast<size_t>(graph_->k());
+    const uint64_t version = next_version_++;
+    versions_[doc_id] = version;
+
+    std::vector<Entry> own_row;
+    own_row.reserve(std::min(neighbors.size(), k));
+    for (const auto& neighbor : neighbors) {
+        if (own_row.size() == k) break;
+        if (neighbor.doc_id == doc_id) continue;
+        own_row.push_back({neighbor.doc_id, neighbor.score, versionOf(neighbor.doc_id)});
+    }
+
+    // Similarity is symmetric, so each new neighbour may now rank this book
+    for (const auto& entry : own_row) {
+        std::vector<Entry> row;
+        if (!rowOf(entry.doc_id, row)) continue;
+
+        row.erase(
+            std::remove_if(row.begin(), row.end(), [&](const Entry& e) { return e.doc_id == doc_id; }),
+            row.end()
+        );
+        auto position = std::find_if(row.begin(), row.end(),
+                                     [&](const Entry& e) { return e.score < entry.score; });
+        if (static_cast<size_t>(position - row.begin()) >= k) continue;
+        row.insert(position, {doc_id, entry.score, version});
+        if (row.size() > k) row.resize(k);
+        rows_[entry.doc_id] = std::move(row);
+    }
+
+    rows_[doc_id] = std::move(own_row);
+}
+
+void SimilarBooksIndex::invalidate(const std::string& doc_id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    versions_[doc_id] = REMOVED;
+    rows_.erase(doc_id);
+}
+
+size_t SimilarBooksIndex::patchedRows() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return rows_.size();
+}
+
+uint64_t SimilarBooksIndex::versionOf(const std::string& doc_id) const {
+    auto it = versions_.find(doc_id);
+    return it == versions_.end() ? BASE_VERSION : it->second;
+}
+
+bool SimilarBooksIndex::rowOf(const std::string& doc_id, std::vector<Entry>& row) const {
+    auto overlay = rows_.find(doc_id);
+    if (overlay != rows_.end()) {
+        row = overlay->second;
+        return true;
+    }
+
+    auto slot = graph_->slotOf(doc_id);
+    if (!slot || versionOf(doc_id) == REMOVED) {
+        return false;
+    }
+    const uint32_t* slots = graph_->neighborSlots(*slot);
+    const float* scores = graph_->neighborScores(*slot);
+    int count = graph_->neighborCount(*slot);
+    row.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        row.push_back({graph_->docId(slots[i]), scores[i], BASE_VERSION});
+    }
+    return true;
+}
+
+}
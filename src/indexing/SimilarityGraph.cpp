@@ -0,0 +1,201 @@
+#include "book_recommender/SimilarityGraph.hpp"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "../utils/MappedFile.hpp"
+
+namespace book_recommender {
+
+namespace {
+
+constexpr char GRAPH_MAGIC[4] = {'B', 'R', 'S', 'G'};
+constexpr uint32_t GRAPH_VERSION = 1;
+constexpr uint64_t SECTION_ALIGNMENT = 64;
+
+struct GraphHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t node_count;
+    uint32_t k;
+    uint32_t reserved;
+    uint64_t neighbors_offset;
+    uint64_t scores_offset;
+    uint64_t ids_offset;
+};
+
+uint64_t alignUp(uint64_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+void padTo(std::ofstream& file, uint64_t offset) {
+    static const char zeros[SECTION_ALIGNMENT] = {};
+    auto position = static_cast<uint64_t>(file.tellp());
+    file.write(zeros, static_cast<std::streamsize>(offset - position));
+}
+
+}
+
+SimilarityGraph::SimilarityGraph(std::vector<std::string> doc_ids, int k)
+    : k_(k),
+      doc_ids_(std::move(doc_ids)) {
+    if (k <= 0) {
+        throw std::invalid_argument("Similarity graph needs k > 0");
+    }
+    neighbors_.assign(doc_ids_.size() * k, NO_NEIGHBOR);
+    scores_.assign(doc_ids_.size() * k, 0.0f);
+    neighbor_data_ = neighbors_.data();
+    score_data_ = scores_.data();
+    indexSlots();
+}
+
+void SimilarityGraph::indexSlots() {
+    slots_.reserve(doc_ids_.size());
+    for (uint32_t slot = 0; slot < doc_ids_.size(); ++slot) {
+        slots_.emplace(doc_ids_[slot], slot);
+    }
+}
+
+std::optional<uint32_t> SimilarityGraph::slotOf(const std::string& doc_id) const {
+    auto it = slots_.find(doc_id);
+    if (it == slots_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+int SimilarityGraph::neighborCount(uint32_t slot) const {
+    const uint32_t* row = neighborSlots(slot);
+    int count = 0;
+    while (count < k_ && row[count] != NO_NEIGHBOR) {
+        ++count;
+    }
+    return count;
+}
+
+void SimilarityGraph::setNeighbors(uint32_t slot, const int64_t* labels, const float* scores, size_t count) {
+    if (mapping_) {
+        throw std::logic_error("Loaded similarity graphs are read-only");
+    }
+    uint32_t* row = neighbors_.data() + size_t(slot) * k_;
+    float* row_scores = scores_.data() + size_t(slot) * k_;
+
+    int filled = 0;
+    for (size_t i = 0; i < count && filled < k_; ++i) {
+        if (labels[i] < 0 || static_cast<size_t>(labels[i]) >= doc_ids_.size() || labels[i] == slot) {
+            continue;
+        }
+        row[filled] = static_cast<uint32_t>(labels[i]);
+        row_scores[filled] = scores[i];
+        ++filled;
+    }
+    for (int i = filled; i < k_; ++i) {
+        row[i] = NO_NEIGHBOR;
+        row_scores[i] = 0.0f;
+    }
+}
+
+void SimilarityGraph::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot write similarity graph: " + path);
+    }
+
+    GraphHeader header{};
+    std::memcpy(header.magic, GRAPH_MAGIC, sizeof(GRAPH_MAGIC));
+    header.version = GRAPH_VERSION;
+    header.node_count = doc_ids_.size();
+    header.k = static_cast<uint32_t>(k_);
+    header.neighbors_offset = alignUp(sizeof(GraphHeader));
+    size_t entries = doc_ids_.size() * k_;
+    header.scores_offset = alignUp(header.neighbors_offset + entries * sizeof(uint32_t));
+    header.ids_offset = alignUp(header.scores_offset + entries * sizeof(float));
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    padTo(file, header.neighbors_offset);
+    file.write(reinterpret_cast<const char*>(neighbor_data_),
+               static_cast<std::streamsize>(entries * sizeof(uint32_t)));
+    padTo(file, header.scores_offset);
+    file.write(reinterpret_cast<const char*>(score_data_),
+               static_cast<std::streamsize>(entries * sizeof(float)));
+    padTo(file, header.ids_offset);
+    for (const auto& id : doc_ids_) {
+        auto length = static_cast<uint32_t>(id.size());
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(id.data(), length);
+    }
+
+    if (!file) {
+        throw std::runtime_error("Failed writing similarity graph: " + path);
+    }
+}
+
+SimilarityGraph SimilarityGraph::load(const std::string& path) {
+    auto file = std::make_shared<const MappedFile>(path);
+    const char* data = file->data();
+
+    GraphHeader header{};
+    if (file->size() < sizeof(header)) {
+        throw std::runtime_error("Not a similarity graph: " + path);
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, GRAPH_MAGIC, sizeof(GRAPH_MAGIC)) != 0) {
+        throw std::runtime_error("Not a similarity graph: " + path);
+    }
+    if (header.version != GRAPH_VERSION) {
+        throw std::runtime_error("Unsupported similarity graph version " + std::to_string(header.version));
+    }
+    if (header.k == 0) {
+        throw std::runtime_error("Similarity graph has k = 0: " + path);
+    }
+
+    // Sizes come from the file, so products and sums are checked for
+    // overflow before anything is allocated or indexed with them
+    auto entries = arrayBytes(header.node_count, header.k);
+    auto neighbor_bytes = entries ? arrayBytes(*entries, sizeof(uint32_t)) : std::nullopt;
+    auto score_bytes = entries ? arrayBytes(*entries, sizeof(float)) : std::nullopt;
+    if (header.k > INT32_MAX || !neighbor_bytes || !score_bytes ||
+        header.neighbors_offset % SECTION_ALIGNMENT != 0 ||
+        header.scores_offset % SECTION_ALIGNMENT != 0 ||
+        !file->contains(header.neighbors_offset, *neighbor_bytes) ||
+        !file->contains(header.scores_offset, *score_bytes) ||
+        !file->contains(header.ids_offset, 0)) {
+        throw std::runtime_error("Truncated similarity graph: " + path);
+    }
+
+    // Lookups index doc ids by neighbour slot, so every slot must name a node
+    auto neighbors = reinterpret_cast<const uint32_t*>(data + header.neighbors_offset);
+    for (uint64_t i = 0; i < *entries; ++i) {
+        if (neighbors[i] != NO_NEIGHBOR && neighbors[i] >= header.node_count) {
+            throw std::runtime_error("Corrupt similarity graph: " + path);
+        }
+    }
+
+    SimilarityGraph graph;
+    graph.k_ = static_cast<int>(header.k);
+    graph.doc_ids_.resize(header.node_count);
+
+    uint64_t offset = header.ids_offset;
+    for (auto& id : graph.doc_ids_) {
+        uint32_t length = 0;
+        if (!file->contains(offset, sizeof(length))) {
+            throw std::runtime_error("Truncated similarity graph: " + path);
+        }
+        std::memcpy(&length, data + offset, sizeof(length));
+        offset += sizeof(length);
+        if (!file->contains(offset, length)) {
+            throw std::runtime_error("Truncated similarity graph: " + path);
+        }
+        id.assign(data + offset, length);
+        offset += length;
+    }
+    graph.indexSlots();
+
+    // Sections are 64-byte aligned in the file and mappings are page
+    // aligned, so the arrays can be used in place
+    graph.neighbor_data_ = neighbors;
+    graph.score_data_ = reinterpret_cast<const float*>(data + header.scores_offset);
+    graph.mapping_ = std::move(file);
+    return graph;
+}
+
+}
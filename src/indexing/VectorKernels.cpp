@@ -0,0 +1,153 @@
+#include "book_recommender/VectorKernels.hpp"
+#include <algorithm>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace book_recommender {
+
+namespace {
+
+// Partial sums per row: lane j accumulates elements j, j + LANES, ...
+// Eight floats are two SSE registers, so four rows' accumulators still
+// leave registers for the loads.
+constexpr size_t LANES = 8;
+
+#if defined(__SSE2__)
+struct Block {
+    __m128 low;
+    __m128 high;
+
+    static Block load(const float* p) { return {_mm_loadu_ps(p), _mm_loadu_ps(p + 4)}; }
+};
+
+struct Accumulator {
+    __m128 low = _mm_setzero_ps();
+    __m128 high = _mm_setzero_ps();
+
+    void add(const Block& a, const Block& b) {
+        low = _mm_add_ps(low, _mm_mul_ps(a.low, b.low));
+        high = _mm_add_ps(high, _mm_mul_ps(a.high, b.high));
+    }
+
+    void store(float* lanes) const {
+        _mm_storeu_ps(lanes, low);
+        _mm_storeu_ps(lanes + 4, high);
+    }
+};
+#else
+struct Block {
+    float lanes[LANES];
+
+    static Block load(const float* p) {
+        Block block;
+        std::copy_n(p, LANES, block.lanes);
+        return block;
+    }
+};
+
+struct Accumulator {
+    float sums[LANES] = {};
+
+    void add(const Block& a, const Block& b) {
+        for (size_t j = 0; j < LANES; ++j) sums[j] += a.lanes[j] * b.lanes[j];
+    }
+
+    void store(float* lanes) const { std::copy_n(sums, LANES, lanes); }
+};
+#endif
+
+// Same order for every kernel, so dot and dotRows agree exactly
+float sum(const Accumulator& acc) {
+    float l[LANES];
+    acc.store(l);
+    return ((l[0] + l[4]) + (l[2] + l[6])) + ((l[1] + l[5]) + (l[3] + l[7]));
+}
+
+template <size_t... Blocks>
+float dotBlocks(const float* a, const float* b, std::index_sequence<Blocks...>) {
+    Accumulator acc;
+    (acc.add(Block::load(a + Blocks * LANES), Block::load(b + Blocks * LANES)), ...);
+    return sum(acc);
+}
+
+template <size_t D, size_t... Blocks>
+void dotFourRowsBlocks(const float* query, const float* rows, float* out, std::index_sequence<Blocks...>) {
+    Accumulator acc0, acc1, acc2, acc3;
+    auto step = [&](size_t offset) {
+        Block q = Block::load(query + offset);
+        acc0.add(q, Block::load(rows + offset));
+        acc1.add(q, Block::load(rows + D + offset));
+        acc2.add(q, Block::load(rows + 2 * D + offset));
+        acc3.add(q, Block::load(rows + 3 * D + offset));
+    };
+    (step(Blocks * LANES), ...);
+    out[0] = sum(acc0);
+    out[1] = sum(acc1);
+    out[2] = sum(acc2);
+    out[3] = sum(acc3);
+}
+
+template <size_t D>
+float dotFixed(const float* a, const float* b, size_t) {
+    static_assert(D % LANES == 0, "specialized dimensions are whole blocks");
+    return dotBlocks(a, b, std::make_index_sequence<D / LANES>{});
+}
+
+template <size_t D>
+void dotRowsFixed(const float* query, const float* rows, size_t count, size_t, float* out) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        dotFourRowsBlocks<D>(query, rows + i * D, out + i, std::make_index_sequence<D / LANES>{});
+    }
+    for (; i < count; ++i) {
+        out[i] = dotFixed<D>(query, rows + i * D, D);
+    }
+}
+
+float dotGeneric(const float* a, const float* b, size_t dimension) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < dimension; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void dotRowsGeneric(const float* query, const float* rows, size_t count, size_t dimension, float* out) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = dotGeneric(query, rows + i * dimension, dimension);
+    }
+}
+
+}
+
+template <size_t D>
+void VectorKernels::useFixed() {
+    specialized_ = true;
+    dot_ = dotFixed<D>;
+    dot_rows_ = dotRowsFixed<D>;
+}
+
+VectorKernels::VectorKernels(size_t dimension)
+    : dimension_(dimension),
+      dot_(dotGeneric),
+      dot_rows_(dotRowsGeneric) {
+    switch (dimension) {
+        case 128: useFixed<128>(); break;
+        case 256: useFixed<256>(); break;
+        case 384: useFixed<384>(); break;
+        case 768: useFixed<768>(); break;
+        case 1024: useFixed<1024>(); break;
+        default: break;
+    }
+}
+
+VectorKernels VectorKernels::generic(size_t dimension) {
+    VectorKernels kernels;
+    kernels.dimension_ = dimension;
+    return kernels;
+}
+
+}
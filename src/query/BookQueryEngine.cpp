@@ -1,71 +1,489 @@
 #include "book_recommender/BookQueryEngine.hpp"
 #include <algorithm>
+#include <limits>
 #include <sstream>
+#include <type_traits>
 #include <unordered_set>
 #include <cmath>
-#include <regex>
 #include <spdlog/spdlog.h>
+#include "book_recommender/Metrics.hpp"
+#include "book_recommender/RequestArena.hpp"
+#include "book_recommender/TaskExecutor.hpp"
+#include "book_recommender/TextNormalizer.hpp"
+#include "book_recommender/Tracing.hpp"
 #include "../utils/GroqClient.hpp"
 
 namespace book_recommender {
 
+namespace {
+
+thread_local uint64_t thread_failures = 0;
+
+struct QueryEngineMetrics {
+    Histogram& enhance;
+    Histogram& embed;
+    Histogram& search;
+    Histogram& filter;
+    Histogram& rank;
+    Histogram& explain;
+    Counter& errors;
+    Counter& graph_hits;
+    Counter& graph_misses;
+};
+
+QueryEngineMetrics& queryEngineMetrics() {
+    auto& registry = MetricsRegistry::getInstance();
+    const std::string stage_metric = "book_recommender_query_stage_seconds";
+    const std::string stage_help = "Latency of each recommendation pipeline stage";
+    static QueryEngineMetrics metrics{
+        registry.histogram(stage_metric, stage_help, {{"stage", "enhance"}}),
+        registry.histogram(stage_metric, stage_help, {{"stage", "embed"}}),
+        registry.histogram(stage_metric, stage_help, {{"stage", "search"}}),
+        registry.histogram(stage_metric, stage_help, {{"stage", "filter"}}),
+        registry.histogram(stage_metric, stage_help, {{"stage", "rank"}}),
+        registry.histogram(stage_metric, stage_help, {{"stage", "explain"}}),
+        registry.counter("book_recommender_query_errors_total",
+                         "Recommendation requests that failed with an exception"),
+        registry.counter("book_recommender_similarity_graph_lookups_total",
+                         "Similar-book requests answered from the precomputed graph", {{"result", "hit"}}),
+        registry.counter("book_recommender_similarity_graph_lookups_total",
+                         "Similar-book requests answered from the precomputed graph", {{"result", "miss"}})
+    };
+    return metrics;
+}
+
+}
+
 BookQueryEngine::BookQueryEngine(std::shared_ptr<BookVectorStore> vector_store)
-    : vector_store_(std::move(vector_store)) {}
+    : vector_store_(std::move(vector_store)),
+      fusion_(std::make_shared<const BookVectorStore::FusionOptions>()),
+      taxonomy_(std::make_shared<const GenreTaxonomy>(GenreTaxonomy::defaultTaxonomy())) {}
 
 std::vector<BookQueryEngine::RecommendationResult> BookQueryEngine::getRecommendations(
     const std::string& query,
     const QueryFilter& filter,
     int top_k
 ) {
+    return streamRecommendations(query, RecommendationStream{}, filter, top_k);
+}
+
+std::vector<BookQueryEngine::RecommendationResult> BookQueryEngine::streamRecommendations(
+    const std::string& query,
+    const RecommendationStream& stream,
+    const QueryFilter& filter,
+    int top_k
+) {
+    auto& metrics = queryEngineMetrics();
+    RequestArena arena;
     try {
-        std::string enhanced_query = enhanceQuery(query);
-        auto query_vector = vectorizeQuery(enhanced_query);
+        std::string enhanced_query;
+        {
+            Span span("BookQueryEngine.enhance");
+            ScopedTimer timer(metrics.enhance);
+            enhanced_query = enhanceQuery(query);
+        }
+
+        std::vector<float> query_vector;
+        {
+            Span span("BookQueryEngine.embed");
+            ScopedTimer timer(metrics.embed);
+            query_vector = vectorizeQuery(enhanced_query);
+        }
         
-        auto search_results = vector_store_->search(query_vector, top_k * 2);
-        auto recommendations = processSearchResults(search_results, query, filter);
+        std::pmr::vector<BookVectorStore::SearchResult> search_results(arena.resource());
+        {
+            Span span("BookQueryEngine.search");
+            ScopedTimer timer(metrics.search);
+            auto fusion = std::atomic_load(&fusion_);
+            search_results = vector_store_->search(query_vector, top_k * 2, *fusion, arena.resource());
+        }
+
+        std::vector<RecommendationResult> recommendations;
+        {
+            Span span("BookQueryEngine.filter");
+            ScopedTimer timer(metrics.filter);
+            recommendations = processSearchResults(search_results, filter);
+            span.setAttribute("candidates", search_results.size());
+            span.setAttribute("passed", recommendations.size());
+        }
         
-        rankResults(recommendations);
-        if (recommendations.size() > static_cast<size_t>(top_k)) {
-            recommendations.resize(top_k);
+        {
+            Span span("BookQueryEngine.rank");
+            ScopedTimer timer(metrics.rank);
+            rankResults(recommendations);
+            if (recommendations.size() > static_cast<size_t>(top_k)) {
+                recommendations.resize(top_k);
+            }
+        }
+        if (stream.on_results) {
+            stream.on_results(recommendations);
+        }
+
+        // Explanations are only generated for results that survive ranking
+        {
+            Span span("BookQueryEngine.explain");
+            ScopedTimer timer(metrics.explain);
+            std::mutex stream_mutex;
+            addExplanations(recommendations, query, TaskPriority::Interactive, [&](size_t i) {
+                if (!stream.on_explanation) return;
+                std::lock_guard<std::mutex> lock(stream_mutex);
+                stream.on_explanation(i, recommendations[i]);
+            });
         }
         
         return recommendations;
     } catch (const std::exception& e) {
+        metrics.errors.increment();
+        ++thread_failures;
         spdlog::error("Error getting recommendations: {}", e.what());
         return {};
     }
 }
 
+#ifdef BOOK_RECOMMENDER_COROUTINES
+AsyncTask<std::vector<BookQueryEngine::RecommendationResult>> BookQueryEngine::getRecommendationsAsync(
+    std::string query,
+    QueryFilter filter,
+    int top_k,
+    TaskPriority priority
+) {
+    // Same stages as getRecommendations, but the Groq round trips suspend
+    // the coroutine instead of parking a thread, and every stage runs on an
+    // executor worker. Spans are bound to threads, so only the stage
+    // metrics are recorded here.
+    auto& metrics = queryEngineMetrics();
+    auto& groq = GroqClient::getInstance();
+    try {
+        co_await resumeOn(priority);
+
+        std::string enhanced_query;
+        {
+            ScopedTimer timer(metrics.enhance);
+            enhanced_query = co_await groq.enhanceQueryAsync(query, priority);
+        }
+
+        std::vector<float> query_vector;
+        {
+            // A failed embed fails the request; searching with a stand-in
+            // vector would answer with arbitrary books
+            ScopedTimer timer(metrics.embed);
+            query_vector = co_await groq.getEmbeddingAsync(preprocessQuery(enhanced_query), priority);
+        }
+
+        std::vector<RecommendationResult> recommendations;
+        {
+            std::vector<BookVectorStore::SearchResult> search_results;
+            {
+                ScopedTimer timer(metrics.search);
+                auto fusion = std::atomic_load(&fusion_);
+                search_results = vector_store_->search(query_vector, top_k * 2, *fusion);
+            }
+            ScopedTimer timer(metrics.filter);
+            recommendations = processSearchResults(search_results, filter);
+        }
+
+        {
+            ScopedTimer timer(metrics.rank);
+            rankResults(recommendations);
+            if (recommendations.size() > static_cast<size_t>(top_k)) {
+                recommendations.resize(top_k);
+            }
+        }
+
+        {
+            ScopedTimer timer(metrics.explain);
+            std::vector<AsyncTask<std::string>> explanations;
+            explanations.reserve(recommendations.size());
+            for (const auto& recommendation : recommendations) {
+                explanations.push_back(explainAsync(recommendation.book, query, priority));
+            }
+            auto texts = co_await whenAll(std::move(explanations));
+            for (size_t i = 0; i < recommendations.size(); ++i) {
+                recommendations[i].explanation = std::move(texts[i]);
+            }
+        }
+
+        co_return recommendations;
+    } catch (const std::exception& e) {
+        metrics.errors.increment();
+        ++thread_failures;
+        spdlog::error("Error getting recommendations: {}", e.what());
+    }
+    co_return std::vector<RecommendationResult>{};
+}
+
+AsyncTask<std::string> BookQueryEngine::explainAsync(
+    std::shared_ptr<const Book> book,
+    std::string query,
+    TaskPriority priority
+) const {
+    try {
+        co_return co_await GroqClient::getInstance().generateExplanationAsync(
+            describeBook(*book), std::move(query), priority);
+    } catch (const std::exception& e) {
+        spdlog::error("Error generating explanation with Groq: {}", e.what());
+    }
+    co_return fallbackExplanation(*book);
+}
+#endif
+
+std::vector<std::vector<BookQueryEngine::RecommendationResult>> BookQueryEngine::getRecommendationsBatch(
+    const std::vector<std::string>& queries,
+    const QueryFilter& filter,
+    int top_k
+) {
+    auto& metrics = queryEngineMetrics();
+    Span batch_span("BookQueryEngine.batch");
+    batch_span.setAttribute("queries", queries.size());
+    try {
+        // Embedding is a remote call per query, so those calls fan out on
+        // the blocking executor; the batch starts paying off once the
+        // vectors are in hand. Batch jobs run at background priority.
+        auto& executor = TaskExecutor::getInstance();
+        auto& blocking = TaskExecutor::getBlockingInstance();
+        std::vector<std::optional<std::vector<float>>> embedded(queries.size());
+        blocking.parallelFor(0, queries.size(), [&](size_t i) {
+            try {
+                std::string enhanced_query;
+                {
+                    Span span("BookQueryEngine.enhance");
+                    ScopedTimer timer(metrics.enhance);
+                    enhanced_query = enhanceQuery(queries[i]);
+                }
+                // Not vectorizeQuery: its zero-vector fallback would fill
+                // this slot with arbitrary books instead of leaving it empty
+                Span span("BookQueryEngine.embed");
+                ScopedTimer timer(metrics.embed);
+                embedded[i] = GroqClient::getInstance().getEmbedding(preprocessQuery(enhanced_query));
+            } catch (const std::exception& e) {
+                metrics.errors.increment();
+                spdlog::warn("Skipping batch query '{}': {}", queries[i], e.what());
+            }
+        }, TaskPriority::Background);
+
+        std::vector<std::vector<float>> query_vectors;
+        std::vector<size_t> query_slots;
+        query_vectors.reserve(queries.size());
+        query_slots.reserve(queries.size());
+        for (size_t i = 0; i < queries.size(); ++i) {
+            if (embedded[i]) {
+                query_vectors.push_back(std::move(*embedded[i]));
+                query_slots.push_back(i);
+            }
+        }
+
+        std::vector<std::vector<BookVectorStore::SearchResult>> search_results;
+        {
+            Span span("BookQueryEngine.search");
+            ScopedTimer timer(metrics.search);
+            auto fusion = std::atomic_load(&fusion_);
+            search_results = vector_store_->batchSearch(query_vectors, top_k * 2, *fusion);
+        }
+
+        std::vector<std::vector<RecommendationResult>> batch(queries.size());
+        {
+            Span span("BookQueryEngine.filter");
+            ScopedTimer timer(metrics.filter);
+            executor.parallelFor(0, search_results.size(), [&](size_t j) {
+                auto& recommendations = batch[query_slots[j]];
+                recommendations = processSearchResults(search_results[j], filter);
+                rankResults(recommendations);
+                if (recommendations.size() > static_cast<size_t>(top_k)) {
+                    recommendations.resize(top_k);
+                }
+            }, TaskPriority::Background);
+        }
+
+        {
+            Span span("BookQueryEngine.explain");
+            ScopedTimer timer(metrics.explain);
+            blocking.parallelFor(0, queries.size(), [&](size_t i) {
+                addExplanations(batch[i], queries[i], TaskPriority::Background);
+            }, TaskPriority::Background);
+        }
+
+        return batch;
+    } catch (const std::exception& e) {
+        metrics.errors.increment();
+        batch_span.setError(e.what());
+        spdlog::error("Error getting batch recommendations: {}", e.what());
+        return std::vector<std::vector<RecommendationResult>>(queries.size());
+    }
+}
+
 std::vector<BookQueryEngine::RecommendationResult> BookQueryEngine::getSimilarBooks(
     const std::string& book_id,
     const QueryFilter& filter,
     int top_k
 ) {
+    auto& metrics = queryEngineMetrics();
+    RequestArena arena;
     try {
-        auto search_results = vector_store_->searchSimilar(book_id, top_k * 2);
-        auto recommendations = processSearchResults(search_results, "", filter);
+        std::pmr::vector<BookVectorStore::SearchResult> search_results(arena.resource());
+        {
+            Span span("BookQueryEngine.search");
+            ScopedTimer timer(metrics.search);
+            auto similar_books = std::atomic_load(&similar_books_);
+            bool from_graph = similar_books &&
+                              neighborsFromGraph(*similar_books, book_id, top_k * 2, search_results);
+            if (similar_books) {
+                (from_graph ? metrics.graph_hits : metrics.graph_misses).increment();
+            }
+            if (!from_graph) {
+                search_results = vector_store_->searchSimilar(book_id, top_k * 2, arena.resource());
+            }
+            span.setAttribute("source", from_graph ? "graph" : "live");
+        }
+
+        std::vector<RecommendationResult> recommendations;
+        {
+            Span span("BookQueryEngine.filter");
+            ScopedTimer timer(metrics.filter);
+            recommendations = processSearchResults(search_results, filter);
+            span.setAttribute("candidates", search_results.size());
+            span.setAttribute("passed", recommendations.size());
+        }
         
         recommendations.erase(
             std::remove_if(
                 recommendations.begin(),
                 recommendations.end(),
-                [&](const auto& rec) { return rec.book.getId() == book_id; }
+                [&](const auto& rec) { return rec.book->getId() == book_id; }
             ),
             recommendations.end()
         );
         
-        rankResults(recommendations);
-        if (recommendations.size() > static_cast<size_t>(top_k)) {
-            recommendations.resize(top_k);
+        {
+            Span span("BookQueryEngine.rank");
+            ScopedTimer timer(metrics.rank);
+            rankResults(recommendations);
+            if (recommendations.size() > static_cast<size_t>(top_k)) {
+                recommendations.resize(top_k);
+            }
+        }
+
+        {
+            Span span("BookQueryEngine.explain");
+            ScopedTimer timer(metrics.explain);
+            addExplanations(recommendations, "");
         }
         
         return recommendations;
     } catch (const std::exception& e) {
+        metrics.errors.increment();
+        ++thread_failures;
         spdlog::error("Error getting similar books: {}", e.what());
         return {};
     }
 }
 
+std::vector<BookQueryEngine::RecommendationResult> BookQueryEngine::getPersonalizedRecommendations(
+    const UserProfileStore& profiles,
+    const UserProfile& profile,
+    const QueryFilter& filter,
+    int top_k
+) {
+    auto& metrics = queryEngineMetrics();
+    try {
+        std::vector<BookVectorStore::SearchResult> search_results;
+        {
+            Span span("BookQueryEngine.search");
+            ScopedTimer timer(metrics.search);
+            search_results = profiles.search(profile, top_k * 2);
+        }
+
+        std::vector<RecommendationResult> recommendations;
+        {
+            Span span("BookQueryEngine.filter");
+            ScopedTimer timer(metrics.filter);
+            recommendations = processSearchResults(search_results, filter);
+            span.setAttribute("candidates", search_results.size());
+            span.setAttribute("passed", recommendations.size());
+        }
+
+        {
+            Span span("BookQueryEngine.rank");
+            ScopedTimer timer(metrics.rank);
+            rankResults(recommendations);
+            if (recommendations.size() > static_cast<size_t>(top_k)) {
+                recommendations.resize(top_k);
+            }
+        }
+
+        {
+            Span span("BookQueryEngine.explain");
+            ScopedTimer timer(metrics.explain);
+            addExplanations(recommendations, "");
+        }
+
+        return recommendations;
+    } catch (const std::exception& e) {
+        metrics.errors.increment();
+        ++thread_failures;
+        spdlog::error("Error getting personalized recommendations: {}", e.what());
+        return {};
+    }
+}
+
+uint64_t BookQueryEngine::getThreadFailureCount() {
+    return thread_failures;
+}
+
+void BookQueryEngine::setSimilarityGraph(std::shared_ptr<const SimilarityGraph> graph) {
+    std::shared_ptr<SimilarBooksIndex> index;
+    if (graph) {
+        index = std::make_shared<SimilarBooksIndex>(std::move(graph));
+    }
+    std::atomic_store(&similar_books_, std::move(index));
+}
+
+void BookQueryEngine::setFusionOptions(const BookVectorStore::FusionOptions& fusion) {
+    std::atomic_store(&fusion_, std::make_shared<const BookVectorStore::FusionOptions>(fusion));
+}
+
+void BookQueryEngine::setGenreTaxonomy(std::shared_ptr<const GenreTaxonomy> taxonomy) {
+    if (!taxonomy) {
+        throw std::invalid_argument("A genre taxonomy is required");
+    }
+    // Cached genre sets carry the taxonomy they were built for and are
+    // rebuilt on next use
+    std::atomic_store(&taxonomy_, std::move(taxonomy));
+}
+
+void BookQueryEngine::onBookUpserted(const std::string& book_id) {
+    forgetBook(book_id);
+    auto similar_books = std::atomic_load(&similar_books_);
+    if (!similar_books) return;
+
+    try {
+        auto results = vector_store_->searchSimilar(book_id, similar_books->graph().k());
+        std::vector<SimilarBooksIndex::Neighbor> neighbors;
+        neighbors.reserve(results.size());
+        for (auto& result : results) {
+            neighbors.push_back({std::move(result.doc_id), result.similarity});
+        }
+        similar_books->patch(book_id, neighbors);
+    } catch (const std::exception& e) {
+        // Without a fresh row the book must not be served from the graph
+        spdlog::warn("Could not patch similarity graph for {}: {}", book_id, e.what());
+        similar_books->invalidate(book_id);
+    }
+}
+
+void BookQueryEngine::onBookRemoved(const std::string& book_id) {
+    forgetBook(book_id);
+    if (auto similar_books = std::atomic_load(&similar_books_)) {
+        similar_books->invalidate(book_id);
+    }
+}
+
+// A replaced document would miss the cache anyway; erasing the entry is
+// what keeps removed books from accumulating in it
+void BookQueryEngine::forgetBook(const std::string& book_id) {
+    std::lock_guard<std::mutex> lock(book_cache_mutex_);
+    book_cache_.erase(book_id);
+}
+
 std::vector<BookQueryEngine::RecommendationResult> BookQueryEngine::getAuthorRecommendations(
     const std::string& author,
     const QueryFilter& filter,
@@ -81,6 +499,7 @@ std::vector<BookQueryEngine::RecommendationResult> BookQueryEngine::getAuthorRec
         std::string query = "books by author " + author;
         return getRecommendations(query, author_filter, top_k);
     } catch (const std::exception& e) {
+        ++thread_failures;
         spdlog::error("Error getting author recommendations: {}", e.what());
         return {};
     }
@@ -95,6 +514,7 @@ std::vector<BookQueryEngine::RecommendationResult> BookQueryEngine::getSeriesRec
         std::string query = "books in series " + series;
         return getRecommendations(query, filter, top_k);
     } catch (const std::exception& e) {
+        ++thread_failures;
         spdlog::error("Error getting series recommendations: {}", e.what());
         return {};
     }
@@ -122,36 +542,77 @@ std::string BookQueryEngine::enhanceQuery(const std::string& query) const {
 }
 
 std::string BookQueryEngine::preprocessQuery(const std::string& query) const {
-    std::string processed = query;
-    
-    // Convert to lowercase
-    std::transform(processed.begin(), processed.end(), processed.begin(), ::tolower);
-    
-    // Remove punctuation
-    processed.erase(
-        std::remove_if(processed.begin(), processed.end(), ::ispunct),
-        processed.end()
-    );
-    
-    // Remove excessive whitespace
-    std::regex whitespace_regex("\\s+");
-    processed = std::regex_replace(processed, whitespace_regex, " ");
-    
-    // Trim
-    processed = std::regex_replace(processed, std::regex("^\\s+|\\s+$"), "");
-    
-    return processed;
+    // Same normalization as document text, so queries and books embed alike
+    return normalizeText(query);
+}
+
+std::string BookQueryEngine::QueryFilter::digest() const {
+    // Strings are length-prefixed so no value can forge a separator, and
+    // doubles are written with enough digits to round-trip
+    std::ostringstream out;
+    out.precision(std::numeric_limits<double>::max_digits10);
+    auto list = [&](const char* name, const std::optional<std::vector<std::string>>& values) {
+        if (!values || values->empty()) return;
+        auto sorted = *values;
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        out << name << '=';
+        for (const auto& value : sorted) {
+            out << value.size() << ':' << value;
+        }
+        out << ';';
+    };
+    auto value = [&](const char* name, const auto& field) {
+        if (!field) return;
+        out << name << '=';
+        if constexpr (std::is_same_v<std::decay_t<decltype(*field)>, std::string>) {
+            out << field->size() << ':';
+        }
+        out << *field << ';';
+    };
+
+    list("genres", genres);
+    value("min_rating", min_rating);
+    value("max_rating", max_rating);
+    value("min_ratings_count", min_ratings_count);
+    value("year_start", publication_year_start);
+    value("year_end", publication_year_end);
+    value("language", language);
+    value("ebook_only", ebook_only);
+    list("authors", authors);
+    return out.str();
 }
 
 bool BookQueryEngine::passesFilter(const Book& book, const QueryFilter& filter) const {
+    auto taxonomy = std::atomic_load(&taxonomy_);
+    return passesFilter(book, taxonomy->genreSet(book.getGenres()), filter, compileGenreFilter(filter, *taxonomy));
+}
+
+BookQueryEngine::GenreFilter BookQueryEngine::compileGenreFilter(
+    const QueryFilter& filter,
+    const GenreTaxonomy& taxonomy
+) {
+    GenreFilter genre_filter;
     if (filter.genres && !filter.genres->empty()) {
-        bool has_matching_genre = false;
-        for (const auto& genre : book.getGenres()) {
-            if (std::find(filter.genres->begin(), filter.genres->end(), genre) != filter.genres->end()) {
-                has_matching_genre = true;
-                break;
-            }
-        }
+        genre_filter.active = true;
+        genre_filter.accepted = taxonomy.matchSet(*filter.genres, &genre_filter.unknown);
+    }
+    return genre_filter;
+}
+
+bool BookQueryEngine::passesFilter(
+    const Book& book,
+    const GenreSet& book_genres,
+    const QueryFilter& filter,
+    const GenreFilter& genre_filter
+) const {
+    if (genre_filter.active && !book_genres.intersects(genre_filter.accepted)) {
+        // Only genres outside the taxonomy still need a name comparison
+        const auto& unknown = genre_filter.unknown;
+        bool has_matching_genre = !unknown.empty() && std::any_of(
+            book.getGenres().begin(), book.getGenres().end(),
+            [&](const std::string& genre) { return std::find(unknown.begin(), unknown.end(), genre) != unknown.end(); }
+        );
         if (!has_matching_genre) return false;
     }
 
@@ -186,11 +647,11 @@ void BookQueryEngine::rankResults(std::vector<RecommendationResult>& results) co
             const double DIVERSITY_WEIGHT = 0.2;
 
             double a_score = (SIMILARITY_WEIGHT * a.similarity_score) +
-                           (POPULARITY_WEIGHT * a.book.getPopularityScore()) +
+                           (POPULARITY_WEIGHT * a.book->getPopularityScore()) +
                            (DIVERSITY_WEIGHT * diversity_score);
 
             double b_score = (SIMILARITY_WEIGHT * b.similarity_score) +
-                           (POPULARITY_WEIGHT * b.book.getPopularityScore()) +
+                           (POPULARITY_WEIGHT * b.book->getPopularityScore()) +
                            (DIVERSITY_WEIGHT * diversity_score);
 
             return a_score > b_score;
@@ -203,77 +664,67 @@ std::string BookQueryEngine::generateExplanation(
 ) const {
     try {
         auto& groq = GroqClient::getInstance();
-        
-        // Create detailed book info for better context
-        std::ostringstream book_info;
-        book_info << "Title: " << book.getTitle() << "\n"
-                 << "Author: " << book.getAuthor() << "\n"
-                 << "Genres: " << joinStrings(book.getGenres(), ", ") << "\n"
-                 << "Rating: " << book.getAverageRating() << "/5.0 from "
-                 << book.getRatingsCount() << " readers\n"
-                 << "Publication Year: " << book.getPublicationYear() << "\n";
-        
-        if (auto series = book.getSeries()) {
-            book_info << "Series: " << *series << "\n";
-        }
-        
-        book_info << "Description: " << book.getDescription();
-        
-        return groq.generateExplanation(book_info.str(), query);
+        return groq.generateExplanation(describeBook(book), query);
     } catch (const std::exception& e) {
         spdlog::error("Error generating explanation with Groq: {}", e.what());
-        
-        // Fallback to template-based explanation
-        std::ostringstream explanation;
-        explanation << "Recommended because it matches your interest in "
-                   << book.getGenres()[0];
-        
-        if (book.getAverageRating() >= 4.0) {
-            explanation << " and is highly rated with " 
-                       << book.getAverageRating() << "/5.0 from "
-                       << book.getRatingsCount() << " readers";
-        }
-        
-        if (auto series = book.getSeries()) {
-            explanation << ". Part of the " << *series << " series";
-        }
-        
-        return explanation.str();
+        return fallbackExplanation(book);
+    }
+}
+
+std::string BookQueryEngine::describeBook(const Book& book) const {
+    // Create detailed book info for better context
+    std::ostringstream book_info;
+    book_info << "Title: " << book.getTitle() << "\n"
+             << "Author: " << book.getAuthor() << "\n"
+             << "Genres: " << joinStrings(book.getGenres(), ", ") << "\n"
+             << "Rating: " << book.getAverageRating() << "/5.0 from "
+             << book.getRatingsCount() << " readers\n"
+             << "Publication Year: " << book.getPublicationYear() << "\n";
+
+    if (auto series = book.getSeries()) {
+        book_info << "Series: " << *series << "\n";
+    }
+
+    book_info << "Description: " << book.getDescription();
+    return book_info.str();
+}
+
+std::string BookQueryEngine::fallbackExplanation(const Book& book) const {
+    // Template-based explanation for when Groq is unavailable
+    std::ostringstream explanation;
+    explanation << "Recommended because it matches your interest in "
+               << book.getGenres()[0];
+
+    if (book.getAverageRating() >= 4.0) {
+        explanation << " and is highly rated with "
+                   << book.getAverageRating() << "/5.0 from "
+                   << book.getRatingsCount() << " readers";
+    }
+
+    if (auto series = book.getSeries()) {
+        explanation << ". Part of the " << *series << " series";
     }
+
+    return explanation.str();
 }
 
+template <typename SearchResults>
 std::vector<BookQueryEngine::RecommendationResult> BookQueryEngine::processSearchResults(
-    const std::vector<BookVectorStore::SearchResult>& results,
-    const std::string& query,
+    const SearchResults& results,
     const QueryFilter& filter
 ) const {
     std::vector<RecommendationResult> recommendations;
     recommendations.reserve(results.size());
 
+    auto taxonomy = std::atomic_load(&taxonomy_);
+    auto genre_filter = compileGenreFilter(filter, *taxonomy);
     for (const auto& result : results) {
-        Book book(
-            result.document.getId(),
-            result.document.getMetadata().at("title").get<std::string>(),
-            result.document.getMetadata().at("author").get<std::string>(),
-            result.document.getMetadata().at("genres").get<std::vector<std::string>>(),
-            result.document.getText(),
-            result.document.getMetadata().at("page_count").get<int>(),
-            result.document.getMetadata().at("average_rating").get<double>(),
-            result.document.getMetadata().at("ratings_count").get<int>(),
-            result.document.getMetadata().at("review_count").get<int>(),
-            result.document.getSeries(),
-            result.document.getMetadata().at("language").get<std::string>(),
-            result.document.getMetadata().at("publisher").get<std::string>(),
-            result.document.getMetadata().at("publication_date").get<std::string>(),
-            result.document.getMetadata().at("isbn13").get<std::string>(),
-            result.document.getMetadata().at("is_ebook").get<bool>()
-        );
-
-        if (passesFilter(book, filter)) {
+        auto cached = getCachedBook(result.document);
+        if (passesFilter(*cached.book, *cached.genres, filter, genre_filter)) {
             recommendations.push_back({
-                book,
+                std::move(cached.book),
                 result.similarity,
-                generateExplanation(book, query)
+                ""
             });
         }
     }
@@ -281,6 +732,98 @@ std::vector<BookQueryEngine::RecommendationResult> BookQueryEngine::processSearc
     return recommendations;
 }
 
+std::shared_ptr<const Book> BookQueryEngine::getBook(
+    const std::shared_ptr<const Document>& document
+) const {
+    return getCachedBook(document).book;
+}
+
+BookQueryEngine::CachedBook BookQueryEngine::getCachedBook(
+    const std::shared_ptr<const Document>& document
+) const {
+    auto taxonomy = std::atomic_load(&taxonomy_);
+    std::shared_ptr<const Book> book;
+    {
+        std::lock_guard<std::mutex> lock(book_cache_mutex_);
+        auto it = book_cache_.find(document->getId());
+        if (it != book_cache_.end() && it->second.source.lock() == document) {
+            if (it->second.taxonomy == taxonomy) {
+                return it->second;
+            }
+            book = it->second.book;
+        }
+    }
+
+    // Build outside the lock; a concurrent builder for the same document
+    // produces an identical entry, so last writer wins harmlessly
+    if (!book) {
+        book = std::make_shared<const Book>(bookFromDocument(*document));
+    }
+    CachedBook entry{document, book, std::make_shared<const GenreSet>(taxonomy->genreSet(book->getGenres())), taxonomy};
+
+    std::lock_guard<std::mutex> lock(book_cache_mutex_);
+    book_cache_[document->getId()] = entry;
+    return entry;
+}
+
+Book BookQueryEngine::bookFromDocument(const Document& document) {
+    const auto& metadata = document.getMetadata();
+    return Book(
+        document.getId(),
+        metadata.at("title").get<std::string>(),
+        metadata.at("author").get<std::string>(),
+        metadata.at("genres").get<std::vector<std::string>>(),
+        document.getText(),
+        metadata.at("page_count").get<int>(),
+        metadata.at("average_rating").get<double>(),
+        metadata.at("ratings_count").get<int>(),
+        metadata.at("review_count").get<int>(),
+        document.getSeries(),
+        metadata.at("language").get<std::string>(),
+        metadata.at("publisher").get<std::string>(),
+        metadata.at("publication_date").get<std::string>(),
+        metadata.at("isbn13").get<std::string>(),
+        metadata.at("is_ebook").get<bool>()
+    );
+}
+
+bool BookQueryEngine::neighborsFromGraph(
+    const SimilarBooksIndex& index,
+    const std::string& book_id,
+    int top_k,
+    std::pmr::vector<BookVectorStore::SearchResult>& results
+) const {
+    std::vector<SimilarBooksIndex::Neighbor> neighbors;
+    if (!index.lookup(book_id, top_k, neighbors)) {
+        return false;
+    }
+
+    results.reserve(neighbors.size());
+    for (auto& neighbor : neighbors) {
+        // Removed books are invalidated in the index, but the store is the
+        // source of truth for whether a document still exists
+        if (auto document = vector_store_->getDocument(neighbor.doc_id)) {
+            results.push_back({std::move(neighbor.doc_id), neighbor.score, std::move(document)});
+        }
+    }
+    return true;
+}
+
+void BookQueryEngine::addExplanations(
+    std::vector<RecommendationResult>& recommendations,
+    const std::string& query,
+    TaskPriority priority,
+    const std::function<void(size_t index)>& on_explained
+) const {
+    // One Groq round trip per result; issuing them concurrently bounds the
+    // stage by the slowest call instead of the sum of all of them. They
+    // block on the network, so they run on the blocking executor.
+    TaskExecutor::getBlockingInstance().parallelFor(0, recommendations.size(), [&](size_t i) {
+        recommendations[i].explanation = generateExplanation(*recommendations[i].book, query);
+        if (on_explained) on_explained(i);
+    }, priority);
+}
+
 double BookQueryEngine::calculateDiversityScore(
     const std::vector<RecommendationResult>& results
 ) const {
@@ -291,8 +834,8 @@ double BookQueryEngine::calculateDiversityScore(
     std::unordered_set<std::string> unique_authors;
 
     for (const auto& result : results) {
-        unique_authors.insert(result.book.getAuthor());
-        for (const auto& genre : result.book.getGenres()) {
+        unique_authors.insert(result.book->getAuthor());
+        for (const auto& genre : result.book->getGenres()) {
             unique_genres.insert(genre);
         }
     }
@@ -0,0 +1,368 @@
+#include "book_recommender/UserProfileStore.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include "book_recommender/Metrics.hpp"
+#include "book_recommender/Tracing.hpp"
+
+namespace book_recommender {
+
+namespace {
+
+struct ProfileMetrics {
+    Counter& hits;
+    Counter& misses;
+    Counter& rebuilds;
+};
+
+ProfileMetrics& profileMetrics() {
+    auto& registry = MetricsRegistry::getInstance();
+    static ProfileMetrics metrics{
+        registry.counter("book_recommender_profile_cache_lookups_total",
+                         "User profile cache lookups", {{"result", "hit"}}),
+        registry.counter("book_recommender_profile_cache_lookups_total",
+                         "User profile cache lookups", {{"result", "miss"}}),
+        registry.counter("book_recommender_profile_rebuilds_total",
+                         "User profiles clustered from a full reading history")
+    };
+    return metrics;
+}
+
+float dot(const std::vector<float>& a, const std::vector<float>& b) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void normalize(std::vector<float>& v) {
+    float norm = std::sqrt(dot(v, v));
+    if (norm > 0.0f) {
+        for (float& x : v) x /= norm;
+    }
+}
+
+size_t nearest(const std::vector<UserProfile::Interest>& interests, const std::vector<float>& v, float* similarity = nullptr) {
+    size_t best = 0;
+    float best_similarity = -std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < interests.size(); ++i) {
+        float s = dot(interests[i].centroid, v);
+        if (s > best_similarity) {
+            best = i;
+            best_similarity = s;
+        }
+    }
+    if (similarity) *similarity = best_similarity;
+    return best;
+}
+
+// Moves the centroid a `weight / total` step towards v, keeping it the
+// weighted mean of the reads assigned so far
+void pull(UserProfile::Interest& interest, const std::vector<float>& v, float weight) {
+    interest.weight += weight;
+    float rate = weight / interest.weight;
+    for (size_t d = 0; d < v.size(); ++d) {
+        interest.centroid[d] += rate * (v[d] - interest.centroid[d]);
+    }
+}
+
+}
+
+UserProfileStore::UserProfileStore(std::shared_ptr<BookVectorStore> vector_store, const UserProfileConfig& config)
+    : vector_store_(std::move(vector_store)),
+      config_(config) {
+    if (config_.max_interests == 0) {
+        throw std::invalid_argument("Profiles need at least one interest");
+    }
+    config_.min_reads_per_interest = std::max<size_t>(config_.min_reads_per_interest, 1);
+    config_.kmeans_batch_size = std::max<size_t>(config_.kmeans_batch_size, 1);
+}
+
+void UserProfileStore::setHistoryLoader(HistoryLoader loader) {
+    loader_ = std::move(loader);
+}
+
+std::shared_ptr<const UserProfile> UserProfileStore::setHistory(
+    const std::string& user_id,
+    const std::vector<ReadEvent>& history
+) {
+    return store(user_id, buildProfile(history));
+}
+
+std::shared_ptr<const UserProfile> UserProfileStore::recordRead(const std::string& user_id, const ReadEvent& read) {
+    auto current = getProfile(user_id);
+    if (current && current->read_books.count(read.book_id)) {
+        return current;
+    }
+    auto vector = read.weight > 0 ? bookVector(read.book_id) : std::vector<float>{};
+
+    auto& shard = shardFor(user_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.profiles.find(user_id);
+    auto profile = it != shard.profiles.end()
+        ? std::make_shared<UserProfile>(*it->second.profile)
+        : std::make_shared<UserProfile>();
+    if (!profile->read_books.insert(read.book_id).second) {
+        return it->second.profile;
+    }
+
+    if (!vector.empty()) {
+        float similarity = 0.0f;
+        size_t closest = profile->interests.empty() ? 0 : nearest(profile->interests, vector, &similarity);
+        bool room = profile->interests.size() < config_.max_interests &&
+                    profile->read_books.size() > config_.min_reads_per_interest * profile->interests.size();
+        if (profile->interests.empty() || (room && similarity < config_.new_interest_threshold)) {
+            profile->interests.push_back({std::move(vector), read.weight});
+        } else {
+            auto& interest = profile->interests[closest];
+            pull(interest, vector, read.weight);
+            normalize(interest.centroid);
+        }
+    }
+    profile->version = next_version_.fetch_add(1, std::memory_order_relaxed);
+    return publishLocked(shard, user_id, std::move(profile));
+}
+
+std::shared_ptr<const UserProfile> UserProfileStore::getProfile(const std::string& user_id) {
+    if (auto profile = cached(user_id)) {
+        profileMetrics().hits.increment();
+        return profile;
+    }
+    profileMetrics().misses.increment();
+    if (!loader_) {
+        return nullptr;
+    }
+
+    // Built without holding the shard lock; if another thread published a
+    // profile meanwhile, that one wins
+    auto history = loader_(user_id);
+    if (history.empty()) {
+        return nullptr;
+    }
+    return store(user_id, buildProfile(history), true);
+}
+
+void UserProfileStore::removeProfile(const std::string& user_id) {
+    auto& shard = shardFor(user_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.profiles.find(user_id);
+    if (it != shard.profiles.end()) {
+        shard.lru.erase(it->second.lru_position);
+        shard.profiles.erase(it);
+    }
+}
+
+size_t UserProfileStore::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.profiles.size();
+    }
+    return total;
+}
+
+std::vector<BookVectorStore::SearchResult> UserProfileStore::search(const UserProfile& profile, int top_k) const {
+    if (profile.interests.empty() || top_k <= 0) return {};
+
+    Span span("UserProfileStore.search");
+    span.setAttribute("interests", profile.interests.size());
+    span.setAttribute("read_books", profile.read_books.size());
+
+    std::vector<std::vector<float>> queries;
+    queries.reserve(profile.interests.size());
+    float total_weight = 0.0f;
+    for (const auto& interest : profile.interests) {
+        queries.push_back(interest.centroid);
+        total_weight += interest.weight;
+    }
+    auto per_interest = vector_store_->batchSearchExcluding(queries, profile.read_books, top_k);
+
+    // Largest-remainder apportionment of the result slots by interest weight
+    size_t slots = static_cast<size_t>(top_k);
+    std::vector<size_t> quota(per_interest.size(), 0);
+    std::vector<std::pair<float, size_t>> remainders;
+    size_t assigned = 0;
+    for (size_t i = 0; i < per_interest.size(); ++i) {
+        float share = total_weight > 0 ? slots * profile.interests[i].weight / total_weight
+                                       : static_cast<float>(slots) / per_interest.size();
+        quota[i] = static_cast<size_t>(share);
+        assigned += quota[i];
+        remainders.emplace_back(share - quota[i], i);
+    }
+    std::sort(remainders.begin(), remainders.end(), std::greater<>());
+    for (size_t r = 0; assigned < slots && r < remainders.size(); ++r, ++assigned) {
+        ++quota[remainders[r].second];
+    }
+
+    std::vector<BookVectorStore::SearchResult> results;
+    results.reserve(slots);
+    std::unordered_set<std::string> taken;
+    std::vector<BookVectorStore::SearchResult> leftovers;
+    for (size_t i = 0; i < per_interest.size(); ++i) {
+        size_t used = 0;
+        for (auto& result : per_interest[i]) {
+            if (taken.count(result.doc_id)) continue;
+            if (used < quota[i]) {
+                taken.insert(result.doc_id);
+                results.push_back(std::move(result));
+                ++used;
+            } else {
+                leftovers.push_back(std::move(result));
+            }
+        }
+    }
+
+    // Slots an interest could not fill (it ran out of unread books, or its
+    // best books were already taken) go to the best remaining matches
+    std::sort(leftovers.begin(), leftovers.end(),
+              [](const auto& a, const auto& b) { return a.similarity > b.similarity; });
+    for (auto& result : leftovers) {
+        if (results.size() >= slots) break;
+        if (taken.insert(result.doc_id).second) {
+            results.push_back(std::move(result));
+        }
+    }
+
+    span.setAttribute("result_count", results.size());
+    return results;
+}
+
+UserProfileStore::Shard& UserProfileStore::shardFor(const std::string& user_id) {
+    return shards_[std::hash<std::string>{}(user_id) % SHARD_COUNT];
+}
+
+std::shared_ptr<const UserProfile> UserProfileStore::cached(const std::string& user_id) {
+    auto& shard = shardFor(user_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.profiles.find(user_id);
+    if (it == shard.profiles.end()) {
+        return nullptr;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru_position);
+    return it->second.profile;
+}
+
+std::shared_ptr<const UserProfile> UserProfileStore::store(
+    const std::string& user_id,
+    std::shared_ptr<UserProfile> profile,
+    bool only_if_absent
+) {
+    profile->version = next_version_.fetch_add(1, std::memory_order_relaxed);
+
+    auto& shard = shardFor(user_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (only_if_absent) {
+        auto it = shard.profiles.find(user_id);
+        if (it != shard.profiles.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru_position);
+            return it->second.profile;
+        }
+    }
+    return publishLocked(shard, user_id, std::move(profile));
+}
+
+std::shared_ptr<const UserProfile> UserProfileStore::publishLocked(
+    Shard& shard,
+    const std::string& user_id,
+    std::shared_ptr<const UserProfile> profile
+) {
+    auto it = shard.profiles.find(user_id);
+    if (it != shard.profiles.end()) {
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru_position);
+        it->second.profile = std::move(profile);
+        return it->second.profile;
+    }
+
+    size_t capacity = std::max<size_t>(1, config_.max_profiles / SHARD_COUNT);
+    while (shard.profiles.size() >= capacity) {
+        shard.profiles.erase(shard.lru.back());
+        shard.lru.pop_back();
+    }
+    shard.lru.push_front(user_id);
+    auto& entry = shard.profiles[user_id];
+    entry = Entry{std::move(profile), shard.lru.begin()};
+    return entry.profile;
+}
+
+std::shared_ptr<UserProfile> UserProfileStore::buildProfile(const std::vector<ReadEvent>& history) const {
+    profileMetrics().rebuilds.increment();
+    auto profile = std::make_shared<UserProfile>();
+
+    std::vector<std::vector<float>> points;
+    std::vector<float> weights;
+    for (const auto& read : history) {
+        if (!profile->read_books.insert(read.book_id).second || read.weight <= 0) continue;
+        auto vector = bookVector(read.book_id);
+        if (vector.empty()) continue;
+        points.push_back(std::move(vector));
+        weights.push_back(read.weight);
+    }
+    if (points.empty()) return profile;
+
+    size_t k = std::clamp<size_t>(points.size() / config_.min_reads_per_interest, 1, config_.max_interests);
+
+    // Farthest-first seeding from the heaviest read: deterministic, and
+    // spreads the seeds across distinct interests
+    auto& interests = profile->interests;
+    size_t seed = std::max_element(weights.begin(), weights.end()) - weights.begin();
+    interests.push_back({points[seed], 0.0f});
+    std::vector<float> closest(points.size(), std::numeric_limits<float>::infinity());
+    while (interests.size() < k) {
+        size_t farthest = 0;
+        for (size_t p = 0; p < points.size(); ++p) {
+            closest[p] = std::min(closest[p], 1.0f - dot(points[p], interests.back().centroid));
+            if (closest[p] > closest[farthest]) farthest = p;
+        }
+        if (closest[farthest] <= 0.0f) break;  // fewer distinct books than clusters
+        interests.push_back({points[farthest], 0.0f});
+    }
+
+    // Mini-batch k-means (Sculley, 2010): each sampled read pulls its nearest
+    // centroid by weight / (weight seen by that centroid so far), so early
+    // batches move centroids far and later ones fine-tune them
+    if (interests.size() > 1) {
+        std::mt19937 rng(static_cast<uint32_t>(points.size()));
+        std::uniform_int_distribution<size_t> pick(0, points.size() - 1);
+        size_t batch = std::min(config_.kmeans_batch_size, points.size());
+        std::vector<size_t> samples(batch);
+        std::vector<size_t> assignment(batch);
+        for (size_t iteration = 0; iteration < config_.kmeans_iterations; ++iteration) {
+            for (size_t b = 0; b < batch; ++b) {
+                samples[b] = pick(rng);
+                assignment[b] = nearest(interests, points[samples[b]]);
+            }
+            for (size_t b = 0; b < batch; ++b) {
+                pull(interests[assignment[b]], points[samples[b]], weights[samples[b]]);
+            }
+        }
+    }
+
+    // Final weights are the reads each interest actually holds
+    std::vector<UserProfile::Interest> assigned(interests.size());
+    for (size_t i = 0; i < interests.size(); ++i) {
+        assigned[i].centroid.assign(points.front().size(), 0.0f);
+    }
+    for (size_t p = 0; p < points.size(); ++p) {
+        pull(assigned[nearest(interests, points[p])], points[p], weights[p]);
+    }
+    interests.clear();
+    for (auto& interest : assigned) {
+        if (interest.weight <= 0.0f) continue;
+        normalize(interest.centroid);
+        interests.push_back(std::move(interest));
+    }
+    return profile;
+}
+
+std::vector<float> UserProfileStore::bookVector(const std::string& book_id) const {
+    std::vector<float> vector(static_cast<size_t>(vector_store_->dimension()));
+    if (!vector_store_->getVector(book_id, vector.data())) {
+        return {};
+    }
+    normalize(vector);
+    return vector;
+}
+
+}
@@ -0,0 +1,375 @@
+#include "book_recommender/HttpServer.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <mutex>
+#include <cpprest/http_listener.h>
+#include <cpprest/producerconsumerstream.h>
+#include <spdlog/spdlog.h>
+#include "book_recommender/ConcurrencyLimiter.hpp"
+#include "book_recommender/Metrics.hpp"
+#include "book_recommender/Tracing.hpp"
+#ifdef HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace book_recommender {
+
+namespace {
+
+using web::http::http_request;
+using web::http::http_response;
+
+struct ServerMetrics {
+    Counter& shed;
+    Counter& compressed;
+    Gauge& queue_depth;
+    Histogram& latency;
+};
+
+ServerMetrics& serverMetrics() {
+    auto& registry = MetricsRegistry::getInstance();
+    static ServerMetrics metrics{
+        registry.counter("book_recommender_http_shed_total",
+                         "Requests rejected because the worker queue was full"),
+        registry.counter("book_recommender_http_compressed_responses_total",
+                         "Responses sent gzip-encoded"),
+        registry.gauge("book_recommender_http_queue_depth",
+                       "Requests waiting for a worker"),
+        registry.histogram("book_recommender_http_request_duration_seconds",
+                           "Time from accepting a request to handing back its response")
+    };
+    return metrics;
+}
+
+Counter& responseCounter(int status) {
+    return MetricsRegistry::getInstance().counter(
+        "book_recommender_http_responses_total", "HTTP responses by status code",
+        {{"code", std::to_string(status)}});
+}
+
+// split_query leaves escapes alone, and form encoding spells spaces as '+'
+std::string decodeComponent(std::string component) {
+    for (auto& c : component) {
+        if (c == '+') c = ' ';
+    }
+    return web::uri::decode(component);
+}
+
+HttpRequest parseRequest(const http_request& request) {
+    HttpRequest parsed;
+    parsed.method = request.method();
+    auto uri = request.relative_uri();
+    parsed.path = web::uri::decode(uri.path());
+    for (const auto& [key, value] : web::uri::split_query(uri.query())) {
+        parsed.params[decodeComponent(key)] = decodeComponent(value);
+    }
+    if (parsed.method != web::http::methods::GET) {
+        parsed.body = request.extract_string().get();
+    }
+    return parsed;
+}
+
+std::string trimmed(const std::string& text) {
+    auto begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) return "";
+    auto end = text.find_last_not_of(" \t");
+    return text.substr(begin, end - begin + 1);
+}
+
+// True if Accept-Encoding lists gzip, or failing that "*", with a nonzero
+// q-value; "gzip;q=0" refuses it
+bool acceptsGzip(const http_request& request) {
+    std::string encodings;
+    if (!request.headers().match("Accept-Encoding", encodings)) return false;
+
+    std::optional<double> gzip_q;
+    std::optional<double> any_q;
+    std::istringstream items(encodings);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        auto semicolon = item.find(';');
+        auto coding = trimmed(item.substr(0, semicolon));
+        std::transform(coding.begin(), coding.end(), coding.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        double q = 1.0;
+        while (semicolon != std::string::npos) {
+            auto next = item.find(';', semicolon + 1);
+            auto param = trimmed(item.substr(semicolon + 1, next == std::string::npos ? next : next - semicolon - 1));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                q = std::strtod(param.c_str() + 2, nullptr);
+            }
+            semicolon = next;
+        }
+
+        if (coding == "gzip" || coding == "x-gzip") {
+            gzip_q = std::max(gzip_q.value_or(0.0), q);
+        } else if (coding == "*") {
+            any_q = q;
+        }
+    }
+    return gzip_q ? *gzip_q > 0 : any_q.value_or(0.0) > 0;
+}
+
+#ifdef HAS_ZLIB
+std::vector<unsigned char> gzipCompress(const std::string& input) {
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("Cannot initialize gzip stream");
+    }
+    std::vector<unsigned char> output(deflateBound(&stream, static_cast<uLong>(input.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = output.data();
+    stream.avail_out = static_cast<uInt>(output.size());
+    int result = deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        throw std::runtime_error("gzip compression failed");
+    }
+    return output;
+}
+#endif
+
+// Failures here mean the client went away; nothing is left to tell it
+void send(const http_request& request, const http_response& response) {
+    request.reply(response).then([](pplx::task<void> sent) {
+        try {
+            sent.get();
+        } catch (const std::exception& e) {
+            spdlog::debug("Failed to send response: {}", e.what());
+        }
+    });
+}
+
+http_response toResponse(HttpResponse response, bool gzip, size_t gzip_min_bytes) {
+    http_response reply(static_cast<web::http::status_code>(response.status));
+    if (response.retry_after_seconds > 0) {
+        reply.headers().add("Retry-After", std::to_string(response.retry_after_seconds));
+    }
+#ifdef HAS_ZLIB
+    if (gzip && response.body.size() >= gzip_min_bytes) {
+        reply.set_body(gzipCompress(response.body));
+        reply.headers().set_content_type(response.content_type);
+        reply.headers().add("Content-Encoding", "gzip");
+        reply.headers().add("Vary", "Accept-Encoding");
+        serverMetrics().compressed.increment();
+        return reply;
+    }
+#else
+    (void)gzip;
+    (void)gzip_min_bytes;
+#endif
+    reply.set_body(std::move(response.body), response.content_type);
+    return reply;
+}
+
+// Event stream backed by a producer/consumer buffer: the listener sends the
+// response body from the buffer while handlers keep appending to it.
+// Streams are never compressed.
+class EventStream : public HttpEventStream {
+public:
+    explicit EventStream(const http_request& request) : request_(request) {}
+
+    void send(const std::string& event, const std::string& data) override {
+        std::string frame = "event: " + event + "\ndata: " + data + "\n\n";
+        std::lock_guard<std::mutex> lock(mutex_);
+        open();
+        buffer_.putn_nocopy(reinterpret_cast<const uint8_t*>(frame.data()), frame.size()).wait();
+        buffer_.sync().wait();
+    }
+
+    bool started() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return started_;
+    }
+
+    // Ends the response; sends the headers first if no event went out
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open();
+        buffer_.close(std::ios_base::out).wait();
+    }
+
+private:
+    http_request request_;
+    concurrency::streams::producer_consumer_buffer<uint8_t> buffer_;
+    mutable std::mutex mutex_;
+    bool started_ = false;
+
+    void open() {
+        if (started_) return;
+        started_ = true;
+        http_response reply(web::http::status_codes::OK);
+        reply.headers().add("Cache-Control", "no-cache");
+        reply.set_body(buffer_.create_istream(), "text/event-stream");
+        book_recommender::send(request_, reply);
+    }
+};
+
+}
+
+std::string HttpRequest::param(const std::string& name, const std::string& fallback) const {
+    auto it = params.find(name);
+    return it == params.end() ? fallback : it->second;
+}
+
+HttpResponse HttpResponse::json(const nlohmann::json& body, int status) {
+    HttpResponse response;
+    response.status = status;
+    response.body = body.dump();
+    return response;
+}
+
+HttpResponse HttpResponse::error(int status, const std::string& message) {
+    return json({{"error", message}}, status);
+}
+
+HttpServer::HttpServer(const HttpServerConfig& config) : config_(config) {
+    if (config_.port < 0 || config_.port > 65535) {
+        throw std::invalid_argument("HTTP port out of range");
+    }
+    if (config_.max_queued_requests == 0) {
+        throw std::invalid_argument("HTTP request queue must hold at least one request");
+    }
+}
+
+HttpServer::~HttpServer() {
+    try {
+        stop();
+    } catch (const std::exception& e) {
+        spdlog::error("Error stopping HTTP server: {}", e.what());
+    }
+}
+
+void HttpServer::route(const std::string& method, const std::string& path, HttpHandler handler) {
+    if (listener_) {
+        throw std::logic_error("Routes must be registered before the server starts");
+    }
+    routes_[method + " " + path] = std::move(handler);
+}
+
+void HttpServer::streamRoute(const std::string& method, const std::string& path, HttpStreamHandler handler) {
+    if (listener_) {
+        throw std::logic_error("Routes must be registered before the server starts");
+    }
+    stream_routes_[method + " " + path] = std::move(handler);
+}
+
+void HttpServer::start() {
+    if (listener_) return;
+
+    workers_ = std::make_unique<WorkerPool>(config_.worker_threads, config_.max_queued_requests);
+
+    web::http::experimental::listener::http_listener_config listener_config;
+    listener_config.set_timeout(std::chrono::seconds(config_.request_timeout_seconds));
+    listener_ = std::make_unique<web::http::experimental::listener::http_listener>(
+        web::uri(url()), listener_config);
+    listener_->support([this](http_request request) { dispatch(request); });
+    listener_->open().wait();
+
+    spdlog::info("Serving on {} with {} workers, queue limit {}",
+                 url(), workers_->threadCount(), config_.max_queued_requests);
+}
+
+void HttpServer::stop() {
+    if (!listener_) return;
+    listener_->close().wait();
+    workers_->shutdown();
+    listener_.reset();
+    workers_.reset();
+    spdlog::info("HTTP server on {} stopped", url());
+}
+
+std::string HttpServer::url() const {
+    return "http://" + config_.address + ":" + std::to_string(config_.port);
+}
+
+// Runs on the listener's I/O threads, so it only decides whether the
+// request gets a worker; everything else happens in serve()
+void HttpServer::dispatch(const http_request& request) {
+    auto& metrics = serverMetrics();
+    auto accepted = std::chrono::steady_clock::now();
+    if (!workers_->trySubmit([this, request, accepted] { serve(request, accepted); })) {
+        metrics.shed.increment();
+        responseCounter(503).increment();
+        http_response reply(web::http::status_codes::ServiceUnavailable);
+        reply.headers().add("Retry-After", "1");
+        reply.set_body(HttpResponse::error(503, "Server overloaded").body, "application/json");
+        send(request, reply);
+        return;
+    }
+    metrics.queue_depth.set(static_cast<int64_t>(workers_->queueDepth()));
+}
+
+void HttpServer::serve(const http_request& request, std::chrono::steady_clock::time_point accepted) const {
+    auto& metrics = serverMetrics();
+    metrics.queue_depth.set(static_cast<int64_t>(workers_->queueDepth()));
+
+    Span span("http.request");
+    HttpResponse response;
+    bool streamed = false;
+    try {
+        HttpRequest parsed = parseRequest(request);
+        span.setAttribute("method", parsed.method);
+        span.setAttribute("path", parsed.path);
+
+        auto key = parsed.method + " " + parsed.path;
+        auto route = routes_.find(key);
+        auto stream_route = stream_routes_.find(key);
+        if (route != routes_.end()) {
+            response = route->second(parsed);
+        } else if (stream_route != stream_routes_.end()) {
+            serveStream(request, parsed, stream_route->second);
+            streamed = true;
+        } else {
+            response = HttpResponse::error(404, "No route for " + parsed.method + " " + parsed.path);
+        }
+    } catch (const std::invalid_argument& e) {
+        response = HttpResponse::error(400, e.what());
+    } catch (const OverloadError& e) {
+        response = HttpResponse::error(503, "Server overloaded");
+        auto retry_after = std::chrono::ceil<std::chrono::seconds>(e.retryAfter());
+        response.retry_after_seconds = std::max(1, static_cast<int>(retry_after.count()));
+    } catch (const std::exception& e) {
+        spdlog::error("Error serving {}: {}", request.relative_uri().to_string(), e.what());
+        span.setError(e.what());
+        response = HttpResponse::error(500, "Internal error");
+    }
+
+    span.setAttribute("status", response.status);
+    responseCounter(response.status).increment();
+    if (!streamed) {
+        try {
+            send(request, toResponse(std::move(response), acceptsGzip(request), config_.gzip_min_bytes));
+        } catch (const std::exception& e) {
+            spdlog::error("Error encoding response: {}", e.what());
+            send(request, http_response(web::http::status_codes::InternalError));
+        }
+    }
+    metrics.latency.record(std::chrono::steady_clock::now() - accepted);
+}
+
+void HttpServer::serveStream(
+    const http_request& request,
+    const HttpRequest& parsed,
+    const HttpStreamHandler& handler
+) const {
+    EventStream stream(request);
+    try {
+        handler(parsed, stream);
+    } catch (const std::exception& e) {
+        if (!stream.started()) throw;
+        spdlog::error("Error streaming {}: {}", parsed.path, e.what());
+        stream.send("error", nlohmann::json{{"error", "Internal error"}}.dump());
+    }
+    stream.close();
+}
+
+}
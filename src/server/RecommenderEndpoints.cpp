@@ -0,0 +1,215 @@
+#include "book_recommender/RecommenderEndpoints.hpp"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include "book_recommender/Metrics.hpp"
+
+namespace book_recommender {
+
+namespace {
+
+constexpr int MAX_TOP_K = 100;
+
+using QueryFilter = BookQueryEngine::QueryFilter;
+using RecommendationResult = BookQueryEngine::RecommendationResult;
+
+// Bad parameters surface as std::invalid_argument, which the server turns
+// into a 400
+template <typename T, typename Parse>
+T parseParam(const std::string& name, const std::string& value, Parse parse) {
+    try {
+        size_t consumed = 0;
+        T parsed = parse(value, &consumed);
+        if (consumed != value.size()) {
+            throw std::invalid_argument(value);
+        }
+        return parsed;
+    } catch (const std::logic_error&) {
+        throw std::invalid_argument("Invalid value for " + name + ": " + value);
+    }
+}
+
+int intParam(const HttpRequest& request, const std::string& name, int fallback) {
+    auto value = request.param(name);
+    if (value.empty()) return fallback;
+    return parseParam<int>(name, value, [](const std::string& s, size_t* end) { return std::stoi(s, end); });
+}
+
+std::optional<int> optionalInt(const HttpRequest& request, const std::string& name) {
+    if (request.param(name).empty()) return std::nullopt;
+    return intParam(request, name, 0);
+}
+
+std::optional<double> optionalDouble(const HttpRequest& request, const std::string& name) {
+    auto value = request.param(name);
+    if (value.empty()) return std::nullopt;
+    return parseParam<double>(name, value, [](const std::string& s, size_t* end) { return std::stod(s, end); });
+}
+
+std::optional<std::vector<std::string>> optionalList(const HttpRequest& request, const std::string& name) {
+    auto value = request.param(name);
+    if (value.empty()) return std::nullopt;
+
+    std::vector<std::string> items;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+std::string requiredParam(const HttpRequest& request, const std::string& name) {
+    auto value = request.param(name);
+    if (value.empty()) {
+        throw std::invalid_argument("Missing parameter: " + name);
+    }
+    return value;
+}
+
+int topK(const HttpRequest& request) {
+    return std::clamp(intParam(request, "top_k", 5), 1, MAX_TOP_K);
+}
+
+QueryFilter parseFilter(const HttpRequest& request) {
+    QueryFilter filter;
+    filter.genres = optionalList(request, "genres");
+    filter.authors = optionalList(request, "authors");
+    filter.min_rating = optionalDouble(request, "min_rating");
+    filter.max_rating = optionalDouble(request, "max_rating");
+    filter.min_ratings_count = optionalInt(request, "min_ratings_count");
+    filter.publication_year_start = optionalInt(request, "year_start");
+    filter.publication_year_end = optionalInt(request, "year_end");
+    if (!request.param("language").empty()) {
+        filter.language = request.param("language");
+    }
+    if (!request.param("ebook_only").empty()) {
+        filter.ebook_only = request.param("ebook_only") == "true" || request.param("ebook_only") == "1";
+    }
+    return filter;
+}
+
+nlohmann::json resultsJson(const std::vector<RecommendationResult>& results) {
+    nlohmann::json body = nlohmann::json::array();
+    for (const auto& result : results) {
+        body.push_back({
+            {"book", result.book->toJson()},
+            {"similarity", result.similarity_score},
+            {"explanation", result.explanation}
+        });
+    }
+    return body;
+}
+
+HttpResponse recommendations(const std::vector<RecommendationResult>& results) {
+    return HttpResponse::json({{"results", resultsJson(results)}});
+}
+
+}
+
+void registerRecommenderEndpoints(HttpServer& server, BookRecommender& recommender) {
+    const std::string GET = "GET";
+    const std::string POST = "POST";
+
+    server.route(GET, "/recommend", [&recommender](const HttpRequest& request) {
+        auto query = requiredParam(request, "q");
+        return recommendations(recommender.getRecommendations(query, parseFilter(request), topK(request)));
+    });
+
+    // Same answer as /recommend as server-sent events: "results" once the
+    // books are ranked, one "explanation" per book as it arrives, then "done"
+    server.streamRoute(GET, "/recommend/stream", [&recommender](const HttpRequest& request, HttpEventStream& events) {
+        auto query = requiredParam(request, "q");
+        bool delivered = false;
+        BookQueryEngine::RecommendationStream stream;
+        stream.on_results = [&](const std::vector<RecommendationResult>& results) {
+            delivered = true;
+            events.send("results", nlohmann::json{{"results", resultsJson(results)}}.dump());
+        };
+        stream.on_explanation = [&](size_t index, const RecommendationResult& result) {
+            events.send("explanation", nlohmann::json{
+                {"index", index},
+                {"book_id", result.book->getId()},
+                {"explanation", result.explanation}
+            }.dump());
+        };
+
+        auto results = recommender.streamRecommendations(query, stream, parseFilter(request), topK(request));
+        if (!delivered) {
+            // The query failed before ranking; the client still gets a
+            // (possibly empty) result list
+            events.send("results", nlohmann::json{{"results", resultsJson(results)}}.dump());
+        }
+        events.send("done", "{}");
+    });
+
+    server.route(GET, "/similar", [&recommender](const HttpRequest& request) {
+        auto book_id = requiredParam(request, "id");
+        return recommendations(recommender.getSimilarBooks(book_id, parseFilter(request), topK(request)));
+    });
+
+    server.route(GET, "/personalized", [&recommender](const HttpRequest& request) {
+        auto user_id = requiredParam(request, "user");
+        return recommendations(recommender.getPersonalizedRecommendations(user_id, parseFilter(request), topK(request)));
+    });
+
+    server.route(POST, "/reads", [&recommender](const HttpRequest& request) {
+        auto user_id = requiredParam(request, "user");
+        auto book_id = requiredParam(request, "book");
+        auto weight = optionalDouble(request, "weight").value_or(1.0);
+        recommender.recordRead(user_id, book_id, static_cast<float>(weight));
+        return HttpResponse::json({{"status", "ok"}});
+    });
+
+    server.route(GET, "/author", [&recommender](const HttpRequest& request) {
+        auto author = requiredParam(request, "name");
+        return recommendations(recommender.getAuthorRecommendations(author, parseFilter(request), topK(request)));
+    });
+
+    server.route(GET, "/series", [&recommender](const HttpRequest& request) {
+        auto series = requiredParam(request, "name");
+        return recommendations(recommender.getSeriesRecommendations(series, parseFilter(request), topK(request)));
+    });
+
+    server.route(GET, "/search", [&recommender](const HttpRequest& request) {
+        auto query = requiredParam(request, "q");
+        nlohmann::json body = nlohmann::json::array();
+        for (const auto& book : recommender.searchBooks(query, parseFilter(request))) {
+            body.push_back(book->toJson());
+        }
+        return HttpResponse::json({{"results", std::move(body)}});
+    });
+
+    server.route(GET, "/popular", [&recommender](const HttpRequest& request) {
+        auto kind = request.param("kind", "genres");
+        int limit = std::clamp(intParam(request, "limit", 10), 1, MAX_TOP_K);
+
+        if (kind == "genres") {
+            return HttpResponse::json({{"results", recommender.getPopularGenres(limit)}});
+        }
+        if (kind == "authors") {
+            return HttpResponse::json({{"results", recommender.getPopularAuthors(limit)}});
+        }
+        if (kind == "books") {
+            nlohmann::json body = nlohmann::json::array();
+            for (const auto& book : recommender.getTopRatedBooks(limit)) {
+                body.push_back(book.toJson());
+            }
+            return HttpResponse::json({{"results", std::move(body)}});
+        }
+        throw std::invalid_argument("Unknown popular kind: " + kind);
+    });
+
+    server.route(GET, "/metrics", [](const HttpRequest&) {
+        HttpResponse response;
+        response.body = MetricsRegistry::getInstance().scrapePrometheus();
+        response.content_type = "text/plain; version=0.0.4";
+        return response;
+    });
+
+    server.route(GET, "/healthz", [](const HttpRequest&) {
+        return HttpResponse::json({{"status", "ok"}});
+    });
+}
+
+}
@@ -0,0 +1,80 @@
+// Replacement global allocation functions, compiled in only when
+// BOOK_RECOMMENDER_TRACK_ALLOCATIONS is enabled. They forward to malloc and
+// bump the per-thread counters read by AllocationScope.
+
+#include "book_recommender/AllocationTracking.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace book_recommender {
+
+// Defined here so that linking anything that asks whether tracking is on
+// also pulls these hooks out of the static library
+bool AllocationScope::isTrackingEnabled() {
+    return true;
+}
+
+}
+
+namespace {
+
+void* trackedAllocate(std::size_t size) {
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p) book_recommender::detail::recordAllocation(size);
+    return p;
+}
+
+void* trackedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+    auto align = static_cast<std::size_t>(alignment);
+    std::size_t rounded = ((size == 0 ? 1 : size) + align - 1) / align * align;
+    void* p = std::aligned_alloc(align, rounded);
+    if (p) book_recommender::detail::recordAllocation(size);
+    return p;
+}
+
+void trackedFree(void* p) noexcept {
+    if (!p) return;
+    book_recommender::detail::recordDeallocation();
+    std::free(p);
+}
+
+}
+
+void* operator new(std::size_t size) {
+    if (void* p = trackedAllocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* p = trackedAllocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* p = trackedAllocateAligned(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    if (void* p = trackedAllocateAligned(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { trackedFree(p); }
+void operator delete[](void* p) noexcept { trackedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { trackedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { trackedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { trackedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { trackedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { trackedFree(p); }
@@ -0,0 +1,153 @@
+#include "book_recommender/AllocationTracking.hpp"
+#include <utility>
+
+namespace book_recommender {
+
+namespace {
+
+// Plain constant-initialized TLS: the hooks run inside operator new and
+// must not trigger dynamic TLS initialization or allocate themselves
+thread_local uint64_t thread_allocations = 0;
+thread_local uint64_t thread_deallocations = 0;
+thread_local uint64_t thread_bytes = 0;
+
+}
+
+namespace detail {
+
+// Allocations charged to a scope from other threads. Accounts chain to the
+// scope that was open when theirs began, so outer scopes see them too.
+struct AllocationAccount {
+    std::shared_ptr<AllocationAccount> parent;
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> deallocations{0};
+    std::atomic<uint64_t> bytes{0};
+};
+
+}
+
+namespace {
+
+// Innermost open scope's account on this thread (never touched by the hooks)
+thread_local std::shared_ptr<detail::AllocationAccount> current_account;
+
+AllocationStats difference(const AllocationStats& now, const AllocationStats& start) {
+    return {
+        now.allocations - start.allocations,
+        now.deallocations - start.deallocations,
+        now.bytes - start.bytes
+    };
+}
+
+bool isOpenOnThisThread(const detail::AllocationAccount* account) {
+    for (auto* open = current_account.get(); open; open = open->parent.get()) {
+        if (open == account) return true;
+    }
+    return false;
+}
+
+}
+
+namespace detail {
+
+AllocationStats threadAllocationTotals() {
+    return {thread_allocations, thread_deallocations, thread_bytes};
+}
+
+void recordAllocation(size_t bytes) noexcept {
+    ++thread_allocations;
+    thread_bytes += bytes;
+}
+
+void recordDeallocation() noexcept {
+    ++thread_deallocations;
+}
+
+}
+
+#ifndef BOOK_RECOMMENDER_TRACK_ALLOCATIONS
+bool AllocationScope::isTrackingEnabled() {
+    return false;
+}
+#endif
+
+// The account is created before the snapshot so its own allocation is not
+// counted
+AllocationScope::AllocationScope()
+    : account_(isTrackingEnabled() ? std::make_shared<detail::AllocationAccount>() : nullptr),
+      start_(detail::threadAllocationTotals()) {
+    if (account_) {
+        account_->parent = current_account;
+        previous_ = std::exchange(current_account, account_);
+    }
+}
+
+AllocationScope::~AllocationScope() {
+    if (account_) {
+        current_account = std::move(previous_);
+    }
+}
+
+AllocationStats AllocationScope::stats() const {
+    auto stats = difference(detail::threadAllocationTotals(), start_);
+    if (account_) {
+        stats.allocations += account_->allocations.load(std::memory_order_relaxed);
+        stats.deallocations += account_->deallocations.load(std::memory_order_relaxed);
+        stats.bytes += account_->bytes.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+AllocationContext AllocationContext::current() {
+    AllocationContext context;
+    context.account_ = current_account;
+    return context;
+}
+
+ScopedAllocationContext::ScopedAllocationContext(AllocationContext context)
+    : start_(detail::threadAllocationTotals()) {
+    if (context.account_ && !isOpenOnThisThread(context.account_.get())) {
+        account_ = std::move(context.account_);
+        previous_ = std::exchange(current_account, account_);
+    }
+}
+
+ScopedAllocationContext::~ScopedAllocationContext() {
+    if (!account_) return;
+
+    auto stats = difference(detail::threadAllocationTotals(), start_);
+    for (auto* account = account_.get(); account; account = account->parent.get()) {
+        account->allocations.fetch_add(stats.allocations, std::memory_order_relaxed);
+        account->deallocations.fetch_add(stats.deallocations, std::memory_order_relaxed);
+        account->bytes.fetch_add(stats.bytes, std::memory_order_relaxed);
+    }
+    current_account = std::move(previous_);
+}
+
+AllocationStats CountingMemoryResource::stats() const {
+    return {
+        allocations_.load(std::memory_order_relaxed),
+        deallocations_.load(std::memory_order_relaxed),
+        bytes_.load(std::memory_order_relaxed)
+    };
+}
+
+void* CountingMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+    void* p = upstream_->allocate(bytes, alignment);
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    bytes_in_use_.fetch_add(bytes, std::memory_order_relaxed);
+    return p;
+}
+
+void CountingMemoryResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    upstream_->deallocate(p, bytes, alignment);
+    deallocations_.fetch_add(1, std::memory_order_relaxed);
+    bytes_in_use_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+bool CountingMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+}
@@ -0,0 +1,216 @@
+#include "book_recommender/ConcurrencyLimiter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "book_recommender/Metrics.hpp"
+
+namespace book_recommender {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* priorityName(size_t level) {
+    return level == 0 ? "interactive" : "background";
+}
+
+struct LimiterMetrics {
+    Gauge& limit;
+    Gauge& in_flight;
+    Gauge& queued;
+    Histogram& interactive_wait;
+    Histogram& background_wait;
+
+    Histogram& wait(size_t level) { return level == 0 ? interactive_wait : background_wait; }
+};
+
+LimiterMetrics& limiterMetrics() {
+    auto& registry = MetricsRegistry::getInstance();
+    static const char* wait_help = "Time requests spent waiting for an admission slot";
+    static LimiterMetrics metrics{
+        registry.gauge("book_recommender_concurrency_limit",
+                       "Current adaptive concurrency limit"),
+        registry.gauge("book_recommender_requests_in_flight",
+                       "Requests holding an admission slot"),
+        registry.gauge("book_recommender_admission_queue_depth",
+                       "Requests waiting for an admission slot"),
+        registry.histogram("book_recommender_admission_wait_seconds", wait_help,
+                           {{"priority", priorityName(0)}}),
+        registry.histogram("book_recommender_admission_wait_seconds", wait_help,
+                           {{"priority", priorityName(1)}})
+    };
+    return metrics;
+}
+
+Counter& shedCounter(size_t level, const char* reason) {
+    return MetricsRegistry::getInstance().counter(
+        "book_recommender_requests_shed_total", "Requests rejected by admission control",
+        {{"priority", priorityName(level)}, {"reason", reason}}
+    );
+}
+
+}
+
+ConcurrencyLimiter::Permit::Permit(Permit&& other) noexcept
+    : limiter_(std::exchange(other.limiter_, nullptr)), start_(other.start_) {}
+
+ConcurrencyLimiter::Permit& ConcurrencyLimiter::Permit::operator=(Permit&& other) noexcept {
+    if (this != &other) {
+        release();
+        limiter_ = std::exchange(other.limiter_, nullptr);
+        start_ = other.start_;
+    }
+    return *this;
+}
+
+void ConcurrencyLimiter::Permit::release() {
+    if (limiter_) {
+        std::exchange(limiter_, nullptr)->release(Clock::now() - start_, true);
+    }
+}
+
+void ConcurrencyLimiter::Permit::abandon() {
+    if (limiter_) {
+        std::exchange(limiter_, nullptr)->release(Clock::duration::zero(), false);
+    }
+}
+
+ConcurrencyLimiter::ConcurrencyLimiter(const ConcurrencyLimiterConfig& config)
+    : config_(config),
+      limit_(config.initial_limit) {
+    if (config_.min_limit < 1 || config_.max_limit < config_.min_limit) {
+        throw std::invalid_argument("Concurrency limits need 1 <= min_limit <= max_limit");
+    }
+    limit_ = std::clamp<double>(limit_, config_.min_limit, config_.max_limit);
+    publishGauges();
+}
+
+ConcurrencyLimiter::Permit ConcurrencyLimiter::acquire(TaskPriority priority) {
+    auto level = static_cast<size_t>(priority);
+    auto start = Clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (queued_ == 0 && in_flight_ < static_cast<int>(limit_)) {
+        ++in_flight_;
+        publishGauges();
+        return Permit(this, start);
+    }
+    if (queued_ >= config_.max_queued) {
+        reject(priority, "queue_full");
+    }
+
+    Waiter waiter;
+    waiting_[level].push_back(&waiter);
+    ++queued_;
+    publishGauges();
+
+    auto timeout = priority == TaskPriority::Interactive
+        ? config_.interactive_queue_timeout
+        : config_.background_queue_timeout;
+    bool granted = waiter.ready.wait_until(lock, start + timeout, [&] { return waiter.granted; });
+    auto admitted = Clock::now();
+    limiterMetrics().wait(level).record(admitted - start);
+
+    if (!granted) {
+        auto& queue = waiting_[level];
+        queue.erase(std::find(queue.begin(), queue.end(), &waiter));
+        --queued_;
+        publishGauges();
+        reject(priority, "timeout");
+    }
+    return Permit(this, admitted);
+}
+
+ConcurrencyLimiter::Permit ConcurrencyLimiter::tryAcquire(TaskPriority priority) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queued_ > 0 || in_flight_ >= static_cast<int>(limit_)) {
+        reject(priority, "limit");
+    }
+    ++in_flight_;
+    publishGauges();
+    return Permit(this, Clock::now());
+}
+
+ConcurrencyLimiter::Stats ConcurrencyLimiter::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.limit = static_cast<int>(limit_);
+    stats.in_flight = in_flight_;
+    stats.queued = queued_;
+    stats.rejected = rejected_;
+    return stats;
+}
+
+void ConcurrencyLimiter::release(Clock::duration elapsed, bool sample) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sample) {
+        updateLimit(elapsed);
+    }
+    --in_flight_;
+    grantWaiters();
+    publishGauges();
+}
+
+void ConcurrencyLimiter::updateLimit(Clock::duration elapsed) {
+    elapsed = std::max(elapsed, Clock::duration(1));
+    ++samples_;
+    if (config_.baseline_reset_samples > 0 && samples_ % config_.baseline_reset_samples == 0) {
+        baseline_ = elapsed;
+    } else {
+        baseline_ = std::min(baseline_, elapsed);
+    }
+
+    // Estimated number of requests queued downstream, compared against
+    // thresholds that scale with log10(limit) so large limits move in
+    // proportionally smaller steps
+    double queue = limit_ * (1.0 - static_cast<double>(baseline_.count()) / elapsed.count());
+    double step = std::max(1.0, std::log10(limit_));
+    double alpha = 3 * step;
+    double beta = 6 * step;
+
+    double limit = limit_;
+    if (queue > beta) {
+        limit -= step;
+    } else if (in_flight_ * 2 < limit_) {
+        // Too little traffic to tell whether a higher limit would hold
+        return;
+    } else if (queue <= step) {
+        limit += beta;
+    } else if (queue < alpha) {
+        limit += step;
+    }
+    limit_ = std::clamp<double>(limit, config_.min_limit, config_.max_limit);
+}
+
+void ConcurrencyLimiter::grantWaiters() {
+    while (queued_ > 0 && in_flight_ < static_cast<int>(limit_)) {
+        for (auto& queue : waiting_) {
+            if (queue.empty()) continue;
+            Waiter* waiter = queue.front();
+            queue.pop_front();
+            --queued_;
+            ++in_flight_;
+            waiter->granted = true;
+            waiter->ready.notify_one();
+            break;
+        }
+    }
+}
+
+void ConcurrencyLimiter::reject(TaskPriority priority, const char* reason) {
+    ++rejected_;
+    shedCounter(static_cast<size_t>(priority), reason).increment();
+    // Suggest waiting about as long as a request takes to get through
+    auto retry_after = std::chrono::duration_cast<std::chrono::milliseconds>(
+        baseline_ == Clock::duration::max() ? Clock::duration(std::chrono::seconds(1)) : baseline_ * 2);
+    throw OverloadError(std::string("Request shed by admission control: ") + reason,
+                        std::max(retry_after, std::chrono::milliseconds(100)));
+}
+
+void ConcurrencyLimiter::publishGauges() const {
+    auto& metrics = limiterMetrics();
+    metrics.limit.set(static_cast<int64_t>(limit_));
+    metrics.in_flight.set(in_flight_);
+    metrics.queued.set(static_cast<int64_t>(queued_));
+}
+
+}
@@ -0,0 +1,110 @@
+#include "book_recommender/EditDistance.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+namespace book_recommender {
+
+namespace {
+
+size_t dynamicProgramDistance(std::string_view a, std::string_view b) {
+    std::vector<size_t> previous(b.size() + 1);
+    std::vector<size_t> current(b.size() + 1);
+    std::iota(previous.begin(), previous.end(), 0);
+    for (size_t i = 1; i <= a.size(); ++i) {
+        current[0] = i;
+        for (size_t j = 1; j <= b.size(); ++j) {
+            size_t substitution = previous[j - 1] + (a[i - 1] != b[j - 1]);
+            current[j] = std::min({previous[j] + 1, current[j - 1] + 1, substitution});
+        }
+        std::swap(previous, current);
+    }
+    return previous[b.size()];
+}
+
+}
+
+size_t editDistance(std::string_view a, std::string_view b) {
+    // The shorter string becomes the pattern held in the bit vectors
+    if (a.size() > b.size()) std::swap(a, b);
+    if (a.empty()) return b.size();
+    if (a.size() > 64) return dynamicProgramDistance(a, b);
+
+    uint64_t peq[256] = {};
+    for (size_t i = 0; i < a.size(); ++i) {
+        peq[static_cast<unsigned char>(a[i])] |= uint64_t{1} << i;
+    }
+
+    // pv/mv: vertical +1/-1 deltas of the current DP column, one bit per
+    // pattern position; score tracks the bottom cell
+    uint64_t pv = ~uint64_t{0};
+    uint64_t mv = 0;
+    uint64_t last = uint64_t{1} << (a.size() - 1);
+    size_t score = a.size();
+    for (char c : b) {
+        uint64_t eq = peq[static_cast<unsigned char>(c)];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & last) {
+            ++score;
+        } else if (mh & last) {
+            --score;
+        }
+        // The top row grows by one per column in a global alignment
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    return score;
+}
+
+size_t BKTree::insert(std::string word) {
+    if (nodes_.empty()) {
+        nodes_.push_back({std::move(word), {}});
+        return 0;
+    }
+
+    size_t node = 0;
+    while (true) {
+        size_t distance = editDistance(word, nodes_[node].word);
+        if (distance == 0) return node;
+
+        auto& children = nodes_[node].children;
+        auto child = std::find_if(children.begin(), children.end(),
+                                  [&](const auto& edge) { return edge.first == distance; });
+        if (child == children.end()) {
+            children.emplace_back(distance, nodes_.size());
+            nodes_.push_back({std::move(word), {}});
+            return nodes_.size() - 1;
+        }
+        node = child->second;
+    }
+}
+
+void BKTree::search(std::string_view query, size_t radius, const Visitor& visit) const {
+    if (nodes_.empty()) return;
+
+    std::vector<size_t> pending{0};
+    while (!pending.empty()) {
+        size_t node = pending.back();
+        pending.pop_back();
+
+        size_t distance = editDistance(query, nodes_[node].word);
+        if (distance <= radius) {
+            radius = visit(node, distance);
+        }
+        for (const auto& [edge, child] : nodes_[node].children) {
+            // Triangle inequality: words under this edge are at least
+            // |distance - edge| away from the query
+            size_t gap = edge > distance ? edge - distance : distance - edge;
+            if (gap <= radius) {
+                pending.push_back(child);
+            }
+        }
+    }
+}
+
+}
@@ -1,6 +1,9 @@
 #include "GroqClient.hpp"
+#include <chrono>
 #include <stdexcept>
 #include <cstdlib>
+#include "book_recommender/Metrics.hpp"
+#include "book_recommender/Tracing.hpp"
 
 namespace book_recommender {
 
@@ -9,14 +12,87 @@ GroqClient::GroqClient() : client_(base_url_) {
 }
 
 void GroqClient::validateApiKey() {
-    api_key_ = std::getenv("GROQ_API_KEY");
-    if (api_key_.empty()) {
+    const char* api_key = std::getenv("GROQ_API_KEY");
+    if (!api_key || !*api_key) {
         throw std::runtime_error("GROQ_API_KEY environment variable not set");
     }
+    api_key_ = api_key;
 }
 
 std::vector<float> GroqClient::getEmbedding(const std::string& text) {
-    nlohmann::json request_data = {
+    try {
+        auto response = makeRequest("embeddings", embeddingRequest(text));
+        return parseEmbedding(response);
+    } catch (const std::exception& e) {
+        spdlog::error("Error getting embedding: {}", e.what());
+        throw;
+    }
+}
+
+std::string GroqClient::enhanceQuery(const std::string& query) {
+    try {
+        auto response = makeRequest("chat/completions", enhanceRequest(query));
+        return response["choices"][0]["message"]["content"];
+    } catch (const std::exception& e) {
+        spdlog::error("Error enhancing query: {}", e.what());
+        return query;  // Return original query on error
+    }
+}
+
+std::string GroqClient::generateExplanation(
+    const std::string& book_info,
+    const std::string& query
+) {
+    try {
+        auto response = makeRequest("chat/completions", explanationRequest(book_info, query));
+        return response["choices"][0]["message"]["content"];
+    } catch (const std::exception& e) {
+        spdlog::error("Error generating explanation: {}", e.what());
+        return "This book matches elements of your query.";  // Fallback explanation
+    }
+}
+
+#ifdef BOOK_RECOMMENDER_COROUTINES
+AsyncTask<std::vector<float>> GroqClient::getEmbeddingAsync(std::string text, TaskPriority priority) {
+    try {
+        auto response = co_await PplxAwaiter<nlohmann::json>(
+            makeRequestAsync("embeddings", embeddingRequest(text)), priority);
+        co_return parseEmbedding(response);
+    } catch (const std::exception& e) {
+        spdlog::error("Error getting embedding: {}", e.what());
+        throw;
+    }
+}
+
+AsyncTask<std::string> GroqClient::enhanceQueryAsync(std::string query, TaskPriority priority) {
+    try {
+        auto response = co_await PplxAwaiter<nlohmann::json>(
+            makeRequestAsync("chat/completions", enhanceRequest(query)), priority);
+        co_return response["choices"][0]["message"]["content"].get<std::string>();
+    } catch (const std::exception& e) {
+        spdlog::error("Error enhancing query: {}", e.what());
+    }
+    co_return query;  // Return original query on error
+}
+
+AsyncTask<std::string> GroqClient::generateExplanationAsync(
+    std::string book_info,
+    std::string query,
+    TaskPriority priority
+) {
+    try {
+        auto response = co_await PplxAwaiter<nlohmann::json>(
+            makeRequestAsync("chat/completions", explanationRequest(book_info, query)), priority);
+        co_return response["choices"][0]["message"]["content"].get<std::string>();
+    } catch (const std::exception& e) {
+        spdlog::error("Error generating explanation: {}", e.what());
+    }
+    co_return "This book matches elements of your query.";  // Fallback explanation
+}
+#endif
+
+nlohmann::json GroqClient::embeddingRequest(const std::string& text) const {
+    return {
         {"model", model_},
         {"messages", {{
             {"role", "system"},
@@ -27,18 +103,10 @@ std::vector<float> GroqClient::getEmbedding(const std::string& text) {
         }}},
         {"stream", false}
     };
-
-    try {
-        auto response = makeRequest("embeddings", request_data);
-        return parseEmbedding(response);
-    } catch (const std::exception& e) {
-        spdlog::error("Error getting embedding: {}", e.what());
-        throw;
-    }
 }
 
-std::string GroqClient::enhanceQuery(const std::string& query) {
-    nlohmann::json request_data = {
+nlohmann::json GroqClient::enhanceRequest(const std::string& query) const {
+    return {
         {"model", model_},
         {"messages", {{
             {"role", "system"},
@@ -51,21 +119,10 @@ std::string GroqClient::enhanceQuery(const std::string& query) {
         {"temperature", 0.3},
         {"stream", false}
     };
-
-    try {
-        auto response = makeRequest("chat/completions", request_data);
-        return response["choices"][0]["message"]["content"];
-    } catch (const std::exception& e) {
-        spdlog::error("Error enhancing query: {}", e.what());
-        return query;  // Return original query on error
-    }
 }
 
-std::string GroqClient::generateExplanation(
-    const std::string& book_info,
-    const std::string& query
-) {
-    nlohmann::json request_data = {
+nlohmann::json GroqClient::explanationRequest(const std::string& book_info, const std::string& query) const {
+    return {
         {"model", model_},
         {"messages", {{
             {"role", "system"},
@@ -78,33 +135,87 @@ std::string GroqClient::generateExplanation(
         {"temperature", 0.7},
         {"stream", false}
     };
-
-    try {
-        auto response = makeRequest("chat/completions", request_data);
-        return response["choices"][0]["message"]["content"];
-    } catch (const std::exception& e) {
-        spdlog::error("Error generating explanation: {}", e.what());
-        return "This book matches elements of your query.";  // Fallback explanation
-    }
 }
 
-nlohmann::json GroqClient::makeRequest(
+web::http::http_request GroqClient::buildRequest(
     const std::string& endpoint,
     const nlohmann::json& data
-) {
+) const {
     web::http::http_request request(web::http::methods::POST);
+    request.set_request_uri(endpoint);
     request.headers().add("Authorization", "Bearer " + api_key_);
     request.headers().add("Content-Type", "application/json");
     request.set_body(data.dump());
+    return request;
+}
 
-    auto response = client_.request(request).get();
-    
-    if (response.status_code() != 200) {
-        throw std::runtime_error("Groq API request failed with status code: " + 
-                               std::to_string(response.status_code()));
+nlohmann::json GroqClient::makeRequest(
+    const std::string& endpoint,
+    const nlohmann::json& data
+) {
+    // Per-request registry lookup is negligible next to the network round trip
+    auto& registry = MetricsRegistry::getInstance();
+    auto& latency = registry.histogram(
+        "book_recommender_groq_request_seconds", "Groq API request latency", {{"endpoint", endpoint}}
+    );
+    auto& errors = registry.counter(
+        "book_recommender_groq_errors_total", "Failed Groq API requests", {{"endpoint", endpoint}}
+    );
+
+    Span span("GroqClient.request");
+    span.setAttribute("endpoint", endpoint);
+    ScopedTimer timer(latency);
+    try {
+        auto response = client_.request(buildRequest(endpoint, data)).get();
+        span.setAttribute("http.status_code", static_cast<int>(response.status_code()));
+        
+        if (response.status_code() != 200) {
+            throw std::runtime_error("Groq API request failed with status code: " + 
+                                   std::to_string(response.status_code()));
+        }
+
+        return nlohmann::json::parse(response.extract_string().get());
+    } catch (const std::exception& e) {
+        errors.increment();
+        span.setError(e.what());
+        throw;
     }
+}
+
+pplx::task<nlohmann::json> GroqClient::makeRequestAsync(
+    const std::string& endpoint,
+    const nlohmann::json& data
+) {
+    // Spans follow the calling thread, so the asynchronous path only
+    // records metrics
+    auto& registry = MetricsRegistry::getInstance();
+    auto* latency = &registry.histogram(
+        "book_recommender_groq_request_seconds", "Groq API request latency", {{"endpoint", endpoint}}
+    );
+    auto* errors = &registry.counter(
+        "book_recommender_groq_errors_total", "Failed Groq API requests", {{"endpoint", endpoint}}
+    );
+    auto start = std::chrono::steady_clock::now();
 
-    return nlohmann::json::parse(response.extract_string().get());
+    return client_.request(buildRequest(endpoint, data))
+        .then([](web::http::http_response response) {
+            if (response.status_code() != 200) {
+                throw std::runtime_error("Groq API request failed with status code: " +
+                                         std::to_string(response.status_code()));
+            }
+            return response.extract_string();
+        })
+        .then([latency, errors, start](pplx::task<std::string> body) {
+            try {
+                auto response = nlohmann::json::parse(body.get());
+                latency->record(std::chrono::steady_clock::now() - start);
+                return response;
+            } catch (const std::exception&) {
+                latency->record(std::chrono::steady_clock::now() - start);
+                errors->increment();
+                throw;
+            }
+        });
 }
 
 std::vector<float> GroqClient::parseEmbedding(const nlohmann::json& response) {
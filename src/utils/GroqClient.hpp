@@ -6,6 +6,7 @@
 #include <cpprest/http_client.h>
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
+#include "book_recommender/AsyncTask.hpp"
 
 namespace book_recommender {
 
@@ -20,6 +21,16 @@ public:
     std::string enhanceQuery(const std::string& query);
     std::string generateExplanation(const std::string& book_info, const std::string& query);
 
+#ifdef BOOK_RECOMMENDER_COROUTINES
+    // Suspending variants: the awaiting coroutine gives up its thread while
+    // the request is in flight and resumes on the executor at `priority`.
+    // Failure handling matches the blocking calls.
+    AsyncTask<std::vector<float>> getEmbeddingAsync(std::string text, TaskPriority priority);
+    AsyncTask<std::string> enhanceQueryAsync(std::string query, TaskPriority priority);
+    AsyncTask<std::string> generateExplanationAsync(
+        std::string book_info, std::string query, TaskPriority priority);
+#endif
+
 private:
     GroqClient();
     
@@ -29,8 +40,37 @@ private:
     const std::string model_ = "mixtral-8x7b-32768";
 
     nlohmann::json makeRequest(const std::string& endpoint, const nlohmann::json& data);
+    pplx::task<nlohmann::json> makeRequestAsync(const std::string& endpoint, const nlohmann::json& data);
+    web::http::http_request buildRequest(const std::string& endpoint, const nlohmann::json& data) const;
+    nlohmann::json embeddingRequest(const std::string& text) const;
+    nlohmann::json enhanceRequest(const std::string& query) const;
+    nlohmann::json explanationRequest(const std::string& book_info, const std::string& query) const;
     void validateApiKey();
     std::vector<float> parseEmbedding(const nlohmann::json& response);
 };
 
-}
\ No newline at end of file
+#ifdef BOOK_RECOMMENDER_COROUTINES
+// Awaits a pplx task without blocking: the coroutine is resumed on the
+// executor once the task completes, whichever thread completes it
+template <typename T>
+class PplxAwaiter {
+public:
+    PplxAwaiter(pplx::task<T> task, TaskPriority priority) : task_(std::move(task)), priority_(priority) {}
+
+    bool await_ready() const { return task_.is_done(); }
+    void await_suspend(std::coroutine_handle<> handle) {
+        // A task-based continuation observes the task's exception, which
+        // await_resume then rethrows
+        task_.then([handle, priority = priority_](pplx::task<T>) {
+            TaskExecutor::getInstance().post([handle] { handle.resume(); }, priority);
+        });
+    }
+    T await_resume() { return task_.get(); }
+
+private:
+    pplx::task<T> task_;
+    TaskPriority priority_;
+};
+#endif
+
+}
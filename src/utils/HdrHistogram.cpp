@@ -0,0 +1,194 @@
+#include "book_recommender/HdrHistogram.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace book_recommender {
+
+namespace {
+
+int countLeadingZeros(uint64_t value) {
+    return value == 0 ? 64 : __builtin_clzll(value);
+}
+
+}
+
+HdrHistogram::HdrHistogram(
+    int64_t lowest_trackable_value,
+    int64_t highest_trackable_value,
+    int significant_digits
+) : lowest_trackable_value_(lowest_trackable_value),
+    highest_trackable_value_(highest_trackable_value),
+    significant_digits_(significant_digits) {
+    if (lowest_trackable_value_ < 1) {
+        throw std::invalid_argument("Lowest trackable value must be >= 1");
+    }
+    if (highest_trackable_value_ < 2 * lowest_trackable_value_) {
+        throw std::invalid_argument("Highest trackable value must be >= 2 * lowest");
+    }
+    if (significant_digits_ < 1 || significant_digits_ > 5) {
+        throw std::invalid_argument("Significant digits must be between 1 and 5");
+    }
+
+    int64_t largest_single_unit_resolution = 2 * static_cast<int64_t>(std::pow(10, significant_digits_));
+    int sub_bucket_count_magnitude = static_cast<int>(
+        std::ceil(std::log2(static_cast<double>(largest_single_unit_resolution)))
+    );
+    sub_bucket_half_count_magnitude_ = std::max(sub_bucket_count_magnitude, 1) - 1;
+    unit_magnitude_ = static_cast<int>(std::floor(std::log2(static_cast<double>(lowest_trackable_value_))));
+    sub_bucket_count_ = int64_t{1} << (sub_bucket_half_count_magnitude_ + 1);
+    sub_bucket_half_count_ = sub_bucket_count_ / 2;
+    sub_bucket_mask_ = (sub_bucket_count_ - 1) << unit_magnitude_;
+
+    // Number of power-of-two buckets needed to cover the highest value
+    int64_t smallest_untrackable_value = sub_bucket_count_ << unit_magnitude_;
+    int buckets_needed = 1;
+    while (smallest_untrackable_value <= highest_trackable_value_) {
+        if (smallest_untrackable_value > INT64_MAX / 2) {
+            ++buckets_needed;
+            break;
+        }
+        smallest_untrackable_value <<= 1;
+        ++buckets_needed;
+    }
+    bucket_count_ = buckets_needed;
+
+    counts_.assign(static_cast<size_t>((bucket_count_ + 1) * sub_bucket_half_count_), 0);
+}
+
+int HdrHistogram::getBucketIndex(int64_t value) const {
+    int pow2_ceiling = 64 - countLeadingZeros(static_cast<uint64_t>(value | sub_bucket_mask_));
+    return pow2_ceiling - unit_magnitude_ - (sub_bucket_half_count_magnitude_ + 1);
+}
+
+size_t HdrHistogram::countsIndexFor(int64_t value) const {
+    value = std::clamp<int64_t>(value, 0, highest_trackable_value_);
+    int bucket_index = getBucketIndex(value);
+    int64_t sub_bucket_index = value >> (bucket_index + unit_magnitude_);
+    int64_t bucket_base_index = static_cast<int64_t>(bucket_index + 1) << sub_bucket_half_count_magnitude_;
+    return static_cast<size_t>(bucket_base_index + (sub_bucket_index - sub_bucket_half_count_));
+}
+
+int64_t HdrHistogram::valueFromIndex(size_t index) const {
+    int bucket_index = static_cast<int>(index >> sub_bucket_half_count_magnitude_) - 1;
+    int64_t sub_bucket_index = static_cast<int64_t>(index & (sub_bucket_half_count_ - 1)) + sub_bucket_half_count_;
+    if (bucket_index < 0) {
+        sub_bucket_index -= sub_bucket_half_count_;
+        bucket_index = 0;
+    }
+    return sub_bucket_index << (bucket_index + unit_magnitude_);
+}
+
+int64_t HdrHistogram::lowestEquivalentValue(int64_t value) const {
+    int bucket_index = getBucketIndex(value);
+    int64_t sub_bucket_index = value >> (bucket_index + unit_magnitude_);
+    return sub_bucket_index << (bucket_index + unit_magnitude_);
+}
+
+int64_t HdrHistogram::sizeOfEquivalentValueRange(int64_t value) const {
+    int bucket_index = getBucketIndex(value);
+    int64_t sub_bucket_index = value >> (bucket_index + unit_magnitude_);
+    int adjusted_bucket = sub_bucket_index >= sub_bucket_count_ ? bucket_index + 1 : bucket_index;
+    return int64_t{1} << (unit_magnitude_ + adjusted_bucket);
+}
+
+int64_t HdrHistogram::highestEquivalentValue(int64_t value) const {
+    return lowestEquivalentValue(value) + sizeOfEquivalentValueRange(value) - 1;
+}
+
+void HdrHistogram::recordValue(int64_t value) {
+    recordValues(value, 1);
+}
+
+void HdrHistogram::recordValues(int64_t value, int64_t count) {
+    if (count <= 0) return;
+    value = std::clamp<int64_t>(value, 0, highest_trackable_value_);
+
+    counts_[countsIndexFor(value)] += count;
+    total_count_ += count;
+    min_value_ = std::min(min_value_, value);
+    max_value_ = std::max(max_value_, value);
+}
+
+void HdrHistogram::recordCorrectedValue(int64_t value, int64_t expected_interval) {
+    recordValue(value);
+    if (expected_interval <= 0 || value <= expected_interval) {
+        return;
+    }
+
+    // Back-fill the samples a stalled closed-loop client never got to send
+    for (int64_t missing = value - expected_interval;
+         missing >= expected_interval;
+         missing -= expected_interval) {
+        recordValue(missing);
+    }
+}
+
+void HdrHistogram::add(const HdrHistogram& other) {
+    if (other.total_count_ == 0) return;
+
+    if (other.counts_.size() == counts_.size() &&
+        other.unit_magnitude_ == unit_magnitude_ &&
+        other.sub_bucket_half_count_magnitude_ == sub_bucket_half_count_magnitude_) {
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_count_ += other.total_count_;
+        min_value_ = std::min(min_value_, other.min_value_);
+        max_value_ = std::max(max_value_, other.max_value_);
+        return;
+    }
+
+    // Different layouts: re-record each bucket by its representative value
+    for (size_t i = 0; i < other.counts_.size(); ++i) {
+        if (other.counts_[i] > 0) {
+            recordValues(other.valueFromIndex(i), other.counts_[i]);
+        }
+    }
+}
+
+void HdrHistogram::reset() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    total_count_ = 0;
+    min_value_ = INT64_MAX;
+    max_value_ = 0;
+}
+
+int64_t HdrHistogram::getMin() const {
+    return total_count_ == 0 ? 0 : min_value_;
+}
+
+double HdrHistogram::getMean() const {
+    if (total_count_ == 0) return 0.0;
+
+    double total = 0.0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        if (counts_[i] > 0) {
+            int64_t value = valueFromIndex(i);
+            int64_t median_equivalent = lowestEquivalentValue(value) + (sizeOfEquivalentValueRange(value) >> 1);
+            total += static_cast<double>(median_equivalent) * counts_[i];
+        }
+    }
+    return total / total_count_;
+}
+
+int64_t HdrHistogram::getValueAtPercentile(double percentile) const {
+    if (total_count_ == 0) return 0;
+
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    int64_t count_at_percentile = static_cast<int64_t>(
+        (percentile / 100.0) * static_cast<double>(total_count_) + 0.5
+    );
+    count_at_percentile = std::max<int64_t>(count_at_percentile, 1);
+
+    int64_t cumulative = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        cumulative += counts_[i];
+        if (cumulative >= count_at_percentile) {
+            return std::min(highestEquivalentValue(valueFromIndex(i)), max_value_);
+        }
+    }
+    return max_value_;
+}
+
+}
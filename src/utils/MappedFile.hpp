@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace book_recommender {
+
+// Read-only view of a whole file, unmapped on destruction. Pages are shared
+// with every other process mapping the same file. Without mmap (Windows)
+// the file is read into memory instead.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // True when [offset, offset + bytes) lies inside the file. Written so
+    // that offsets and sizes read from a corrupt header cannot overflow.
+    bool contains(uint64_t offset, uint64_t bytes) const {
+        return offset <= size_ && bytes <= size_ - offset;
+    }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    std::vector<char> buffer_;
+#endif
+};
+
+// count * width, or nullopt when the product overflows
+inline std::optional<uint64_t> arrayBytes(uint64_t count, uint64_t width) {
+    if (width != 0 && count > UINT64_MAX / width) {
+        return std::nullopt;
+    }
+    return count * width;
+}
+
+// Flushes a file (or a directory's entries) to stable storage, so a rename
+// that follows cannot expose a name whose data was lost in a crash. No-op
+// without POSIX fsync.
+void syncFile(const std::string& path);
+
+}
@@ -0,0 +1,236 @@
+#include "book_recommender/Metrics.hpp"
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace book_recommender {
+
+namespace {
+
+// Histograms cover 1us..60s with two significant digits (~20KB per shard)
+constexpr int64_t HISTOGRAM_LOWEST_MICROS = 1;
+constexpr int64_t HISTOGRAM_HIGHEST_MICROS = 60LL * 1000 * 1000;
+constexpr int HISTOGRAM_SIGNIFICANT_DIGITS = 2;
+
+constexpr double SUMMARY_QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+std::atomic<uint64_t> next_histogram_id{0};
+
+// Histogram ids are never reused, so a stale slot is simply never read again
+thread_local std::vector<void*> thread_histogram_shards;
+
+size_t threadStripe() {
+    static thread_local size_t stripe = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    return stripe;
+}
+
+std::string escapeLabelValue(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '"': escaped += "\\\""; break;
+            case '\n': escaped += "\\n"; break;
+            default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string withLabel(const std::string& labels, const std::string& key, const std::string& value) {
+    std::string label = key + "=\"" + value + "\"";
+    if (labels.empty()) {
+        return "{" + label + "}";
+    }
+    return labels.substr(0, labels.size() - 1) + "," + label + "}";
+}
+
+}
+
+void Counter::increment(uint64_t amount) {
+    stripes_[threadStripe() % STRIPES].value.fetch_add(amount, std::memory_order_relaxed);
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& stripe : stripes_) {
+        total += stripe.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+struct Histogram::Shard {
+    explicit Shard(size_t length) : counts(length) {}
+
+    std::vector<std::atomic<uint64_t>> counts;
+    std::atomic<uint64_t> sum_micros{0};
+};
+
+Histogram::Histogram()
+    : id_(next_histogram_id.fetch_add(1, std::memory_order_relaxed))
+    , layout_(HISTOGRAM_LOWEST_MICROS, HISTOGRAM_HIGHEST_MICROS, HISTOGRAM_SIGNIFICANT_DIGITS) {}
+
+Histogram::~Histogram() = default;
+
+Histogram::Shard& Histogram::localShard() {
+    if (id_ >= thread_histogram_shards.size()) {
+        thread_histogram_shards.resize(id_ + 1, nullptr);
+    }
+
+    auto*& slot = thread_histogram_shards[id_];
+    if (!slot) {
+        std::lock_guard<std::mutex> lock(shards_mutex_);
+        shards_.push_back(std::make_unique<Shard>(layout_.countsLength()));
+        slot = shards_.back().get();
+    }
+    return *static_cast<Shard*>(slot);
+}
+
+void Histogram::record(int64_t micros) {
+    auto& shard = localShard();
+    micros = std::max<int64_t>(micros, 0);
+    shard.counts[layout_.countsIndexFor(micros)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum_micros.fetch_add(static_cast<uint64_t>(micros), std::memory_order_relaxed);
+}
+
+void Histogram::record(std::chrono::steady_clock::duration elapsed) {
+    record(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+HdrHistogram Histogram::snapshot() const {
+    HdrHistogram merged(HISTOGRAM_LOWEST_MICROS, HISTOGRAM_HIGHEST_MICROS, HISTOGRAM_SIGNIFICANT_DIGITS);
+
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    for (const auto& shard : shards_) {
+        for (size_t i = 0; i < shard->counts.size(); ++i) {
+            uint64_t count = shard->counts[i].load(std::memory_order_relaxed);
+            if (count > 0) {
+                merged.recordValues(layout_.valueFromIndex(i), static_cast<int64_t>(count));
+            }
+        }
+    }
+    return merged;
+}
+
+double Histogram::sumSeconds() const {
+    uint64_t total = 0;
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    for (const auto& shard : shards_) {
+        total += shard->sum_micros.load(std::memory_order_relaxed);
+    }
+    return static_cast<double>(total) / 1e6;
+}
+
+MetricsRegistry::Family& MetricsRegistry::getFamily(
+    const std::string& name,
+    const std::string& help,
+    MetricType type
+) {
+    auto [it, inserted] = families_.try_emplace(name);
+    if (inserted) {
+        it->second.help = help;
+        it->second.type = type;
+    } else if (it->second.type != type) {
+        throw std::invalid_argument("Metric registered with a different type: " + name);
+    }
+    return it->second;
+}
+
+Counter& MetricsRegistry::counter(
+    const std::string& name,
+    const std::string& help,
+    const MetricLabels& labels
+) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& family = getFamily(name, help, MetricType::Counter);
+    auto& metric = family.counters[formatLabels(labels)];
+    if (!metric) metric = std::make_unique<Counter>();
+    return *metric;
+}
+
+Gauge& MetricsRegistry::gauge(
+    const std::string& name,
+    const std::string& help,
+    const MetricLabels& labels
+) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& family = getFamily(name, help, MetricType::Gauge);
+    auto& metric = family.gauges[formatLabels(labels)];
+    if (!metric) metric = std::make_unique<Gauge>();
+    return *metric;
+}
+
+Histogram& MetricsRegistry::histogram(
+    const std::string& name,
+    const std::string& help,
+    const MetricLabels& labels
+) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& family = getFamily(name, help, MetricType::Summary);
+    auto& metric = family.histograms[formatLabels(labels)];
+    if (!metric) metric = std::make_unique<Histogram>();
+    return *metric;
+}
+
+std::string MetricsRegistry::formatLabels(const MetricLabels& labels) {
+    if (labels.empty()) return "";
+
+    std::string formatted = "{";
+    bool first = true;
+    for (const auto& [key, value] : labels) {
+        if (!first) formatted += ",";
+        formatted += key + "=\"" + escapeLabelValue(value) + "\"";
+        first = false;
+    }
+    formatted += "}";
+    return formatted;
+}
+
+std::string MetricsRegistry::scrapePrometheus() const {
+    std::ostringstream out;
+    out << std::setprecision(9);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [name, family] : families_) {
+        out << "# HELP " << name << " " << family.help << "\n";
+
+        switch (family.type) {
+            case MetricType::Counter:
+                out << "# TYPE " << name << " counter\n";
+                for (const auto& [labels, counter] : family.counters) {
+                    out << name << labels << " " << counter->value() << "\n";
+                }
+                break;
+
+            case MetricType::Gauge:
+                out << "# TYPE " << name << " gauge\n";
+                for (const auto& [labels, gauge] : family.gauges) {
+                    out << name << labels << " " << gauge->value() << "\n";
+                }
+                break;
+
+            case MetricType::Summary:
+                out << "# TYPE " << name << " summary\n";
+                for (const auto& [labels, histogram] : family.histograms) {
+                    auto snapshot = histogram->snapshot();
+                    for (double quantile : SUMMARY_QUANTILES) {
+                        std::ostringstream q;
+                        q << quantile;
+                        out << name << withLabel(labels, "quantile", q.str()) << " "
+                            << snapshot.getValueAtPercentile(quantile * 100.0) / 1e6 << "\n";
+                    }
+                    out << name << "_sum" << labels << " " << histogram->sumSeconds() << "\n";
+                    out << name << "_count" << labels << " " << snapshot.getTotalCount() << "\n";
+                }
+                break;
+        }
+    }
+
+    return out.str();
+}
+
+}
@@ -0,0 +1,280 @@
+#include "book_recommender/TaskExecutor.hpp"
+#include <spdlog/spdlog.h>
+#include "book_recommender/AllocationTracking.hpp"
+#include "book_recommender/Metrics.hpp"
+#include "book_recommender/Tracing.hpp"
+
+namespace book_recommender {
+
+namespace {
+
+thread_local const TaskExecutor* current_executor = nullptr;
+thread_local int current_worker = -1;
+
+struct ExecutorMetrics {
+    Counter& interactive_tasks;
+    Counter& background_tasks;
+    Counter& steals;
+};
+
+ExecutorMetrics& executorMetrics() {
+    auto& registry = MetricsRegistry::getInstance();
+    static ExecutorMetrics metrics{
+        registry.counter("book_recommender_executor_tasks_total",
+                         "Tasks run by the work-stealing executor", {{"priority", "interactive"}}),
+        registry.counter("book_recommender_executor_tasks_total",
+                         "Tasks run by the work-stealing executor", {{"priority", "background"}}),
+        registry.counter("book_recommender_executor_steals_total",
+                         "Tasks taken from another worker's deque")
+    };
+    return metrics;
+}
+
+// Binds the calling thread's trace and allocation context to a task, so
+// whichever thread runs it works on behalf of the same request
+std::function<void()> inCallerContext(std::function<void()> task) {
+    auto trace = Span::currentContext();
+    auto allocations = AllocationContext::current();
+    if (!trace.trace && !trace.unsampled && !allocations) {
+        return task;
+    }
+    return [task = std::move(task), trace = std::move(trace), allocations = std::move(allocations)] {
+        ScopedTraceContext trace_scope(trace);
+        ScopedAllocationContext allocation_scope(allocations);
+        task();
+    };
+}
+
+}
+
+TaskExecutor& TaskExecutor::getInstance() {
+    static TaskExecutor instance;
+    return instance;
+}
+
+TaskExecutor& TaskExecutor::getBlockingInstance() {
+    // Threads blocked on the network cost memory, not CPU, so the pool is
+    // sized for concurrent round trips rather than cores
+    static TaskExecutor instance(std::max(16u, 4 * std::thread::hardware_concurrency()));
+    return instance;
+}
+
+TaskExecutor::TaskExecutor(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    threads_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+TaskExecutor::~TaskExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) thread.join();
+    }
+}
+
+void TaskExecutor::post(Task task, TaskPriority priority) {
+    enqueue(inCallerContext(std::move(task)), priority);
+}
+
+void TaskExecutor::enqueue(Task task, TaskPriority priority) {
+    auto level = static_cast<size_t>(priority);
+    int self = currentWorker();
+    if (self >= 0) {
+        auto& worker = *workers_[self];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[level].push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(global_mutex_);
+        global_[level].push_back(std::move(task));
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock orders this notify after any sleeper's predicate check
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    wake_.notify_one();
+}
+
+bool TaskExecutor::runPendingTask(TaskPriority priority) {
+    int self = currentWorker();
+    Task task;
+    for (size_t level = 0; level <= static_cast<size_t>(priority); ++level) {
+        if (take(self, level, task)) {
+            execute(task, level);
+            return true;
+        }
+    }
+    return false;
+}
+
+TaskExecutor::Stats TaskExecutor::stats() const {
+    return {executed_.load(std::memory_order_relaxed), stolen_.load(std::memory_order_relaxed)};
+}
+
+int TaskExecutor::currentWorker() const {
+    return current_executor == this ? current_worker : -1;
+}
+
+bool TaskExecutor::take(int self, size_t level, Task& task) {
+    if (queued_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    if (self >= 0) {
+        auto& worker = *workers_[self];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        auto& queue = worker.queues[level];
+        if (!queue.empty()) {
+            task = std::move(queue.back());
+            queue.pop_back();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(global_mutex_);
+        auto& queue = global_[level];
+        if (!queue.empty()) {
+            task = std::move(queue.front());
+            queue.pop_front();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    size_t count = workers_.size();
+    size_t start = self >= 0 ? static_cast<size_t>(self) + 1 : 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t victim = (start + i) % count;
+        if (static_cast<int>(victim) == self) continue;
+
+        auto& worker = *workers_[victim];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        auto& queue = worker.queues[level];
+        if (!queue.empty()) {
+            task = std::move(queue.front());
+            queue.pop_front();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            stolen_.fetch_add(1, std::memory_order_relaxed);
+            executorMetrics().steals.increment();
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskExecutor::execute(Task& task, size_t level) {
+    auto& metrics = executorMetrics();
+    (level == 0 ? metrics.interactive_tasks : metrics.background_tasks).increment();
+    try {
+        task();
+    } catch (const std::exception& e) {
+        spdlog::error("Executor task failed: {}", e.what());
+    }
+    executed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TaskExecutor::workerLoop(size_t index) {
+    current_executor = this;
+    current_worker = static_cast<int>(index);
+
+    while (true) {
+        // Every interactive source is exhausted before any background one
+        if (runPendingTask(TaskPriority::Background)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return stopping_ || queued_.load(std::memory_order_acquire) > 0; });
+        if (stopping_ && queued_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+struct TaskGroup::State {
+    std::mutex mutex;
+    std::condition_variable changed;  // a task finished or was spawned
+    std::deque<std::function<void()>> queued;  // spawned, not yet started
+    size_t pending = 0;  // queued or running
+    std::exception_ptr error;
+
+    // Runs the oldest task nobody has started; false if there was none
+    bool runOne() {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queued.empty()) return false;
+            task = std::move(queued.front());
+            queued.pop_front();
+        }
+
+        std::exception_ptr failure;
+        try {
+            task();
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        task = nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failure && !error) error = failure;
+        if (--pending == 0) changed.notify_all();
+        return true;
+    }
+};
+
+TaskGroup::TaskGroup(TaskPriority priority, TaskExecutor& executor)
+    : executor_(executor), priority_(priority), state_(std::make_shared<State>()) {}
+
+void TaskGroup::spawn(std::function<void()> task) {
+    // The waiter runs tasks straight off the group's queue, so the context
+    // is bound here rather than by post()
+    task = inCallerContext(std::move(task));
+
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->queued.push_back(std::move(task));
+        ++state_->pending;
+    }
+    // Wakes a waiter whose running tasks spawn more work into the group
+    state_->changed.notify_all();
+
+    // One executor entry per task; entries whose task the waiter already
+    // ran find the queue empty and return
+    executor_.enqueue([state = state_] { state->runOne(); }, priority_);
+}
+
+void TaskGroup::wait() {
+    auto& state = *state_;
+    std::unique_lock<std::mutex> lock(state.mutex);
+    while (state.pending > 0) {
+        if (!state.queued.empty()) {
+            lock.unlock();
+            state.runOne();
+            lock.lock();
+            continue;
+        }
+        state.changed.wait(lock);
+    }
+
+    if (state.error) {
+        auto error = state.error;
+        state.error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+}
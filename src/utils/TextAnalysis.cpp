@@ -0,0 +1,381 @@
+#include "book_recommender/TextAnalysis.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace book_recommender {
+
+namespace {
+
+// ---- Stop words ----
+
+constexpr std::string_view STOP_WORDS[] = {
+    "a", "about", "above", "after", "again", "against", "all", "am", "an", "and", "any", "are", "as", "at",
+    "be", "because", "been", "before", "being", "below", "between", "both", "but", "by",
+    "can", "cannot", "could", "did", "do", "does", "doing", "down", "during", "each",
+    "few", "for", "from", "further", "had", "has", "have", "having", "he", "her", "here", "hers", "herself",
+    "him", "himself", "his", "how", "i", "if", "in", "into", "is", "it", "its", "itself", "just",
+    "me", "more", "most", "my", "myself", "no", "nor", "not", "now", "of", "off", "on", "once", "only",
+    "or", "other", "our", "ours", "ourselves", "out", "over", "own", "same", "she", "should", "so",
+    "some", "such", "than", "that", "the", "their", "theirs", "them", "themselves", "then", "there",
+    "these", "they", "this", "those", "through", "to", "too", "under", "until", "up", "very",
+    "was", "we", "were", "what", "when", "where", "which", "while", "who", "whom", "why", "will",
+    "with", "would", "you", "your", "yours", "yourself", "yourselves",
+    // Contractions after normalization strips the apostrophe
+    "arent", "cant", "couldnt", "didnt", "doesnt", "dont", "hadnt", "hasnt", "havent", "hes", "im",
+    "isnt", "ive", "shes", "shouldnt", "thats", "theres", "theyre", "theyve", "wasnt", "werent",
+    "whats", "wont", "wouldnt", "youd", "youll", "youre", "youve"
+};
+
+constexpr size_t STOP_WORD_COUNT = std::size(STOP_WORDS);
+constexpr unsigned STOP_WORD_TABLE_BITS = 12;
+static_assert(STOP_WORD_COUNT < 256, "stop word slots hold uint8_t indexes");
+
+constexpr size_t longestStopWord() {
+    size_t longest = 0;
+    for (auto word : STOP_WORDS) longest = std::max(longest, word.size());
+    return longest;
+}
+
+constexpr size_t LONGEST_STOP_WORD = longestStopWord();
+
+constexpr uint32_t stopWordSlot(std::string_view word, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : word) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return (hash * 0x9E3779B1u) >> (32 - STOP_WORD_TABLE_BITS);
+}
+
+struct StopWordTable {
+    uint32_t seed = 0;
+    std::array<uint8_t, size_t{1} << STOP_WORD_TABLE_BITS> slots{};  // index + 1; 0 is empty
+};
+
+// Tries seeds until every stop word lands in its own slot. With ~160 words
+// in 4096 slots about one seed in twenty works. A duplicate word can never
+// succeed and fails the build.
+constexpr StopWordTable buildStopWordTable() {
+    for (uint32_t seed = 0; seed < 10000; ++seed) {
+        StopWordTable table;
+        table.seed = seed;
+        bool collision = false;
+        for (size_t i = 0; i < STOP_WORD_COUNT && !collision; ++i) {
+            auto& slot = table.slots[stopWordSlot(STOP_WORDS[i], seed)];
+            collision = slot != 0;
+            slot = static_cast<uint8_t>(i + 1);
+        }
+        if (!collision) return table;
+    }
+    throw std::logic_error("no collision-free stop word seed");
+}
+
+constexpr StopWordTable STOP_WORD_TABLE = buildStopWordTable();
+
+// ---- Porter2 ----
+
+bool isVowel(char c) {
+    return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u' || c == 'y';
+}
+
+bool endsWith(std::string_view word, std::string_view suffix) {
+    return word.size() >= suffix.size() &&
+           std::memcmp(word.data() + word.size() - suffix.size(), suffix.data(), suffix.size()) == 0;
+}
+
+bool isDouble(const std::string& word) {
+    if (word.size() < 2) return false;
+    char c = word.back();
+    return c == word[word.size() - 2] &&
+           (c == 'b' || c == 'd' || c == 'f' || c == 'g' || c == 'm' || c == 'n' || c == 'p' || c == 'r' || c == 't');
+}
+
+bool isLiEnding(char c) {
+    return c == 'c' || c == 'd' || c == 'e' || c == 'g' || c == 'h' || c == 'k' || c == 'm' || c == 'n' ||
+           c == 'r' || c == 't';
+}
+
+// Whether word[0, size) ends in a short syllable: consonant, vowel,
+// consonant other than w, x or Y; or a vowel then a consonant making up
+// the whole word
+bool endsInShortSyllable(const std::string& word, size_t size) {
+    if (size == 2) return isVowel(word[0]) && !isVowel(word[1]);
+    if (size < 3) return false;
+    char last = word[size - 1];
+    return !isVowel(word[size - 3]) && isVowel(word[size - 2]) && !isVowel(last) &&
+           last != 'w' && last != 'x' && last != 'Y';
+}
+
+struct Rule {
+    std::string_view suffix;
+    std::string_view replacement;
+};
+
+// Longest rule whose suffix ends the word. Porter2 applies only the longest
+// match in each step: if its condition fails, shorter suffixes are not tried.
+// Rules are listed longest first.
+template <size_t N>
+const Rule* longestMatch(const std::string& word, const Rule (&rules)[N]) {
+    if (word.empty()) return nullptr;
+    // Most rules are ruled out by their last letter alone
+    for (const auto& rule : rules) {
+        if (rule.suffix.back() == word.back() && endsWith(word, rule.suffix)) return &rule;
+    }
+    return nullptr;
+}
+
+constexpr Rule STEP2_RULES[] = {
+    {"ization", "ize"}, {"ational", "ate"}, {"fulness", "ful"}, {"ousness", "ous"}, {"iveness", "ive"},
+    {"tional", "tion"}, {"biliti", "ble"}, {"lessli", "less"},
+    {"entli", "ent"}, {"ation", "ate"}, {"alism", "al"}, {"aliti", "al"}, {"ousli", "ous"}, {"iviti", "ive"},
+    {"fulli", "ful"},
+    {"enci", "ence"}, {"anci", "ance"}, {"abli", "able"}, {"izer", "ize"}, {"ator", "ate"}, {"alli", "al"},
+    {"bli", "ble"}, {"ogi", "og"},
+    {"li", ""}
+};
+
+constexpr Rule STEP3_RULES[] = {
+    {"ational", "ate"}, {"tional", "tion"}, {"alize", "al"}, {"icate", "ic"}, {"iciti", "ic"},
+    {"ative", ""}, {"ical", "ic"}, {"ness", ""}, {"ful", ""}
+};
+
+constexpr Rule STEP4_RULES[] = {
+    {"ement", ""}, {"ance", ""}, {"ence", ""}, {"able", ""}, {"ible", ""}, {"ment", ""},
+    {"ant", ""}, {"ent", ""}, {"ism", ""}, {"ate", ""}, {"iti", ""}, {"ous", ""}, {"ive", ""}, {"ize", ""},
+    {"ion", ""}, {"al", ""}, {"er", ""}, {"ic", ""}
+};
+
+struct Exception {
+    std::string_view word;
+    std::string_view stem;
+};
+
+constexpr Exception EXCEPTIONAL_FORMS[] = {
+    {"skis", "ski"}, {"skies", "sky"}, {"dying", "die"}, {"lying", "lie"}, {"tying", "tie"},
+    {"idly", "idl"}, {"gently", "gentl"}, {"ugly", "ugli"}, {"early", "earli"}, {"only", "onli"},
+    {"singly", "singl"}, {"sky", "sky"}, {"news", "news"}, {"howe", "howe"}, {"atlas", "atlas"},
+    {"cosmos", "cosmos"}, {"bias", "bias"}, {"andes", "andes"}
+};
+
+constexpr std::string_view INVARIANT_AFTER_STEP_1A[] = {
+    "inning", "outing", "canning", "herring", "earring", "proceed", "exceed", "succeed"
+};
+
+class Porter2 {
+public:
+    explicit Porter2(std::string& word) : w_(word) {}
+
+    void run() {
+        prelude();
+        markRegions();
+        step0();
+        if (step1a()) {
+            step1b();
+            step1c();
+            step2();
+            step3();
+            step4();
+            step5();
+        }
+        std::replace(w_.begin(), w_.end(), 'Y', 'y');
+    }
+
+private:
+    std::string& w_;
+    size_t r1_ = 0;
+    size_t r2_ = 0;
+
+    // Suffix of the given length starts inside R1 / R2
+    bool inR1(size_t suffix_size) const { return w_.size() >= suffix_size && w_.size() - suffix_size >= r1_; }
+    bool inR2(size_t suffix_size) const { return w_.size() >= suffix_size && w_.size() - suffix_size >= r2_; }
+
+    void replaceSuffix(size_t suffix_size, std::string_view replacement) {
+        w_.resize(w_.size() - suffix_size);
+        w_.append(replacement);
+    }
+
+    bool hasVowelBefore(size_t end) const {
+        return std::any_of(w_.begin(), w_.begin() + static_cast<std::ptrdiff_t>(end), isVowel);
+    }
+
+    bool isShort() const { return r1_ >= w_.size() && endsInShortSyllable(w_, w_.size()); }
+
+    void prelude() {
+        if (w_[0] == '\'') w_.erase(0, 1);
+        for (size_t i = 0; i < w_.size(); ++i) {
+            if (w_[i] == 'y' && (i == 0 || isVowel(w_[i - 1]))) w_[i] = 'Y';
+        }
+    }
+
+    // Region after the first consonant that follows a vowel, from `start`
+    size_t regionAfter(size_t start) const {
+        size_t i = start;
+        while (i < w_.size() && !isVowel(w_[i])) ++i;
+        while (i < w_.size() && isVowel(w_[i])) ++i;
+        return std::min(i + 1, w_.size());
+    }
+
+    void markRegions() {
+        if (w_.rfind("gener", 0) == 0 || w_.rfind("arsen", 0) == 0) {
+            r1_ = 5;
+        } else if (w_.rfind("commun", 0) == 0) {
+            r1_ = 6;
+        } else {
+            r1_ = regionAfter(0);
+        }
+        r2_ = regionAfter(r1_);
+    }
+
+    void step0() {
+        for (std::string_view suffix : {"'s'", "'s", "'"}) {
+            if (endsWith(w_, suffix)) {
+                w_.resize(w_.size() - suffix.size());
+                return;
+            }
+        }
+    }
+
+    // Returns false when the word is one that stemming stops at
+    bool step1a() {
+        if (endsWith(w_, "sses")) {
+            replaceSuffix(4, "ss");
+        } else if (endsWith(w_, "ied") || endsWith(w_, "ies")) {
+            replaceSuffix(3, w_.size() > 4 ? "i" : "ie");
+        } else if (endsWith(w_, "us") || endsWith(w_, "ss")) {
+            // unchanged
+        } else if (endsWith(w_, "s") && w_.size() >= 2 && hasVowelBefore(w_.size() - 2)) {
+            w_.pop_back();
+        }
+        return std::find(std::begin(INVARIANT_AFTER_STEP_1A), std::end(INVARIANT_AFTER_STEP_1A), w_) ==
+               std::end(INVARIANT_AFTER_STEP_1A);
+    }
+
+    void step1b() {
+        for (std::string_view suffix : {"eedly", "eed"}) {
+            if (endsWith(w_, suffix)) {
+                if (inR1(suffix.size())) replaceSuffix(suffix.size(), "ee");
+                return;
+            }
+        }
+        for (std::string_view suffix : {"ingly", "edly", "ing", "ed"}) {
+            if (!endsWith(w_, suffix)) continue;
+            if (!hasVowelBefore(w_.size() - suffix.size())) return;
+
+            w_.resize(w_.size() - suffix.size());
+            if (endsWith(w_, "at") || endsWith(w_, "bl") || endsWith(w_, "iz")) {
+                w_.push_back('e');
+            } else if (isDouble(w_)) {
+                w_.pop_back();
+            } else if (isShort()) {
+                w_.push_back('e');
+            }
+            return;
+        }
+    }
+
+    void step1c() {
+        size_t n = w_.size();
+        if (n > 2 && (w_[n - 1] == 'y' || w_[n - 1] == 'Y') && !isVowel(w_[n - 2])) {
+            w_[n - 1] = 'i';
+        }
+    }
+
+    void step2() {
+        const Rule* rule = longestMatch(w_, STEP2_RULES);
+        if (!rule || !inR1(rule->suffix.size())) return;
+
+        size_t stem_end = w_.size() - rule->suffix.size();
+        if (rule->suffix == "ogi" && (stem_end == 0 || w_[stem_end - 1] != 'l')) return;
+        if (rule->suffix == "li" && (stem_end == 0 || !isLiEnding(w_[stem_end - 1]))) return;
+        replaceSuffix(rule->suffix.size(), rule->replacement);
+    }
+
+    void step3() {
+        const Rule* rule = longestMatch(w_, STEP3_RULES);
+        if (!rule || !inR1(rule->suffix.size())) return;
+        if (rule->suffix == "ative" && !inR2(rule->suffix.size())) return;
+        replaceSuffix(rule->suffix.size(), rule->replacement);
+    }
+
+    void step4() {
+        const Rule* rule = longestMatch(w_, STEP4_RULES);
+        if (!rule || !inR2(rule->suffix.size())) return;
+
+        size_t stem_end = w_.size() - rule->suffix.size();
+        if (rule->suffix == "ion" && (stem_end == 0 || (w_[stem_end - 1] != 's' && w_[stem_end - 1] != 't'))) return;
+        w_.resize(stem_end);
+    }
+
+    void step5() {
+        if (w_.empty()) return;
+        if (w_.back() == 'e') {
+            if (inR2(1) || (inR1(1) && !endsInShortSyllable(w_, w_.size() - 1))) w_.pop_back();
+        } else if (w_.back() == 'l') {
+            if (inR2(1) && w_.size() >= 2 && w_[w_.size() - 2] == 'l') w_.pop_back();
+        }
+    }
+};
+
+uint32_t cacheHash(std::string_view word) {
+    uint32_t hash = 2166136261u;
+    for (char c : word) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+}
+
+bool isStopWord(std::string_view word) {
+    if (word.empty() || word.size() > LONGEST_STOP_WORD) return false;
+    uint8_t slot = STOP_WORD_TABLE.slots[stopWordSlot(word, STOP_WORD_TABLE.seed)];
+    return slot != 0 && STOP_WORDS[slot - 1] == word;
+}
+
+void stemWord(std::string_view word, std::string& out) {
+    for (const auto& exception : EXCEPTIONAL_FORMS) {
+        if (exception.word == word) {
+            out.assign(exception.stem);
+            return;
+        }
+    }
+    out.assign(word);
+    if (out.size() <= 2) return;
+    Porter2(out).run();
+}
+
+StemCache::StemCache(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    entries_.resize(size);
+}
+
+std::string_view StemCache::stem(std::string_view word) {
+    if (word.empty() || word.size() > MAX_CACHED_WORD) {
+        stemWord(word, scratch_);
+        return scratch_;
+    }
+
+    auto holds = [&](const Entry& entry) {
+        return entry.word_size == word.size() && std::memcmp(entry.word, word.data(), word.size()) == 0;
+    };
+    Entry* set = &entries_[(cacheHash(word) & (entries_.size() / 2 - 1)) * 2];
+    if (!holds(set[0])) {
+        if (holds(set[1])) {
+            std::swap(set[0], set[1]);
+        } else {
+            // Stems are never longer than their words, so they fit the entry
+            stemWord(word, scratch_);
+            set[1] = set[0];
+            std::memcpy(set[0].word, word.data(), word.size());
+            std::memcpy(set[0].stem, scratch_.data(), scratch_.size());
+            set[0].word_size = static_cast<uint8_t>(word.size());
+            set[0].stem_size = static_cast<uint8_t>(scratch_.size());
+        }
+    }
+    return {set[0].stem, set[0].stem_size};
+}
+
+}
@@ -0,0 +1,217 @@
+#include "book_recommender/TextNormalizer.hpp"
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace book_recommender {
+
+namespace {
+
+// Output cursor. A whitespace run only marks a space as pending; the space
+// is written before the next visible character, which collapses runs and
+// drops leading and trailing whitespace without a second pass. Output
+// never ends with a space.
+struct Writer {
+    char* out;
+    size_t size = 0;
+    bool pending_space = false;
+
+    void space() {
+        if (size > 0) pending_space = true;
+    }
+
+    void put(unsigned char c) {
+        if (pending_space) {
+            out[size++] = ' ';
+            pending_space = false;
+        }
+        out[size++] = static_cast<char>(c);
+    }
+
+    // Code points in [0x80, 0x800)
+    void put2(uint32_t cp) {
+        put(static_cast<unsigned char>(0xC0 | (cp >> 6)));
+        out[size++] = static_cast<char>(0x80 | (cp & 0x3F));
+    }
+};
+
+bool isAsciiSpace(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+bool isAsciiPunct(unsigned char c) {
+    return (c >= '!' && c <= '/') || (c >= ':' && c <= '@') || (c >= '[' && c <= '`') || (c >= '{' && c <= '~');
+}
+
+bool isContinuation(unsigned char c) {
+    return (c & 0xC0) == 0x80;
+}
+
+// Simple lowercase mapping for two-byte capitals whose lowercase form is
+// also two bytes, so folding never changes the length
+uint32_t foldTwoByte(uint32_t cp) {
+    auto even_pair = [](uint32_t c) { return (c & 1) == 0 ? c + 1 : c; };
+    auto odd_pair = [](uint32_t c) { return (c & 1) == 1 ? c + 1 : c; };
+
+    if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) return cp + 0x20;
+    if (cp < 0x100) return cp;
+    // Latin Extended-A
+    if ((cp <= 0x12F) || (cp >= 0x132 && cp <= 0x137) || (cp >= 0x14A && cp <= 0x177)) return even_pair(cp);
+    if ((cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E)) return odd_pair(cp);
+    if (cp == 0x178) return 0xFF;
+    // Greek
+    if (cp == 0x386) return 0x3AC;
+    if (cp >= 0x388 && cp <= 0x38A) return cp + 0x25;
+    if (cp == 0x38C) return 0x3CC;
+    if (cp == 0x38E || cp == 0x38F) return cp + 0x3F;
+    if (cp >= 0x391 && cp <= 0x3AB && cp != 0x3A2) return cp + 0x20;
+    // Cyrillic
+    if (cp >= 0x400 && cp <= 0x40F) return cp + 0x50;
+    if (cp >= 0x410 && cp <= 0x42F) return cp + 0x20;
+    if ((cp >= 0x460 && cp <= 0x481) || (cp >= 0x48A && cp <= 0x4BF) || (cp >= 0x4D0 && cp <= 0x52F)) return even_pair(cp);
+    if (cp >= 0x4C1 && cp <= 0x4CE) return odd_pair(cp);
+    return cp;
+}
+
+bool isTwoBytePunct(uint32_t cp) {
+    switch (cp) {
+        case 0xA1: case 0xA7: case 0xAB: case 0xB6: case 0xB7: case 0xBB: case 0xBF:  // ¡ § « ¶ · » ¿
+        case 0x37E: case 0x387:  // Greek question mark and ano teleia
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool isThreeByteSpace(uint32_t cp) {
+    return (cp >= 0x2000 && cp <= 0x200A) || cp == 0x2028 || cp == 0x2029 || cp == 0x202F ||
+           cp == 0x205F || cp == 0x1680 || cp == 0x3000;
+}
+
+bool isThreeBytePunct(uint32_t cp) {
+    // General Punctuation (dashes, quotes, ellipsis, invisible formatting),
+    // CJK punctuation and brackets, and the byte order mark
+    return (cp >= 0x2000 && cp <= 0x206F) || (cp >= 0x3001 && cp <= 0x3003) ||
+           (cp >= 0x3008 && cp <= 0x3011) || (cp >= 0x3014 && cp <= 0x301F) || cp == 0xFEFF;
+}
+
+// Normalizes the code point starting at in[i] and returns the index after it
+size_t step(const unsigned char* in, size_t i, size_t n, Writer& writer) {
+    unsigned char c = in[i];
+    if (c < 0x80) {
+        if (c >= 'A' && c <= 'Z') {
+            writer.put(static_cast<unsigned char>(c + ('a' - 'A')));
+        } else if (isAsciiSpace(c)) {
+            writer.space();
+        } else if (!isAsciiPunct(c)) {
+            writer.put(c);
+        }
+        return i + 1;
+    }
+
+    if (c >= 0xC2 && c <= 0xDF && i + 1 < n && isContinuation(in[i + 1])) {
+        uint32_t cp = (uint32_t{c} & 0x1F) << 6 | (in[i + 1] & 0x3F);
+        if (cp == 0x85 || cp == 0xA0) {
+            writer.space();
+        } else if (!isTwoBytePunct(cp)) {
+            writer.put2(foldTwoByte(cp));
+        }
+        return i + 2;
+    }
+
+    if ((c & 0xF0) == 0xE0 && i + 2 < n && isContinuation(in[i + 1]) && isContinuation(in[i + 2])) {
+        uint32_t cp = (uint32_t{c} & 0x0F) << 12 | (uint32_t{in[i + 1]} & 0x3F) << 6 | (in[i + 2] & 0x3F);
+        if (isThreeByteSpace(cp)) {
+            writer.space();
+        } else if (!isThreeBytePunct(cp)) {
+            writer.put(c);
+            writer.put(in[i + 1]);
+            writer.put(in[i + 2]);
+        }
+        return i + 3;
+    }
+
+    // Four-byte sequences and malformed bytes are copied through byte by byte
+    writer.put(c);
+    return i + 1;
+}
+
+#if defined(__SSE2__)
+__m128i inRange(__m128i bytes, char low, char high) {
+    // Signed compares are exact here: the block is all ASCII
+    return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(static_cast<char>(low - 1))),
+                         _mm_cmplt_epi8(bytes, _mm_set1_epi8(static_cast<char>(high + 1))));
+}
+
+// Normalizes in[i, i + 16) in one go when it is plain ASCII text: letters,
+// digits and isolated spaces. Returns false, writing nothing, otherwise.
+bool stepBlock(const unsigned char* in, size_t i, Writer& writer) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    if (_mm_movemask_epi8(bytes) != 0) return false;
+
+    __m128i upper = inRange(bytes, 'A', 'Z');
+    __m128i plain = _mm_or_si128(upper, _mm_or_si128(inRange(bytes, 'a', 'z'), inRange(bytes, '0', '9')));
+    unsigned spaces = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '))));
+    unsigned plains = static_cast<unsigned>(_mm_movemask_epi8(plain));
+    if ((plains | spaces) != 0xFFFF || (spaces & (spaces >> 1)) != 0) return false;
+    // A leading space must not start the output or follow a pending one
+    if ((spaces & 1) && (writer.size == 0 || writer.pending_space)) return false;
+
+    if (writer.pending_space) {
+        writer.out[writer.size++] = ' ';
+        writer.pending_space = false;
+    }
+    __m128i lowered = _mm_add_epi8(bytes, _mm_and_si128(upper, _mm_set1_epi8('a' - 'A')));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(writer.out + writer.size), lowered);
+    writer.size += 16;
+    if (spaces & 0x8000) {
+        --writer.size;
+        writer.pending_space = true;
+    }
+    return true;
+}
+#endif
+
+}
+
+size_t normalizeText(std::string_view text, char* out) {
+    const auto* in = reinterpret_cast<const unsigned char*>(text.data());
+    size_t n = text.size();
+    Writer writer{out};
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    // Every consumed byte writes at most one byte (a pending space stands
+    // in for a whitespace byte already consumed), so a 16-byte store at the
+    // cursor stays within the first n bytes of `out`
+    while (i + 16 <= n) {
+        if (stepBlock(in, i, writer)) {
+            i += 16;
+            continue;
+        }
+        size_t block_end = i + 16;
+        while (i < block_end) {
+            i = step(in, i, n, writer);
+        }
+    }
+#endif
+    while (i < n) {
+        i = step(in, i, n, writer);
+    }
+    return writer.size;
+}
+
+void normalizeText(std::string_view text, std::string& out) {
+    out.resize(text.size());
+    out.resize(normalizeText(text, out.data()));
+}
+
+std::string normalizeText(std::string_view text) {
+    std::string out;
+    normalizeText(text, out);
+    return out;
+}
+
+}
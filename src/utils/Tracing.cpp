@@ -0,0 +1,276 @@
+#include "book_recommender/Tracing.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+namespace book_recommender {
+
+struct SpanRecord {
+    uint64_t span_id;
+    uint64_t parent_id;
+    std::string name;
+    int64_t start_ns;
+    int64_t end_ns;
+    bool has_error;
+    std::string error_message;
+    std::vector<std::pair<const char*, Span::AttributeValue>> attributes;
+};
+
+struct TraceState {
+    uint64_t trace_id_high;
+    uint64_t trace_id_low;
+    std::mutex mutex;
+    std::vector<SpanRecord> finished;
+};
+
+namespace {
+
+thread_local std::shared_ptr<TraceState> current_trace;
+thread_local uint64_t current_span_id = 0;
+// Set while a root that lost the sampling draw is open, so its nested
+// spans stay inert instead of drawing again and starting traces of their own
+thread_local bool current_unsampled = false;
+
+uint64_t randomId() {
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    uint64_t id;
+    do {
+        id = rng();
+    } while (id == 0);  // zero means "no parent" in OTLP
+    return id;
+}
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+std::string toHex(uint64_t value) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+std::string traceIdHex(const TraceState& trace) {
+    return toHex(trace.trace_id_high) + toHex(trace.trace_id_low);
+}
+
+nlohmann::json otlpValue(const Span::AttributeValue& value) {
+    return std::visit([](const auto& v) -> nlohmann::json {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::string>) {
+            return {{"stringValue", v}};
+        } else if constexpr (std::is_same_v<T, int64_t>) {
+            // OTLP/JSON encodes 64-bit integers as strings
+            return {{"intValue", std::to_string(v)}};
+        } else if constexpr (std::is_same_v<T, double>) {
+            return {{"doubleValue", v}};
+        } else {
+            return {{"boolValue", v}};
+        }
+    }, value);
+}
+
+}
+
+void Tracer::configure(const TracingConfig& config) {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    if (sink_.is_open()) {
+        sink_.close();
+    }
+
+    service_name_ = config.service_name;
+    sample_rate_.store(config.sample_rate, std::memory_order_relaxed);
+
+    if (config.sample_rate <= 0.0) {
+        enabled_.store(false, std::memory_order_relaxed);
+        return;
+    }
+
+    sink_.open(config.output_path, std::ios::app);
+    if (!sink_) {
+        spdlog::warn("Could not open trace output {}; tracing disabled", config.output_path);
+        enabled_.store(false, std::memory_order_relaxed);
+        return;
+    }
+
+    enabled_.store(true, std::memory_order_relaxed);
+    spdlog::info("Tracing {:.1f}% of requests to {}", config.sample_rate * 100.0, config.output_path);
+}
+
+void Tracer::disable() {
+    enabled_.store(false, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    if (sink_.is_open()) {
+        sink_.close();
+    }
+}
+
+bool Tracer::shouldSample() const {
+    double rate = sample_rate_.load(std::memory_order_relaxed);
+    if (rate >= 1.0) return true;
+
+    thread_local std::mt19937 rng(std::random_device{}());
+    return std::uniform_real_distribution<double>(0.0, 1.0)(rng) < rate;
+}
+
+void Tracer::exportTrace(TraceState& trace) {
+    std::vector<SpanRecord> spans;
+    {
+        std::lock_guard<std::mutex> lock(trace.mutex);
+        spans.swap(trace.finished);
+    }
+
+    std::string trace_id = traceIdHex(trace);
+    nlohmann::json otlp_spans = nlohmann::json::array();
+    for (const auto& span : spans) {
+        nlohmann::json attributes = nlohmann::json::array();
+        for (const auto& [key, value] : span.attributes) {
+            attributes.push_back({{"key", key}, {"value", otlpValue(value)}});
+        }
+
+        nlohmann::json otlp_span = {
+            {"traceId", trace_id},
+            {"spanId", toHex(span.span_id)},
+            {"name", span.name},
+            {"kind", 1},  // SPAN_KIND_INTERNAL
+            {"startTimeUnixNano", std::to_string(span.start_ns)},
+            {"endTimeUnixNano", std::to_string(span.end_ns)},
+            {"attributes", attributes}
+        };
+        if (span.parent_id != 0) {
+            otlp_span["parentSpanId"] = toHex(span.parent_id);
+        }
+        if (span.has_error) {
+            otlp_span["status"] = {{"code", 2}, {"message", span.error_message}};  // STATUS_CODE_ERROR
+        }
+        otlp_spans.push_back(std::move(otlp_span));
+    }
+
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    if (!sink_.is_open()) return;
+
+    nlohmann::json request = {
+        {"resourceSpans", {{
+            {"resource", {{"attributes", {{
+                {"key", "service.name"},
+                {"value", {{"stringValue", service_name_}}}
+            }}}}},
+            {"scopeSpans", {{
+                {"scope", {{"name", "book_recommender"}}},
+                {"spans", otlp_spans}
+            }}}
+        }}}
+    };
+    sink_ << request.dump() << '\n';
+    sink_.flush();
+}
+
+Span::Span(const char* name) : name_(name) {
+    if (current_trace) {
+        trace_ = current_trace;
+        parent_id_ = current_span_id;
+    } else if (current_unsampled) {
+        return;
+    } else {
+        auto& tracer = Tracer::getInstance();
+        if (!tracer.isEnabled()) {
+            return;
+        }
+        if (!tracer.shouldSample()) {
+            current_unsampled = true;
+            is_root_ = true;
+            return;
+        }
+        trace_ = std::make_shared<TraceState>();
+        trace_->trace_id_high = randomId();
+        trace_->trace_id_low = randomId();
+        current_trace = trace_;
+        is_root_ = true;
+    }
+
+    span_id_ = randomId();
+    current_span_id = span_id_;
+    start_ns_ = nowNanos();
+}
+
+Span::~Span() {
+    if (!trace_) {
+        if (is_root_) current_unsampled = false;
+        return;
+    }
+
+    SpanRecord record{
+        span_id_,
+        parent_id_,
+        name_,
+        start_ns_,
+        nowNanos(),
+        has_error_,
+        std::move(error_message_),
+        std::move(attributes_)
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(trace_->mutex);
+        trace_->finished.push_back(std::move(record));
+    }
+
+    current_span_id = parent_id_;
+    if (is_root_) {
+        current_trace.reset();
+        Tracer::getInstance().exportTrace(*trace_);
+    }
+}
+
+void Span::setAttribute(const char* key, const std::string& value) {
+    if (trace_) attributes_.emplace_back(key, value);
+}
+
+void Span::setAttribute(const char* key, const char* value) {
+    if (trace_) attributes_.emplace_back(key, std::string(value));
+}
+
+void Span::setAttribute(const char* key, int64_t value) {
+    if (trace_) attributes_.emplace_back(key, value);
+}
+
+void Span::setAttribute(const char* key, double value) {
+    if (trace_) attributes_.emplace_back(key, value);
+}
+
+void Span::setAttribute(const char* key, bool value) {
+    if (trace_) attributes_.emplace_back(key, value);
+}
+
+void Span::setError(const std::string& message) {
+    if (!trace_) return;
+    has_error_ = true;
+    error_message_ = message;
+}
+
+std::string Span::currentTraceId() {
+    return current_trace ? traceIdHex(*current_trace) : std::string();
+}
+
+TraceContext Span::currentContext() {
+    return {current_trace, current_span_id, current_unsampled};
+}
+
+ScopedTraceContext::ScopedTraceContext(TraceContext context)
+    : previous_{current_trace, current_span_id, current_unsampled} {
+    current_trace = std::move(context.trace);
+    current_span_id = context.span_id;
+    current_unsampled = context.unsampled;
+}
+
+ScopedTraceContext::~ScopedTraceContext() {
+    current_trace = std::move(previous_.trace);
+    current_span_id = previous_.span_id;
+    current_unsampled = previous_.unsampled;
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <book_recommender/Book.hpp>
+#include <book_recommender/Document.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace book_recommender::fixtures {
+
+// A complete Book whose remaining fields are derived from its id
+inline Book makeBook(const std::string& id, const std::string& author, double rating, int ratings_count,
+                     std::vector<std::string> genres = {"fantasy"},
+                     std::optional<std::string> series = std::nullopt) {
+    return Book(id, "Title " + id, author, std::move(genres), "Description of " + id,
+                300, rating, ratings_count, ratings_count / 10, std::move(series),
+                "en", "Publisher", "2019-05-01", "97800000000" + id, false);
+}
+
+// The document the vector store would index for `book`
+inline Document makeDocument(const Book& book, Document::Embedding embedding) {
+    Document::Metadata metadata{
+        {"title", book.getTitle()},
+        {"author", book.getAuthor()},
+        {"genres", book.getGenres()},
+        {"page_count", book.getPageCount()},
+        {"average_rating", book.getAverageRating()},
+        {"ratings_count", book.getRatingsCount()},
+        {"review_count", book.getReviewCount()},
+        {"language", book.getLanguage()},
+        {"publisher", book.getPublisher()},
+        {"publication_date", book.getPublicationDate()},
+        {"isbn13", book.getIsbn13()},
+        {"is_ebook", book.isEbook()}
+    };
+    return Document(book.getId(), book.getDescription(), std::move(metadata), std::move(embedding));
+}
+
+// Ids of search results or graph neighbours, in order
+template <typename Results>
+std::vector<std::string> ids(const Results& results) {
+    std::vector<std::string> out;
+    for (const auto& result : results) out.push_back(result.doc_id);
+    return out;
+}
+
+}
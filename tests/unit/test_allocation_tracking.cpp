@@ -0,0 +1,45 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/AllocationTracking.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace book_recommender;
+
+TEST_CASE("AllocationScope Counting", "[allocation]") {
+    AllocationScope scope;
+
+    std::vector<std::unique_ptr<int>> values;
+    values.reserve(8);
+    for (int i = 0; i < 8; ++i) {
+        values.push_back(std::make_unique<int>(i));
+    }
+    values.clear();
+
+    auto stats = scope.stats();
+    if (!AllocationScope::isTrackingEnabled()) {
+        REQUIRE(stats.allocations == 0);
+        return;
+    }
+
+    // One allocation for the reserve plus one per element
+    REQUIRE(stats.allocations == 9);
+    REQUIRE(stats.deallocations == 8);
+    REQUIRE(stats.bytes >= 8 * sizeof(int) + 8 * sizeof(void*));
+}
+
+TEST_CASE("CountingMemoryResource", "[allocation]") {
+    CountingMemoryResource resource;
+
+    {
+        std::pmr::vector<std::pmr::string> strings(&resource);
+        strings.reserve(4);
+        strings.emplace_back("a string that is long enough to need the heap");
+        REQUIRE(resource.bytesInUse() > 0);
+    }
+
+    auto stats = resource.stats();
+    REQUIRE(stats.allocations == 2);
+    REQUIRE(stats.deallocations == 2);
+    REQUIRE(resource.bytesInUse() == 0);
+}
@@ -0,0 +1,67 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/AsyncTask.hpp>
+
+#ifdef BOOK_RECOMMENDER_COROUTINES
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace book_recommender;
+
+namespace {
+
+AsyncTask<int> answer() {
+    co_return 42;
+}
+
+AsyncTask<std::string> describe() {
+    int value = co_await answer();
+    co_return "answer=" + std::to_string(value);
+}
+
+AsyncTask<int> failing() {
+    throw std::runtime_error("boom");
+    co_return 0;
+}
+
+AsyncTask<std::thread::id> onPool(TaskExecutor& executor) {
+    co_await resumeOn(TaskPriority::Interactive, executor);
+    co_return std::this_thread::get_id();
+}
+
+AsyncTask<int> square(TaskExecutor& executor, int value) {
+    co_await resumeOn(TaskPriority::Background, executor);
+    co_return value * value;
+}
+
+}
+
+TEST_CASE("AsyncTask chains awaits and propagates exceptions", "[async]") {
+    REQUIRE(syncWait(describe()) == "answer=42");
+    REQUIRE_THROWS_AS(syncWait(failing()), std::runtime_error);
+}
+
+TEST_CASE("resumeOn moves the coroutine onto an executor worker", "[async]") {
+    TaskExecutor executor(2);
+    REQUIRE(syncWait(onPool(executor)) != std::this_thread::get_id());
+}
+
+TEST_CASE("whenAll runs tasks concurrently and keeps input order", "[async]") {
+    TaskExecutor executor(4);
+    std::vector<AsyncTask<int>> tasks;
+    for (int i = 0; i < 100; ++i) {
+        tasks.push_back(square(executor, i));
+    }
+
+    auto results = syncWait(whenAll(std::move(tasks)));
+    REQUIRE(results.size() == 100);
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(results[i] == i * i);
+    }
+
+    REQUIRE(syncWait(whenAll(std::vector<AsyncTask<int>>{})).empty());
+}
+
+#endif
@@ -0,0 +1,82 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/BookCatalog.hpp>
+#include "book_fixtures.hpp"
+
+using namespace book_recommender;
+using fixtures::makeBook;
+
+TEST_CASE("BookCatalog round-trips books through its columns", "[catalog]") {
+    BookCatalog catalog;
+    Book original = makeBook("1", "Author A", 4.25, 1200, {"fantasy", "adventure"}, "Saga");
+    catalog.upsert(original);
+
+    REQUIRE(catalog.size() == 1);
+    auto view = catalog.find("1");
+    REQUIRE(view.has_value());
+    REQUIRE(view->getId() == "1");
+    REQUIRE(view->getTitle() == "Title 1");
+    REQUIRE(view->getAuthor() == "Author A");
+    REQUIRE(view->getGenres() == std::vector<std::string_view>{"fantasy", "adventure"});
+    REQUIRE(view->getSeries().value() == "Saga");
+    REQUIRE(view->getPublicationYear() == 2019);
+    REQUIRE(view->getPopularityScore() == Approx(original.getPopularityScore()));
+    REQUIRE(view->isHighlyRated() == original.isHighlyRated());
+
+    Book copy = view->toBook();
+    REQUIRE(copy.toJson() == original.toJson());
+    REQUIRE_FALSE(catalog.find("missing").has_value());
+}
+
+TEST_CASE("BookCatalog interns repeated strings", "[catalog]") {
+    BookCatalog catalog;
+    catalog.assign({
+        makeBook("1", "Author A", 4.0, 100, {"fantasy", "romance"}),
+        makeBook("2", "Author A", 3.5, 200, {"fantasy"}),
+        makeBook("3", "Author B", 4.5, 300, {"romance"})
+    });
+
+    REQUIRE(catalog.size() == 3);
+    REQUIRE(catalog.authors().size() == 2);
+    REQUIRE(catalog.genres().size() == 2);
+    REQUIRE(catalog.authorIds()[0] == catalog.authorIds()[1]);
+}
+
+TEST_CASE("BookCatalog updates and removes rows", "[catalog]") {
+    BookCatalog catalog;
+    catalog.assign({
+        makeBook("1", "Author A", 4.0, 100),
+        makeBook("2", "Author B", 3.5, 200),
+        makeBook("3", "Author C", 4.5, 300, {"horror"}, "Series C")
+    });
+
+    catalog.upsert(makeBook("2", "Author B", 4.9, 250, {"mystery"}));
+    REQUIRE(catalog.size() == 3);
+    REQUIRE(catalog.find("2")->getAverageRating() == Approx(4.9));
+    REQUIRE(catalog.find("2")->getGenres() == std::vector<std::string_view>{"mystery"});
+
+    REQUIRE(catalog.remove("1"));
+    REQUIRE_FALSE(catalog.remove("1"));
+    REQUIRE(catalog.size() == 2);
+
+    // The last row moved into the hole keeps all of its fields
+    auto moved = catalog.find("3");
+    REQUIRE(moved.has_value());
+    REQUIRE(moved->getAuthor() == "Author C");
+    REQUIRE(moved->getSeries().value() == "Series C");
+    REQUIRE(moved->getGenres() == std::vector<std::string_view>{"horror"});
+
+    // Churn forces the text heap and genre pool to compact
+    for (int i = 0; i < 50; ++i) {
+        catalog.upsert(makeBook("2", "Author B", 4.0, 100 + i, {"mystery", "thriller"}));
+    }
+    REQUIRE(catalog.find("2")->getRatingsCount() == 149);
+    REQUIRE(catalog.find("2")->getGenres() == std::vector<std::string_view>{"mystery", "thriller"});
+    REQUIRE(catalog.find("3")->getTitle() == "Title 3");
+
+    size_t rows = 0;
+    for (auto view : catalog) {
+        REQUIRE(catalog.find(std::string(view.getId()))->row() == view.row());
+        ++rows;
+    }
+    REQUIRE(rows == catalog.size());
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/BookPreprocessor.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace book_recommender;
+
+TEST_CASE("chunkText splits long text into overlapping windows", "[preprocessor]") {
+    auto chunks = BookPreprocessor::chunkText("a b c d e f g", 4, 2);
+    REQUIRE(chunks == std::vector<std::string>{"a b c d", "c d e f", "e f g"});
+
+    REQUIRE(BookPreprocessor::chunkText("  short   text ", 4, 2) == std::vector<std::string>{"short text"});
+    REQUIRE(BookPreprocessor::chunkText("", 4, 2).empty());
+    REQUIRE_THROWS_AS(BookPreprocessor::chunkText("a b", 0), std::invalid_argument);
+}
+
+TEST_CASE("normalizeGenres maps raw genres onto standard ones", "[preprocessor]") {
+    BookPreprocessor preprocessor;
+
+    auto genres = preprocessor.normalizeGenres({"Sci-Fi", "FANTASY", "Mysteries", "fantasy", "Historical Fiction", "!!"});
+    REQUIRE(genres == std::vector<std::string>{"science-fiction", "fantasy", "mystery", "historical-fiction"});
+
+    // Misspellings go to the closest standard genre, and repeat lookups
+    // come from the cache with the same answer
+    REQUIRE(preprocessor.normalizeGenres({"thriler"}) == std::vector<std::string>{"thriller"});
+    REQUIRE(preprocessor.normalizeGenres({"thriler"}) == std::vector<std::string>{"thriller"});
+}
+
+TEST_CASE("updateGenreMapping takes effect while genres are being normalized", "[preprocessor]") {
+    BookPreprocessor preprocessor;
+    REQUIRE(preprocessor.normalizeGenres({"spooky"}) != std::vector<std::string>{"horror"});
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> lookups{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t] {
+            // A fresh tag per call misses the cache and reads the mappings
+            for (int i = 0; !stop; ++i) {
+                preprocessor.normalizeGenres({"spooky", "tag " + std::to_string(t) + " " + std::to_string(i)});
+                ++lookups;
+            }
+        });
+    }
+    while (lookups < 100) std::this_thread::yield();
+    preprocessor.updateGenreMapping("spooky", "horror");
+    stop = true;
+    for (auto& reader : readers) reader.join();
+
+    // No lookup that began before the update may have cached the old answer
+    REQUIRE(preprocessor.normalizeGenres({"spooky"}) == std::vector<std::string>{"horror"});
+}
+
+TEST_CASE("preprocessText normalizes, drops stop words and stems", "[preprocessor]") {
+    BookPreprocessor preprocessor;
+    REQUIRE(preprocessor.preprocessText("The Detectives' CASES, and their Mysteries!") == "detect case mysteri");
+    REQUIRE(preprocessor.preprocessText("  ... ") == "");
+}
@@ -0,0 +1,108 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/ConcurrencyLimiter.hpp>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace book_recommender;
+
+namespace {
+
+ConcurrencyLimiterConfig fixedLimit(int limit) {
+    ConcurrencyLimiterConfig config;
+    config.initial_limit = limit;
+    config.min_limit = limit;
+    config.max_limit = limit;
+    return config;
+}
+
+void waitForQueued(const ConcurrencyLimiter& limiter, size_t queued) {
+    while (limiter.stats().queued < queued) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+}
+
+TEST_CASE("ConcurrencyLimiter sheds requests that cannot get a slot", "[limiter]") {
+    auto config = fixedLimit(2);
+    config.interactive_queue_timeout = std::chrono::milliseconds(20);
+    ConcurrencyLimiter limiter(config);
+
+    auto first = limiter.acquire();
+    auto second = limiter.acquire();
+    REQUIRE(limiter.stats().in_flight == 2);
+
+    REQUIRE_THROWS_AS(limiter.acquire(), OverloadError);
+    REQUIRE_THROWS_AS(limiter.tryAcquire(), OverloadError);
+    REQUIRE(limiter.stats().rejected == 2);
+    REQUIRE(limiter.stats().queued == 0);
+
+    second = ConcurrencyLimiter::Permit();
+    REQUIRE(limiter.tryAcquire());
+}
+
+TEST_CASE("ConcurrencyLimiter rejects immediately when the queue is full", "[limiter]") {
+    auto config = fixedLimit(1);
+    config.max_queued = 0;
+    ConcurrencyLimiter limiter(config);
+
+    auto held = limiter.acquire();
+    try {
+        limiter.acquire(TaskPriority::Background);
+        FAIL("expected OverloadError");
+    } catch (const OverloadError& e) {
+        REQUIRE(e.retryAfter() > std::chrono::milliseconds(0));
+    }
+}
+
+TEST_CASE("Freed slots go to interactive waiters first", "[limiter]") {
+    ConcurrencyLimiter limiter(fixedLimit(1));
+    auto held = limiter.acquire();
+
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto waiter = [&](TaskPriority priority, const char* name) {
+        auto permit = limiter.acquire(priority);
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(name);
+    };
+
+    std::thread background(waiter, TaskPriority::Background, "background");
+    waitForQueued(limiter, 1);
+    std::thread interactive(waiter, TaskPriority::Interactive, "interactive");
+    waitForQueued(limiter, 2);
+
+    held = ConcurrencyLimiter::Permit();
+    background.join();
+    interactive.join();
+    REQUIRE(order == std::vector<std::string>{"interactive", "background"});
+}
+
+TEST_CASE("The limit follows observed latency", "[limiter]") {
+    ConcurrencyLimiterConfig config;
+    config.initial_limit = 4;
+    config.min_limit = 1;
+    config.max_limit = 100;
+    ConcurrencyLimiter limiter(config);
+
+    // Saturated and fast: no sign of queueing, so the limit grows
+    {
+        std::vector<ConcurrencyLimiter::Permit> permits;
+        for (int i = 0; i < 4; ++i) {
+            permits.push_back(limiter.acquire());
+        }
+    }
+    int grown = limiter.stats().limit;
+    REQUIRE(grown > 4);
+
+    // Requests suddenly take far longer than the baseline: the limit backs off
+    for (int i = 0; i < 10; ++i) {
+        auto permit = limiter.acquire();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    REQUIRE(limiter.stats().limit < grown);
+    REQUIRE(limiter.stats().in_flight == 0);
+}
@@ -0,0 +1,72 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/EditDistance.hpp>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace book_recommender;
+
+namespace {
+
+size_t referenceDistance(const std::string& a, const std::string& b) {
+    std::vector<std::vector<size_t>> dp(a.size() + 1, std::vector<size_t>(b.size() + 1));
+    for (size_t i = 0; i <= a.size(); ++i) dp[i][0] = i;
+    for (size_t j = 0; j <= b.size(); ++j) dp[0][j] = j;
+    for (size_t i = 1; i <= a.size(); ++i) {
+        for (size_t j = 1; j <= b.size(); ++j) {
+            dp[i][j] = std::min({dp[i - 1][j] + 1, dp[i][j - 1] + 1, dp[i - 1][j - 1] + (a[i - 1] != b[j - 1])});
+        }
+    }
+    return dp[a.size()][b.size()];
+}
+
+}
+
+TEST_CASE("editDistance matches the textbook dynamic program", "[edit_distance]") {
+    REQUIRE(editDistance("", "") == 0);
+    REQUIRE(editDistance("", "abc") == 3);
+    REQUIRE(editDistance("kitten", "sitting") == 3);
+    REQUIRE(editDistance("scifi", "sciencefiction") == 9);
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> letter('a', 'd');
+    for (size_t length : {1, 5, 63, 64, 65, 100}) {
+        for (int trial = 0; trial < 20; ++trial) {
+            std::string a(length, ' ');
+            std::string b(length / 2 + trial, ' ');
+            for (auto& c : a) c = static_cast<char>(letter(rng));
+            for (auto& c : b) c = static_cast<char>(letter(rng));
+            REQUIRE(editDistance(a, b) == referenceDistance(a, b));
+            REQUIRE(editDistance(b, a) == referenceDistance(a, b));
+        }
+    }
+}
+
+TEST_CASE("BKTree finds every word within the radius", "[edit_distance]") {
+    std::vector<std::string> words{"fantasy", "fiction", "history", "mystery", "poetry", "romance", "horror"};
+    BKTree tree;
+    for (const auto& word : words) {
+        tree.insert(word);
+    }
+    REQUIRE(tree.insert("history") == 2);
+    REQUIRE(tree.size() == words.size());
+
+    for (const std::string query : {"mistery", "fantasie", "hist", "xyz"}) {
+        for (size_t radius : {0, 1, 2, 3, 5}) {
+            std::vector<size_t> found;
+            tree.search(query, radius, [&](size_t index, size_t distance) {
+                REQUIRE(distance == editDistance(query, tree.word(index)));
+                found.push_back(index);
+                return radius;
+            });
+            std::vector<size_t> expected;
+            for (size_t i = 0; i < words.size(); ++i) {
+                if (editDistance(query, words[i]) <= radius) expected.push_back(i);
+            }
+            std::sort(found.begin(), found.end());
+            REQUIRE(found == expected);
+        }
+    }
+}
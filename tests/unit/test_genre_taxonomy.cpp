@@ -0,0 +1,66 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/GenreTaxonomy.hpp>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace book_recommender;
+
+TEST_CASE("GenreTaxonomy precomputes ancestor and descendant closures", "[genre_taxonomy]") {
+    GenreTaxonomy taxonomy({
+        {"epic-fantasy", "fantasy"},
+        {"fantasy", "fiction"},
+        {"detective", "mystery"},
+        {"detective", "crime"},
+        {"mystery", "fiction"}
+    }, {"poetry"});
+
+    auto epic = *taxonomy.find("Epic-Fantasy");
+    auto fantasy = *taxonomy.find("fantasy");
+    auto fiction = *taxonomy.find("fiction");
+    auto detective = *taxonomy.find("detective");
+    REQUIRE(taxonomy.size() == 7);
+    REQUIRE_FALSE(taxonomy.find("cooking"));
+
+    REQUIRE(taxonomy.isA(epic, fiction));
+    REQUIRE(taxonomy.isA(epic, epic));
+    REQUIRE_FALSE(taxonomy.isA(fantasy, epic));
+    REQUIRE(taxonomy.isA(detective, *taxonomy.find("crime")));
+    REQUIRE(taxonomy.descendants(fiction).contains(detective));
+    REQUIRE_FALSE(taxonomy.descendants(*taxonomy.find("crime")).contains(fantasy));
+
+    // A filter on "fantasy" accepts epic fantasy but not mysteries
+    std::vector<std::string> unknown;
+    auto accepted = taxonomy.matchSet({"fantasy", "cooking"}, &unknown);
+    REQUIRE(unknown == std::vector<std::string>{"cooking"});
+    REQUIRE(taxonomy.genreSet({"epic-fantasy"}).intersects(accepted));
+    REQUIRE_FALSE(taxonomy.genreSet({"detective", "poetry"}).intersects(accepted));
+    REQUIRE_FALSE(taxonomy.genreSet({"cooking"}).intersects(accepted));
+}
+
+TEST_CASE("GenreTaxonomy rejects cycles and loads from files", "[genre_taxonomy]") {
+    REQUIRE_THROWS_AS(GenreTaxonomy({{"a", "b"}, {"b", "c"}, {"c", "a"}}), std::invalid_argument);
+    REQUIRE_THROWS_AS(GenreTaxonomy(std::vector<GenreTaxonomy::Edge>{{"a", "a"}}), std::invalid_argument);
+
+    std::string path = "test_genre_taxonomy.txt";
+    {
+        std::ofstream file(path);
+        file << "# child parent\n"
+             << "space-opera science-fiction\n"
+             << "\n"
+             << "science-fiction fiction\n"
+             << "poetry\n";
+    }
+    auto taxonomy = GenreTaxonomy::loadFromFile(path);
+    std::remove(path.c_str());
+
+    REQUIRE(taxonomy.size() == 4);
+    REQUIRE(taxonomy.isA(*taxonomy.find("space-opera"), *taxonomy.find("fiction")));
+    REQUIRE(taxonomy.find("poetry"));
+    REQUIRE_THROWS(GenreTaxonomy::loadFromFile("missing_taxonomy.txt"));
+
+    auto standard = GenreTaxonomy::defaultTaxonomy();
+    REQUIRE(standard.isA(*standard.find("cozy-mystery"), *standard.find("fiction")));
+}
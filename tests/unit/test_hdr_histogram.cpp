@@ -0,0 +1,72 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/HdrHistogram.hpp>
+
+using namespace book_recommender;
+
+TEST_CASE("HdrHistogram Recording", "[hdr_histogram]") {
+    HdrHistogram histogram(1, 3600LL * 1000 * 1000, 3);
+
+    SECTION("Empty Histogram") {
+        REQUIRE(histogram.getTotalCount() == 0);
+        REQUIRE(histogram.getValueAtPercentile(99.0) == 0);
+        REQUIRE(histogram.getMin() == 0);
+    }
+
+    SECTION("Percentiles Within Precision") {
+        for (int64_t v = 1; v <= 10000; ++v) {
+            histogram.recordValue(v);
+        }
+
+        REQUIRE(histogram.getTotalCount() == 10000);
+        REQUIRE(histogram.getMin() == 1);
+        REQUIRE(histogram.getMax() == 10000);
+        REQUIRE(histogram.getValueAtPercentile(50.0) == Approx(5000).epsilon(0.001));
+        REQUIRE(histogram.getValueAtPercentile(99.0) == Approx(9900).epsilon(0.001));
+        REQUIRE(histogram.getValueAtPercentile(100.0) == 10000);
+        REQUIRE(histogram.getMean() == Approx(5000.5).epsilon(0.001));
+    }
+
+    SECTION("Large Values Keep Relative Precision") {
+        histogram.recordValue(123456789);
+        auto value = histogram.getValueAtPercentile(50.0);
+        REQUIRE(value == Approx(123456789).epsilon(0.001));
+    }
+
+    SECTION("Out Of Range Values Are Clamped") {
+        histogram.recordValue(-5);
+        histogram.recordValue(histogram.getHighestTrackableValue() * 2);
+        REQUIRE(histogram.getTotalCount() == 2);
+        REQUIRE(histogram.getMax() == histogram.getHighestTrackableValue());
+    }
+}
+
+TEST_CASE("HdrHistogram Coordinated Omission Correction", "[hdr_histogram]") {
+    HdrHistogram histogram;
+
+    // 99 fast responses, then one stall that blocked 99 further requests
+    for (int i = 0; i < 99; ++i) {
+        histogram.recordCorrectedValue(10, 100);
+    }
+    histogram.recordCorrectedValue(10000, 100);
+
+    REQUIRE(histogram.getTotalCount() == 199);
+    REQUIRE(histogram.getValueAtPercentile(50.0) > 10);
+    REQUIRE(histogram.getValueAtPercentile(99.0) >= 9800);
+}
+
+TEST_CASE("HdrHistogram Merge", "[hdr_histogram]") {
+    HdrHistogram a;
+    HdrHistogram b;
+    HdrHistogram coarse(1000, 3600LL * 1000 * 1000, 2);
+
+    a.recordValue(100);
+    b.recordValue(300);
+    coarse.recordValue(200000);
+
+    a.add(b);
+    a.add(coarse);
+
+    REQUIRE(a.getTotalCount() == 3);
+    REQUIRE(a.getMin() == 100);
+    REQUIRE(a.getMax() >= 199000);
+}
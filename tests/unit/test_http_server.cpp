@@ -0,0 +1,193 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/HttpServer.hpp>
+#include <book_recommender/WorkerPool.hpp>
+#include <atomic>
+#include <future>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <cpprest/http_client.h>
+
+using namespace book_recommender;
+
+namespace {
+
+HttpServerConfig loopbackConfig() {
+    // Random high port so concurrent test runs do not collide
+    static std::mt19937 rng(std::random_device{}());
+    HttpServerConfig config;
+    config.address = "127.0.0.1";
+    config.port = std::uniform_int_distribution<int>(20000, 60000)(rng);
+    config.worker_threads = 2;
+    return config;
+}
+
+}
+
+TEST_CASE("WorkerPool runs queued tasks and refuses work beyond the queue limit", "[server]") {
+    WorkerPool pool(1, 1);
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<bool> started{false};
+    std::atomic<int> completed{0};
+
+    REQUIRE(pool.trySubmit([&] { started = true; released.wait(); ++completed; }));
+    while (!started) {
+        std::this_thread::yield();
+    }
+    REQUIRE(pool.trySubmit([&] { ++completed; }));
+    REQUIRE(pool.queueDepth() == 1);
+    REQUIRE_FALSE(pool.trySubmit([&] { ++completed; }));
+
+    release.set_value();
+    pool.shutdown();
+    REQUIRE(completed == 2);
+    REQUIRE_FALSE(pool.trySubmit([] {}));
+}
+
+TEST_CASE("HttpServer routes requests over loopback", "[server]") {
+    HttpServer server(loopbackConfig());
+    server.route("GET", "/echo", [](const HttpRequest& request) {
+        return HttpResponse::json({{"name", request.param("name")}});
+    });
+    server.route("GET", "/fail", [](const HttpRequest& request) -> HttpResponse {
+        throw std::invalid_argument("bad " + request.param("what"));
+    });
+    server.start();
+
+    web::http::client::http_client client(server.url());
+
+    auto echo = client.request(web::http::methods::GET, "/echo?name=Ursula%20K.+Le%20Guin").get();
+    REQUIRE(echo.status_code() == 200);
+    REQUIRE(nlohmann::json::parse(echo.extract_string().get())["name"] == "Ursula K. Le Guin");
+
+    auto missing = client.request(web::http::methods::GET, "/nothing").get();
+    REQUIRE(missing.status_code() == 404);
+
+    auto failed = client.request(web::http::methods::GET, "/fail?what=input").get();
+    REQUIRE(failed.status_code() == 400);
+    REQUIRE(nlohmann::json::parse(failed.extract_string().get())["error"] == "bad input");
+
+    server.stop();
+}
+
+TEST_CASE("HttpServer sheds load once the worker queue is full", "[server]") {
+    auto config = loopbackConfig();
+    config.worker_threads = 1;
+    config.max_queued_requests = 1;
+    HttpServer server(config);
+
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<int> entered{0};
+    server.route("GET", "/slow", [&](const HttpRequest&) {
+        ++entered;
+        released.wait();
+        return HttpResponse::json({{"ok", true}});
+    });
+    server.start();
+
+    web::http::client::http_client client(server.url());
+    auto first = client.request(web::http::methods::GET, "/slow");
+    while (entered == 0) {
+        std::this_thread::yield();
+    }
+    auto second = client.request(web::http::methods::GET, "/slow");
+    while (server.queuedRequests() == 0) {
+        std::this_thread::yield();
+    }
+
+    auto shed = client.request(web::http::methods::GET, "/slow").get();
+    REQUIRE(shed.status_code() == 503);
+    REQUIRE(shed.headers().has("Retry-After"));
+
+    release.set_value();
+    REQUIRE(first.get().status_code() == 200);
+    REQUIRE(second.get().status_code() == 200);
+    server.stop();
+}
+
+TEST_CASE("HttpServer streams server-sent events", "[server]") {
+    HttpServer server(loopbackConfig());
+    server.streamRoute("GET", "/events", [](const HttpRequest& request, HttpEventStream& events) {
+        if (request.param("fail") == "early") {
+            throw std::invalid_argument("no events");
+        }
+        events.send("first", "{\"n\":1}");
+        if (request.param("fail") == "late") {
+            throw std::runtime_error("broken");
+        }
+        events.send("second", "{\"n\":2}");
+    });
+    server.start();
+
+    web::http::client::http_client client(server.url());
+
+    auto ok = client.request(web::http::methods::GET, "/events").get();
+    REQUIRE(ok.status_code() == 200);
+    REQUIRE(ok.headers().content_type() == "text/event-stream");
+    REQUIRE(ok.extract_string().get() == "event: first\ndata: {\"n\":1}\n\nevent: second\ndata: {\"n\":2}\n\n");
+
+    auto early = client.request(web::http::methods::GET, "/events?fail=early").get();
+    REQUIRE(early.status_code() == 400);
+
+    auto late = client.request(web::http::methods::GET, "/events?fail=late").get();
+    REQUIRE(late.status_code() == 200);
+    auto body = late.extract_string().get();
+    REQUIRE(body.find("event: first") != std::string::npos);
+    REQUIRE(body.find("event: error") != std::string::npos);
+    REQUIRE(body.find("event: second") == std::string::npos);
+
+    server.stop();
+}
+
+#ifdef HAS_ZLIB
+TEST_CASE("HttpServer gzips large bodies for clients that accept it", "[server]") {
+    auto config = loopbackConfig();
+    config.gzip_min_bytes = 256;
+    HttpServer server(config);
+    server.route("GET", "/big", [](const HttpRequest&) {
+        return HttpResponse::json({{"text", std::string(4096, 'a')}});
+    });
+    server.start();
+
+    web::http::client::http_client client(server.url());
+
+    web::http::http_request request(web::http::methods::GET);
+    request.set_request_uri("/big");
+    request.headers().add("Accept-Encoding", "gzip");
+    auto compressed = client.request(request).get();
+    std::string encoding;
+    REQUIRE(compressed.headers().match("Content-Encoding", encoding));
+    REQUIRE(encoding == "gzip");
+    auto bytes = compressed.extract_vector().get();
+    REQUIRE(bytes.size() < 4096);
+    REQUIRE(bytes.size() > 2);
+    REQUIRE(bytes[0] == 0x1f);
+    REQUIRE(bytes[1] == 0x8b);
+
+    auto plain = client.request(web::http::methods::GET, "/big").get();
+    REQUIRE_FALSE(plain.headers().has("Content-Encoding"));
+    REQUIRE(plain.extract_string().get().size() > 4096);
+
+    // q=0 refuses an encoding, whether named or matched by "*"
+    for (const char* refused : {"gzip;q=0", "deflate, gzip; q=0.0", "*;q=0", "identity"}) {
+        web::http::http_request declined(web::http::methods::GET);
+        declined.set_request_uri("/big");
+        declined.headers().add("Accept-Encoding", refused);
+        auto response = client.request(declined).get();
+        INFO(refused);
+        REQUIRE_FALSE(response.headers().has("Content-Encoding"));
+    }
+    for (const char* accepted : {"deflate;q=1, gzip;q=0.5", "GZIP", "*"}) {
+        web::http::http_request wanted(web::http::methods::GET);
+        wanted.set_request_uri("/big");
+        wanted.headers().add("Accept-Encoding", accepted);
+        auto response = client.request(wanted).get();
+        INFO(accepted);
+        REQUIRE(response.headers().has("Content-Encoding"));
+    }
+
+    server.stop();
+}
+#endif
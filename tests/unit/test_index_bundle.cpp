@@ -0,0 +1,148 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/IndexBundle.hpp>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "book_fixtures.hpp"
+
+using namespace book_recommender;
+using fixtures::makeBook;
+
+namespace {
+
+constexpr int DIMENSION = 4;
+
+BookCatalog makeCatalog() {
+    BookCatalog catalog;
+    catalog.assign({
+        makeBook("1", "Author A", 4.5, 1000, {"fantasy", "adventure"}, "Saga"),
+        makeBook("2", "Author A", 3.9, 5000, {"fantasy"}),
+        makeBook("3", "Author B", 4.8, 200, {"mystery"}),
+        makeBook("4", "Author C", 4.1, 800, {"fantasy"})
+    });
+    return catalog;
+}
+
+// One-hot embeddings; book "4" has none and is left out of the bundle
+bool oneHot(const std::string& id, float* out) {
+    if (id == "4") return false;
+    std::fill(out, out + DIMENSION, 0.0f);
+    out[std::stoi(id) - 1] = 1.0f;
+    return true;
+}
+
+// Overwrites `size` bytes of a file in place
+void patchFile(const std::string& path, std::streamoff position, const void* bytes, size_t size) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(position);
+    file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+}
+
+uint64_t readWord(const std::string& path, std::streamoff position) {
+    std::ifstream file(path, std::ios::binary);
+    file.seekg(position);
+    uint64_t value = 0;
+    file.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return value;
+}
+
+}
+
+TEST_CASE("IndexBundle maps the catalog and vectors it was written from", "[bundle]") {
+    auto catalog = makeCatalog();
+    IndexBundle::write("test_bundle.bin", catalog, DIMENSION, oneHot, 7);
+    auto bundle = IndexBundle::open("test_bundle.bin");
+
+    REQUIRE(bundle->size() == 3);
+    REQUIRE(bundle->dimension() == DIMENSION);
+    REQUIRE(bundle->generation() == 7);
+    REQUIRE_FALSE(bundle->rowOf("4").has_value());
+
+    auto row = bundle->rowOf("1");
+    REQUIRE(row.has_value());
+    REQUIRE(bundle->id(*row) == "1");
+    REQUIRE(bundle->vector(*row)[0] == 1.0f);
+    REQUIRE(bundle->book(*row).toJson() == catalog.find("1")->toBook().toJson());
+    REQUIRE_FALSE(bundle->book(*bundle->rowOf("2")).getSeries().has_value());
+
+    // Documents are materialized once per row, so identity-keyed caches hit
+    auto document = bundle->document(*row);
+    REQUIRE(document->getId() == "1");
+    REQUIRE(document->getMetadata().at("series") == "Saga");
+    REQUIRE(bundle->document(*row) == document);
+
+    REQUIRE(bundle->popularGenres(1) == std::vector<std::string>{"fantasy"});
+    REQUIRE(bundle->popularAuthors(1) == std::vector<std::string>{"Author A"});
+    auto top = bundle->topRatedRows(2);
+    REQUIRE(top.size() == 2);
+    REQUIRE(bundle->id(top[0]) == "3");
+    REQUIRE(bundle->id(top[1]) == "1");
+
+    float query[DIMENSION] = {0.0f, 1.0f, 0.0f, 0.0f};
+    float scores[5];
+    int64_t rows[5];
+    bundle->search(query, 1, 5, scores, rows);
+    REQUIRE(bundle->id(static_cast<uint32_t>(rows[0])) == "2");
+    REQUIRE(scores[0] == Approx(1.0f));
+    REQUIRE(rows[3] == -1);
+    REQUIRE(rows[4] == -1);
+
+    std::remove("test_bundle.bin");
+    REQUIRE_THROWS(IndexBundle::open("test_bundle.bin"));
+}
+
+TEST_CASE("BundleDirectory hands new generations to attached readers", "[bundle]") {
+    namespace fs = std::filesystem;
+    const std::string dir = "test_bundle_dir";
+    fs::remove_all(dir);
+
+    BundleDirectory worker(dir);
+    REQUIRE_FALSE(worker.refresh());
+    REQUIRE(worker.current() == nullptr);
+
+    BundleDirectory loader(dir);
+    auto catalog = makeCatalog();
+    REQUIRE(loader.publish(catalog, DIMENSION, oneHot, 1) == 1);
+    REQUIRE(worker.refresh());
+    auto first = worker.current();
+    REQUIRE(first->generation() == 1);
+    REQUIRE_FALSE(worker.refresh());
+
+    catalog.remove("1");
+    REQUIRE(loader.publish(catalog, DIMENSION, oneHot, 1) == 2);
+    REQUIRE_FALSE(fs::exists(fs::path(dir) / "bundle-1.bin"));
+    REQUIRE(worker.refresh());
+    REQUIRE(worker.current()->generation() == 2);
+    REQUIRE(worker.current()->size() == 2);
+
+    // Readers still holding the old generation keep a valid mapping
+    REQUIRE(first->size() == 3);
+    REQUIRE(first->id(*first->rowOf("1")) == "1");
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("IndexBundle rejects sizes and row numbers that leave the file", "[bundle]") {
+    // Header layout: row_count at byte 16, id_order section offset at byte 80
+    constexpr std::streamoff ROW_COUNT = 16;
+    constexpr std::streamoff ID_ORDER_OFFSET = 80;
+    auto catalog = makeCatalog();
+
+    SECTION("a row count whose section sizes overflow") {
+        IndexBundle::write("test_bundle.bin", catalog, DIMENSION, oneHot, 1);
+        uint64_t row_count = (UINT64_MAX / DIMENSION / sizeof(float)) + 2;
+        patchFile("test_bundle.bin", ROW_COUNT, &row_count, sizeof(row_count));
+        REQUIRE_THROWS_WITH(IndexBundle::open("test_bundle.bin"), Catch::Contains("Corrupt"));
+    }
+
+    SECTION("an id_order entry past the last row") {
+        IndexBundle::write("test_bundle.bin", catalog, DIMENSION, oneHot, 1);
+        uint32_t row = 3;
+        patchFile("test_bundle.bin", static_cast<std::streamoff>(readWord("test_bundle.bin", ID_ORDER_OFFSET)),
+                  &row, sizeof(row));
+        REQUIRE_THROWS_WITH(IndexBundle::open("test_bundle.bin"), Catch::Contains("Corrupt"));
+    }
+
+    std::remove("test_bundle.bin");
+}
@@ -0,0 +1,68 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/Metrics.hpp>
+#include <thread>
+#include <vector>
+
+using namespace book_recommender;
+
+TEST_CASE("Metrics Primitives", "[metrics]") {
+    SECTION("Counter Aggregates Across Threads") {
+        Counter counter;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&counter]() {
+                for (int i = 0; i < 1000; ++i) counter.increment();
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        REQUIRE(counter.value() == 4000);
+    }
+
+    SECTION("Gauge Set And Add") {
+        Gauge gauge;
+        gauge.set(10);
+        gauge.add(-3);
+        REQUIRE(gauge.value() == 7);
+    }
+
+    SECTION("Histogram Merges Thread Shards") {
+        Histogram histogram;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 3; ++t) {
+            threads.emplace_back([&histogram]() {
+                for (int i = 1; i <= 100; ++i) histogram.record(int64_t{i * 1000});
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        auto snapshot = histogram.snapshot();
+        REQUIRE(snapshot.getTotalCount() == 300);
+        REQUIRE(snapshot.getValueAtPercentile(50.0) == Approx(50000).epsilon(0.01));
+        REQUIRE(histogram.sumSeconds() == Approx(3 * 5.05));
+    }
+}
+
+TEST_CASE("MetricsRegistry Prometheus Export", "[metrics]") {
+    auto& registry = MetricsRegistry::getInstance();
+
+    auto& hits = registry.counter("test_cache_hits_total", "Test hits", {{"cache", "vector"}});
+    auto& size = registry.gauge("test_index_size", "Test size");
+    auto& latency = registry.histogram("test_stage_seconds", "Test latency", {{"stage", "search"}});
+
+    hits.increment(3);
+    size.set(42);
+    latency.record(int64_t{2000});
+
+    // Same name and labels resolve to the same metric
+    REQUIRE(&registry.counter("test_cache_hits_total", "Test hits", {{"cache", "vector"}}) == &hits);
+    REQUIRE_THROWS(registry.gauge("test_cache_hits_total", "Wrong type"));
+
+    auto text = registry.scrapePrometheus();
+    REQUIRE(text.find("# TYPE test_cache_hits_total counter") != std::string::npos);
+    REQUIRE(text.find("test_cache_hits_total{cache=\"vector\"} 3") != std::string::npos);
+    REQUIRE(text.find("test_index_size 42") != std::string::npos);
+    REQUIRE(text.find("# TYPE test_stage_seconds summary") != std::string::npos);
+    REQUIRE(text.find("test_stage_seconds{stage=\"search\",quantile=\"0.5\"}") != std::string::npos);
+    REQUIRE(text.find("test_stage_seconds_count{stage=\"search\"} 1") != std::string::npos);
+}
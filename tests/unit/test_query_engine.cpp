@@ -1,8 +1,12 @@
 #include <catch2/catch.hpp>
 #include <book_recommender/BookQueryEngine.hpp>
 #include <book_recommender/BookVectorStore.hpp>
+#include <cstdlib>
+#include "book_fixtures.hpp"
 
 using namespace book_recommender;
+using fixtures::makeBook;
+using fixtures::makeDocument;
 
 TEST_CASE("QueryEngine Recommendation Logic", "[query_engine]") {
     auto vector_store = std::make_shared<BookVectorStore>(384);
@@ -37,11 +41,11 @@ TEST_CASE("QueryEngine Recommendation Logic", "[query_engine]") {
         
         // Add books from different genres and authors
         results.push_back({
-            Book("1", "Book1", "Author1", {"fantasy"}, "desc", 200, 4.0, 1000, 500),
+            std::make_shared<const Book>("1", "Book1", "Author1", std::vector<std::string>{"fantasy"}, "desc", 200, 4.0, 1000, 500),
             0.9f, "explanation1"
         });
         results.push_back({
-            Book("2", "Book2", "Author2", {"sci-fi"}, "desc", 200, 4.0, 1000, 500),
+            std::make_shared<const Book>("2", "Book2", "Author2", std::vector<std::string>{"sci-fi"}, "desc", 200, 4.0, 1000, 500),
             0.8f, "explanation2"
         });
 
@@ -77,4 +81,67 @@ TEST_CASE("QueryEngine Integration", "[query_engine]") {
         REQUIRE_FALSE(first_rec.explanation.empty());
         REQUIRE(first_rec.similarity_score > 0.0f);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("QueryFilter digests keep distinct filters apart", "[query_engine]") {
+    using QueryFilter = BookQueryEngine::QueryFilter;
+
+    QueryFilter a;
+    a.genres = std::vector<std::string>{"fantasy", "mystery"};
+    QueryFilter b;
+    b.genres = std::vector<std::string>{"mystery", "fantasy", "fantasy"};
+    REQUIRE(a.digest() == b.digest());
+
+    QueryFilter rating;
+    rating.min_rating = 4.0;
+    QueryFilter close_rating;
+    close_rating.min_rating = 4.0000001;
+    REQUIRE(rating.digest() != close_rating.digest());
+
+    // A string value must not be able to spell out the fields after it
+    QueryFilter forged;
+    forged.language = "en;ebook_only=1";
+    QueryFilter genuine;
+    genuine.language = "en";
+    genuine.ebook_only = true;
+    REQUIRE(forged.digest() != genuine.digest());
+}
+
+TEST_CASE("Materialized books are reused until their book changes", "[query_engine]") {
+    auto vector_store = std::make_shared<BookVectorStore>(4);
+    vector_store->addDocuments({
+        makeDocument(makeBook("1", "Author", 4.0, 100), {1, 0, 0, 0}),
+        makeDocument(makeBook("2", "Author", 4.0, 100), {1, 1, 0, 0})
+    });
+    BookQueryEngine engine(vector_store);
+
+    auto first = engine.getSimilarBooks("1", {}, 1);
+    auto second = engine.getSimilarBooks("1", {}, 1);
+    REQUIRE(first.size() == 1);
+    REQUIRE(second.size() == 1);
+    REQUIRE(second[0].book == first[0].book);
+
+    engine.onBookRemoved("2");
+    auto rebuilt = engine.getSimilarBooks("1", {}, 1);
+    REQUIRE(rebuilt.size() == 1);
+    REQUIRE(rebuilt[0].book != first[0].book);
+    REQUIRE(rebuilt[0].book->getId() == "2");
+}
+
+TEST_CASE("A batch query that fails to embed comes back empty", "[query_engine]") {
+    if (std::getenv("GROQ_API_KEY") != nullptr) {
+        WARN("GROQ_API_KEY set, so embedding cannot be made to fail; skipping");
+        return;
+    }
+
+    auto vector_store = std::make_shared<BookVectorStore>(384);
+    vector_store->addDocuments({makeDocument(makeBook("1", "Author", 4.0, 100), std::vector<float>(384, 0.1f))});
+    BookQueryEngine engine(vector_store);
+
+    // Without a key every embedding call throws; the slot must stay empty
+    // rather than being filled from a zero-vector search
+    auto batch = engine.getRecommendationsBatch({"fantasy", "mystery"}, {}, 5);
+    REQUIRE(batch.size() == 2);
+    REQUIRE(batch[0].empty());
+    REQUIRE(batch[1].empty());
+}
@@ -0,0 +1,32 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/AllocationTracking.hpp>
+#include <book_recommender/RequestArena.hpp>
+#include <vector>
+
+using namespace book_recommender;
+
+TEST_CASE("RequestArena Allocation", "[arena]") {
+    CountingMemoryResource upstream;
+
+    SECTION("Small Requests Stay Inline") {
+        {
+            RequestArena arena(&upstream);
+            std::pmr::vector<int> values(arena.resource());
+            values.reserve(256);
+            for (int i = 0; i < 256; ++i) values.push_back(i);
+            REQUIRE(values.back() == 255);
+        }
+        REQUIRE(upstream.stats().allocations == 0);
+    }
+
+    SECTION("Overflow Goes Upstream And Is Released Together") {
+        {
+            RequestArena arena(&upstream);
+            std::pmr::vector<char> large(RequestArena::INLINE_CAPACITY * 2, 'x', arena.resource());
+            REQUIRE(upstream.stats().allocations > 0);
+            REQUIRE(upstream.bytesInUse() >= RequestArena::INLINE_CAPACITY * 2);
+        }
+        REQUIRE(upstream.bytesInUse() == 0);
+        REQUIRE(upstream.stats().deallocations == upstream.stats().allocations);
+    }
+}
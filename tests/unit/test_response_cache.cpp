@@ -0,0 +1,64 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/ResponseCache.hpp>
+#include <thread>
+#include <vector>
+
+using namespace book_recommender;
+
+namespace {
+
+std::shared_ptr<const std::vector<int>> values(std::vector<int> v) {
+    return std::make_shared<const std::vector<int>>(std::move(v));
+}
+
+}
+
+TEST_CASE("ResponseCache serves entries for the current catalog version only", "[response_cache]") {
+    ResponseCache<std::vector<int>> cache;
+
+    cache.put("a", values({1, 2}), 64, false, 1);
+    auto hit = cache.get("a", 1);
+    REQUIRE(hit);
+    REQUIRE(*hit == std::vector<int>{1, 2});
+
+    REQUIRE_FALSE(cache.get("a", 2));
+    // The stale entry was dropped on the mismatched lookup
+    REQUIRE_FALSE(cache.get("a", 1));
+    REQUIRE(cache.stats().entries == 0);
+}
+
+TEST_CASE("ResponseCache expires entries, negative ones sooner", "[response_cache]") {
+    ResponseCacheConfig config;
+    config.ttl = std::chrono::seconds(60);
+    config.negative_ttl = std::chrono::milliseconds(1);
+    ResponseCache<std::vector<int>> cache(config);
+
+    cache.put("full", values({1}), 16, false, 0);
+    cache.put("empty", values({}), 16, true, 0);
+    REQUIRE(cache.get("empty", 0));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    REQUIRE(cache.get("full", 0));
+    REQUIRE_FALSE(cache.get("empty", 0));
+}
+
+TEST_CASE("ResponseCache evicts least recently used entries to fit its budget", "[response_cache]") {
+    ResponseCacheConfig config;
+    config.max_bytes = 1000;
+    ResponseCache<std::vector<int>> cache(config);
+
+    cache.put("a", values({1}), 300, false, 0);
+    cache.put("b", values({2}), 300, false, 0);
+    REQUIRE(cache.get("a", 0));  // b is now least recently used
+    cache.put("c", values({3}), 300, false, 0);
+
+    REQUIRE(cache.get("a", 0));
+    REQUIRE_FALSE(cache.get("b", 0));
+    REQUIRE(cache.get("c", 0));
+    REQUIRE(cache.stats().evictions == 1);
+    REQUIRE(cache.stats().bytes <= config.max_bytes);
+
+    // Larger than the whole budget: never stored
+    cache.put("huge", values({4}), 5000, false, 0);
+    REQUIRE_FALSE(cache.get("huge", 0));
+}
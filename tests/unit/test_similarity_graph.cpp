@@ -0,0 +1,136 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/SimilarBooksIndex.hpp>
+#include <book_recommender/SimilarityGraph.hpp>
+#include <cstdio>
+#include <fstream>
+#include "book_fixtures.hpp"
+
+using namespace book_recommender;
+using fixtures::ids;
+
+TEST_CASE("SimilarityGraph stores neighbours without self matches", "[similarity_graph]") {
+    SimilarityGraph graph({"a", "b", "c", "d"}, 2);
+
+    const int64_t labels[] = {0, 2, -1, 3};
+    const float scores[] = {1.0f, 0.9f, 0.0f, 0.5f};
+    graph.setNeighbors(0, labels, scores, 4);
+
+    REQUIRE(graph.neighborCount(0) == 2);
+    REQUIRE(graph.docId(graph.neighborSlots(0)[0]) == "c");
+    REQUIRE(graph.neighborScores(0)[0] == Approx(0.9f));
+    REQUIRE(graph.docId(graph.neighborSlots(0)[1]) == "d");
+
+    REQUIRE(graph.neighborCount(1) == 0);
+    REQUIRE(graph.slotOf("d").value() == 3);
+    REQUIRE_FALSE(graph.slotOf("z").has_value());
+}
+
+TEST_CASE("SimilarityGraph round-trips through its binary format", "[similarity_graph]") {
+    SimilarityGraph graph({"book-1", "book-2", "book-3"}, 3);
+    const int64_t labels[] = {2, 1};
+    const float scores[] = {0.8f, 0.4f};
+    graph.setNeighbors(0, labels, scores, 2);
+
+    std::string path = "test_similarity_graph.bin";
+    graph.save(path);
+    SimilarityGraph loaded = SimilarityGraph::load(path);
+    std::remove(path.c_str());
+
+    REQUIRE(loaded.size() == 3);
+    REQUIRE(loaded.k() == 3);
+    REQUIRE(loaded.slotOf("book-3").value() == 2);
+    REQUIRE(loaded.neighborCount(0) == 2);
+    REQUIRE(loaded.neighborSlots(0)[1] == 1);
+    REQUIRE(loaded.neighborScores(0)[1] == Approx(0.4f));
+    REQUIRE(loaded.neighborCount(2) == 0);
+    REQUIRE_THROWS_AS(loaded.setNeighbors(1, labels, scores, 2), std::logic_error);
+
+    REQUIRE_THROWS(SimilarityGraph::load("missing_similarity_graph.bin"));
+}
+
+TEST_CASE("SimilarityGraph::load rejects sizes and slots that leave the file", "[similarity_graph]") {
+    // Header layout: node_count at byte 8; the neighbour section starts at 64
+    constexpr std::streamoff NODE_COUNT = 8;
+    constexpr std::streamoff NEIGHBORS = 64;
+    std::string path = "test_similarity_graph.bin";
+    SimilarityGraph({"book-1", "book-2", "book-3"}, 2).save(path);
+
+    auto patch = [&](std::streamoff position, const auto& value) {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(position);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    SECTION("a node count whose sections overflow") {
+        patch(NODE_COUNT, uint64_t(UINT64_MAX / 2 + 2));
+        REQUIRE_THROWS_WITH(SimilarityGraph::load(path), Catch::Contains("Truncated"));
+    }
+
+    SECTION("a neighbour slot past the last node") {
+        patch(NEIGHBORS, uint32_t(3));
+        REQUIRE_THROWS_WITH(SimilarityGraph::load(path), Catch::Contains("Corrupt"));
+    }
+
+    std::remove(path.c_str());
+}
+
+namespace {
+
+std::shared_ptr<const SimilarityGraph> makeGraph() {
+    // a <-> b <-> c in a line, d isolated
+    auto graph = std::make_shared<SimilarityGraph>(std::vector<std::string>{"a", "b", "c", "d"}, 2);
+    const int64_t a_labels[] = {1, 2};
+    const float a_scores[] = {0.9f, 0.5f};
+    graph->setNeighbors(0, a_labels, a_scores, 2);
+    const int64_t b_labels[] = {0, 2};
+    const float b_scores[] = {0.9f, 0.8f};
+    graph->setNeighbors(1, b_labels, b_scores, 2);
+    const int64_t c_labels[] = {1, 0};
+    const float c_scores[] = {0.8f, 0.5f};
+    graph->setNeighbors(2, c_labels, c_scores, 2);
+    return graph;
+}
+
+}
+
+TEST_CASE("SimilarBooksIndex serves graph rows and patches upserts", "[similarity_graph]") {
+    SimilarBooksIndex index(makeGraph());
+    std::vector<SimilarBooksIndex::Neighbor> neighbors;
+
+    REQUIRE(index.lookup("a", 2, neighbors));
+    REQUIRE(ids(neighbors) == std::vector<std::string>{"b", "c"});
+
+    neighbors.clear();
+    REQUIRE_FALSE(index.lookup("unknown", 2, neighbors));
+
+    // Rows hold k = 2 neighbours; asking for more must not come back short
+    REQUIRE_FALSE(index.lookup("a", 3, neighbors));
+    REQUIRE(neighbors.empty());
+
+    // d changes and now sits right next to a
+    index.patch("d", {{"a", 0.95f}, {"c", 0.1f}});
+
+    neighbors.clear();
+    REQUIRE(index.lookup("d", 2, neighbors));
+    REQUIRE(ids(neighbors) == std::vector<std::string>{"a", "c"});
+
+    neighbors.clear();
+    REQUIRE(index.lookup("a", 2, neighbors));
+    REQUIRE(ids(neighbors) == std::vector<std::string>{"d", "b"});
+    REQUIRE(neighbors[0].score == Approx(0.95f));
+}
+
+TEST_CASE("SimilarBooksIndex falls back when entries go stale", "[similarity_graph]") {
+    SimilarBooksIndex index(makeGraph());
+    std::vector<SimilarBooksIndex::Neighbor> neighbors;
+
+    index.invalidate("c");
+    REQUIRE_FALSE(index.lookup("c", 2, neighbors));
+
+    // b's row still lists c at its old version
+    neighbors.clear();
+    REQUIRE_FALSE(index.lookup("b", 2, neighbors));
+    neighbors.clear();
+    REQUIRE(index.lookup("b", 1, neighbors));
+    REQUIRE(ids(neighbors) == std::vector<std::string>{"a"});
+}
@@ -0,0 +1,66 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/SingleFlight.hpp>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace book_recommender;
+
+TEST_CASE("SingleFlight coalesces concurrent calls with the same key", "[single_flight]") {
+    SingleFlight<std::string, int> flight;
+    std::atomic<int> executions{0};
+    std::atomic<int> coalesced{0};
+    constexpr int callers = 8;
+
+    std::vector<int> results(callers);
+    std::vector<std::thread> threads;
+    threads.emplace_back([&] {
+        results[0] = flight.run("key", [&] {
+            ++executions;
+            // Hold the call open until every other caller has joined it
+            while (flight.waiters("key") < callers - 1) {
+                std::this_thread::yield();
+            }
+            return 42;
+        });
+    });
+    while (executions.load() == 0) {
+        std::this_thread::yield();
+    }
+    for (int i = 1; i < callers; ++i) {
+        threads.emplace_back([&, i] {
+            bool shared = false;
+            results[i] = flight.run("key", [&] { ++executions; return -1; }, &shared);
+            if (shared) ++coalesced;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(executions == 1);
+    REQUIRE(coalesced == callers - 1);
+    for (int result : results) {
+        REQUIRE(result == 42);
+    }
+}
+
+TEST_CASE("SingleFlight runs sequential and distinct calls independently", "[single_flight]") {
+    SingleFlight<std::string, int> flight;
+    int executions = 0;
+    bool shared = true;
+
+    REQUIRE(flight.run("a", [&] { return ++executions; }, &shared) == 1);
+    REQUIRE_FALSE(shared);
+    REQUIRE(flight.run("a", [&] { return ++executions; }) == 2);
+    REQUIRE(flight.run("b", [&] { return ++executions; }) == 3);
+    REQUIRE(flight.waiters("a") == 0);
+
+    REQUIRE_THROWS_AS(
+        flight.run("a", []() -> int { throw std::runtime_error("boom"); }),
+        std::runtime_error
+    );
+    REQUIRE(flight.run("a", [&] { return ++executions; }) == 4);
+}
@@ -0,0 +1,161 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/TaskExecutor.hpp>
+#include <book_recommender/AllocationTracking.hpp>
+#include <book_recommender/Tracing.hpp>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace book_recommender;
+
+TEST_CASE("TaskExecutor runs submitted tasks and returns their results", "[executor]") {
+    TaskExecutor executor(2);
+    auto answer = executor.submit([] { return 42; });
+    auto failure = executor.submit([]() -> int { throw std::runtime_error("boom"); });
+
+    REQUIRE(answer.get() == 42);
+    REQUIRE_THROWS_AS(failure.get(), std::runtime_error);
+}
+
+TEST_CASE("parallelFor covers the range, including from inside tasks", "[executor]") {
+    // A single worker forces the nested loop to make progress through the
+    // waiting thread helping out rather than through spare workers
+    TaskExecutor executor(1);
+    std::vector<int> values(1000, 0);
+
+    auto done = executor.submit([&] {
+        executor.parallelFor(0, values.size(), [&](size_t i) {
+            values[i] = static_cast<int>(i);
+        }, TaskPriority::Interactive, 64);
+    });
+    done.get();
+
+    std::vector<int> expected(values.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(values == expected);
+}
+
+TEST_CASE("TaskGroup rethrows the first failure after all tasks finish", "[executor]") {
+    TaskExecutor executor(2);
+    std::atomic<int> completed{0};
+
+    TaskGroup group(TaskPriority::Interactive, executor);
+    for (int i = 0; i < 8; ++i) {
+        group.run([&, i] {
+            if (i == 3) throw std::invalid_argument("task 3");
+            ++completed;
+        });
+    }
+    REQUIRE_THROWS_AS(group.wait(), std::invalid_argument);
+    REQUIRE(completed == 7);
+}
+
+TEST_CASE("Interactive tasks run before queued background tasks", "[executor]") {
+    TaskExecutor executor(1);
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<bool> blocked{false};
+
+    // Occupy the only worker while both classes of work queue up
+    executor.post([&] { blocked = true; released.wait(); });
+    while (!blocked) {
+        std::this_thread::yield();
+    }
+
+    std::mutex order_mutex;
+    std::vector<std::string> order;
+    auto record = [&](const char* name) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(name);
+    };
+    auto background = executor.submit([&] { record("background"); }, TaskPriority::Background);
+    auto interactive = executor.submit([&] { record("interactive"); }, TaskPriority::Interactive);
+
+    release.set_value();
+    background.get();
+    interactive.get();
+    REQUIRE(order == std::vector<std::string>{"interactive", "background"});
+}
+
+TEST_CASE("Idle workers steal tasks spawned by a busy worker", "[executor]") {
+    TaskExecutor executor(2);
+    constexpr int spawned = 4;
+    std::atomic<int> completed{0};
+
+    auto done = executor.submit([&] {
+        // Spawned from a worker, so they land on its own deque; spinning
+        // here without helping means only the other worker can run them
+        for (int i = 0; i < spawned; ++i) {
+            executor.post([&] { ++completed; });
+        }
+        while (completed < spawned) {
+            std::this_thread::yield();
+        }
+    });
+    done.get();
+
+    REQUIRE(executor.stats().stolen >= spawned);
+}
+
+TEST_CASE("TaskGroup waiters only run their own group's tasks", "[executor]") {
+    // Everything the posted tasks touch outlives the executor
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<bool> blocked{false};
+    std::atomic<bool> foreign_ran{false};
+    std::promise<void> foreign_done;
+    TaskExecutor executor(1);
+
+    executor.post([&] { blocked = true; released.wait(); });
+    while (!blocked) {
+        std::this_thread::yield();
+    }
+
+    // Queued ahead of the group; the waiter must leave it for the worker
+    executor.post([&] { foreign_ran = true; foreign_done.set_value(); });
+
+    std::vector<int> values(4, 0);
+    TaskGroup group(TaskPriority::Interactive, executor);
+    for (size_t i = 0; i < values.size(); ++i) {
+        group.run([&, i] { values[i] = 1; });
+    }
+    group.wait();
+
+    REQUIRE(values == std::vector<int>(4, 1));
+    REQUIRE_FALSE(foreign_ran);
+    release.set_value();
+    foreign_done.get_future().get();
+    REQUIRE(foreign_ran);
+}
+
+TEST_CASE("Tasks run in the poster's trace and allocation context", "[executor]") {
+    TaskExecutor executor(2);
+    auto path = std::filesystem::temp_directory_path() / "book_recommender_executor_traces.jsonl";
+
+    TracingConfig config;
+    config.sample_rate = 1.0;
+    config.output_path = path.string();
+    Tracer::getInstance().configure(config);
+    {
+        Span root("root");
+        AllocationScope allocations;
+
+        std::string worker_trace_id;
+        std::vector<char> block;
+        executor.submit([&] {
+            worker_trace_id = Span::currentTraceId();
+            block.resize(4096);
+        }).get();
+
+        REQUIRE(worker_trace_id == Span::currentTraceId());
+        if (AllocationScope::isTrackingEnabled()) {
+            REQUIRE(allocations.stats().bytes >= 4096);
+        }
+    }
+    Tracer::getInstance().disable();
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/TextAnalysis.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace book_recommender;
+
+TEST_CASE("Tokenizer yields views between whitespace runs", "[text_analysis]") {
+    std::string text = "  cozy\tmystery  set in\nscotland ";
+    Tokenizer tokens(text);
+    std::vector<std::string_view> seen;
+    std::string_view token;
+    while (tokens.next(token)) seen.push_back(token);
+
+    REQUIRE(seen == std::vector<std::string_view>{"cozy", "mystery", "set", "in", "scotland"});
+    REQUIRE(seen[0].data() == text.data() + 2);
+    REQUIRE_FALSE(Tokenizer("   ").next(token));
+}
+
+TEST_CASE("isStopWord recognizes normalized stop words only", "[text_analysis]") {
+    for (const char* word : {"a", "the", "yourselves", "dont", "youre", "between"}) {
+        REQUIRE(isStopWord(word));
+    }
+    for (const char* word : {"", "mystery", "th", "thee", "don", "yourselvesx"}) {
+        REQUIRE_FALSE(isStopWord(word));
+    }
+}
+
+TEST_CASE("stemWord follows Porter2", "[text_analysis]") {
+    const std::vector<std::pair<std::string, std::string>> cases = {
+        {"consign", "consign"}, {"consigned", "consign"}, {"consigning", "consign"}, {"consignment", "consign"},
+        {"consolation", "consol"}, {"knightly", "knight"}, {"knives", "knive"}, {"generously", "generous"},
+        {"skies", "sky"}, {"dying", "die"}, {"news", "news"}, {"cries", "cri"}, {"ties", "tie"},
+        {"gaps", "gap"}, {"gas", "gas"}, {"kiwis", "kiwi"}, {"caresses", "caress"}, {"hopping", "hop"},
+        {"hoping", "hope"}, {"agreed", "agre"}, {"bleed", "bleed"}, {"communication", "communic"},
+        {"happily", "happili"}, {"inning", "inning"}, {"succeeded", "succeed"}, {"mysteries", "mysteri"},
+        {"wizardry", "wizardri"}, {"battled", "battl"}, {"by", "by"}
+    };
+
+    std::string stem;
+    StemCache cache(2);
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const auto& [word, expected] : cases) {
+            INFO(word);
+            stemWord(word, stem);
+            REQUIRE(stem == expected);
+            // A two-word cache evicts constantly; answers must not change
+            REQUIRE(cache.stem(word) == expected);
+        }
+    }
+}
+
+TEST_CASE("forEachTerm drops stop words and stems the rest", "[text_analysis]") {
+    StemCache stems;
+    std::vector<std::string> terms;
+    forEachTerm("the detectives were investigating their murders", stems,
+                [&](std::string_view term) { terms.emplace_back(term); });
+    REQUIRE(terms == std::vector<std::string>{"detect", "investig", "murder"});
+}
@@ -0,0 +1,66 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/TextNormalizer.hpp>
+#include <cctype>
+#include <random>
+#include <string>
+
+using namespace book_recommender;
+
+namespace {
+
+// The regex-based query cleanup normalizeText replaced, for ASCII input
+std::string referenceNormalize(const std::string& text) {
+    std::string result;
+    bool pending_space = false;
+    for (unsigned char c : text) {
+        if (std::isspace(c)) {
+            pending_space = !result.empty();
+        } else if (!std::ispunct(c)) {
+            if (pending_space) result.push_back(' ');
+            pending_space = false;
+            result.push_back(static_cast<char>(std::tolower(c)));
+        }
+    }
+    return result;
+}
+
+}
+
+TEST_CASE("normalizeText folds case, strips punctuation and collapses whitespace", "[text_normalizer]") {
+    REQUIRE(normalizeText("") == "");
+    REQUIRE(normalizeText("  \t\n ") == "");
+    REQUIRE(normalizeText("  Cozy   Mysteries, set in\tSCOTLAND!  ") == "cozy mysteries set in scotland");
+    REQUIRE(normalizeText("Sci-Fi & Fantasy") == "scifi fantasy");
+    REQUIRE(normalizeText("A Long Title With Many Words In It Spanning Blocks") ==
+            "a long title with many words in it spanning blocks");
+}
+
+TEST_CASE("normalizeText handles UTF-8", "[text_normalizer]") {
+    REQUIRE(normalizeText("ÉMILE ZOLA — Œuvres") == "émile zola œuvres");
+    REQUIRE(normalizeText("«Война и мир»") == "война и мир");
+    REQUIRE(normalizeText("ΟΔΥΣΣΕΙΑ") == "οδυσσεια");
+    REQUIRE(normalizeText("¿Dónde está?") == "dónde está");
+    REQUIRE(normalizeText("“Quoted” text…") == "quoted text");
+    // Code points without a folding rule, and malformed bytes, pass through
+    REQUIRE(normalizeText("日本語 📚") == "日本語 📚");
+    REQUIRE(normalizeText("a\xff b\xc3") == "a\xff b\xc3");
+}
+
+TEST_CASE("normalizeText matches the scalar reference on random ASCII", "[text_normalizer]") {
+    std::mt19937 rng(7);
+    // Mostly-prose text exercises the 16-byte fast path, the noisy one the fallback
+    const std::string alphabets[] = {"abcdefghijklmnopqrstXYZ0123 ", "abcXYZ019      .,;-!\t\n"};
+    std::uniform_int_distribution<size_t> length(0, 100);
+
+    std::string out;
+    for (int trial = 0; trial < 2000; ++trial) {
+        const auto& alphabet = alphabets[trial % 2];
+        std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+        std::string text(length(rng), ' ');
+        for (auto& c : text) c = alphabet[pick(rng)];
+
+        normalizeText(text, out);
+        INFO(text);
+        REQUIRE(out == referenceNormalize(text));
+    }
+}
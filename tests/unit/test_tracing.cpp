@@ -0,0 +1,140 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/Tracing.hpp>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+using namespace book_recommender;
+
+namespace {
+
+std::vector<nlohmann::json> readTraces(const std::filesystem::path& path) {
+    std::vector<nlohmann::json> traces;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        traces.push_back(nlohmann::json::parse(line));
+    }
+    return traces;
+}
+
+}
+
+TEST_CASE("Tracing Disabled", "[tracing]") {
+    Tracer::getInstance().disable();
+
+    Span span("disabled");
+    span.setAttribute("key", std::string("value"));
+    REQUIRE_FALSE(span.isRecording());
+    REQUIRE(Span::currentTraceId().empty());
+}
+
+TEST_CASE("Tracing Export", "[tracing]") {
+    auto path = std::filesystem::temp_directory_path() / "book_recommender_traces.jsonl";
+    std::filesystem::remove(path);
+
+    TracingConfig config;
+    config.sample_rate = 1.0;
+    config.output_path = path.string();
+    Tracer::getInstance().configure(config);
+
+    std::string trace_id;
+    {
+        Span root("root");
+        root.setAttribute("top_k", 5);
+        trace_id = Span::currentTraceId();
+        REQUIRE(trace_id.size() == 32);
+
+        {
+            Span child("child");
+            child.setAttribute("cache_hit", true);
+            child.setError("boom");
+        }
+
+        // Work on another thread joins the same trace through a captured context
+        auto context = Span::currentContext();
+        std::thread worker([context]() {
+            ScopedTraceContext scope(context);
+            Span remote("remote");
+            REQUIRE(remote.isRecording());
+        });
+        worker.join();
+    }
+    Tracer::getInstance().disable();
+
+    auto traces = readTraces(path);
+    REQUIRE(traces.size() == 1);
+
+    const auto& spans = traces[0]["resourceSpans"][0]["scopeSpans"][0]["spans"];
+    REQUIRE(spans.size() == 3);
+
+    std::string root_id;
+    for (const auto& span : spans) {
+        REQUIRE(span["traceId"] == trace_id);
+        if (span["name"] == "root") {
+            root_id = span["spanId"];
+            REQUIRE_FALSE(span.contains("parentSpanId"));
+            REQUIRE(span["attributes"][0]["value"]["intValue"] == "5");
+        }
+    }
+    for (const auto& span : spans) {
+        if (span["name"] != "root") {
+            REQUIRE(span["parentSpanId"] == root_id);
+        }
+        if (span["name"] == "child") {
+            REQUIRE(span["status"]["code"] == 2);
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Spans inside an unsampled request never export", "[tracing]") {
+    auto path = std::filesystem::temp_directory_path() / "book_recommender_partial_traces.jsonl";
+    std::filesystem::remove(path);
+
+    TracingConfig config;
+    config.sample_rate = 0.5;
+    config.output_path = path.string();
+    Tracer::getInstance().configure(config);
+
+    int sampled = 0;
+    for (int i = 0; i < 200; ++i) {
+        Span root("root");
+        if (root.isRecording()) ++sampled;
+        {
+            Span child("child");
+            REQUIRE(child.isRecording() == root.isRecording());
+        }
+
+        auto context = Span::currentContext();
+        std::thread worker([context, recording = root.isRecording()]() {
+            ScopedTraceContext scope(context);
+            Span remote("remote");
+            REQUIRE(remote.isRecording() == recording);
+        });
+        worker.join();
+    }
+    // The marker ends with the unsampled root
+    REQUIRE_FALSE(Span::currentContext().unsampled);
+    Tracer::getInstance().disable();
+
+    // Every exported trace is a whole request, rooted at "root"
+    auto traces = readTraces(path);
+    REQUIRE(traces.size() == static_cast<size_t>(sampled));
+    for (const auto& trace : traces) {
+        const auto& spans = trace["resourceSpans"][0]["scopeSpans"][0]["spans"];
+        REQUIRE(spans.size() == 3);
+        size_t roots = 0;
+        for (const auto& span : spans) {
+            if (!span.contains("parentSpanId")) {
+                REQUIRE(span["name"] == "root");
+                ++roots;
+            }
+        }
+        REQUIRE(roots == 1);
+    }
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,93 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/UserProfileStore.hpp>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace book_recommender;
+
+namespace {
+
+// Books clustered around three axes: "a" books near the first, "b" books
+// near the second and "c" books near the third
+std::shared_ptr<BookVectorStore> clusteredStore() {
+    auto store = std::make_shared<BookVectorStore>(4);
+    std::vector<Document> documents;
+    for (const char* cluster : {"a", "b", "c"}) {
+        size_t axis = static_cast<size_t>(cluster[0] - 'a');
+        for (int i = 0; i < 8; ++i) {
+            std::vector<float> embedding(4, 0.05f * i);
+            embedding[axis] = 1.0f;
+            documents.emplace_back(cluster + std::to_string(i), "", Document::Metadata{}, embedding);
+        }
+    }
+    store->addDocuments(documents);
+    return store;
+}
+
+std::vector<ReadEvent> reads(const std::string& cluster, int count) {
+    std::vector<ReadEvent> history;
+    for (int i = 0; i < count; ++i) {
+        history.push_back({cluster + std::to_string(i)});
+    }
+    return history;
+}
+
+}
+
+TEST_CASE("Profiles split a varied history into interests", "[user_profile]") {
+    UserProfileStore profiles(clusteredStore());
+
+    auto single = profiles.setHistory("reader", reads("a", 3));
+    REQUIRE(single->interests.size() == 1);
+
+    auto history = reads("a", 5);
+    auto more = reads("b", 5);
+    history.insert(history.end(), more.begin(), more.end());
+    auto profile = profiles.setHistory("reader", history);
+    REQUIRE(profile->interests.size() == 2);
+    REQUIRE(profile->read_books.size() == 10);
+    REQUIRE(profile->version > single->version);
+    REQUIRE(profiles.getProfile("reader") == profile);
+}
+
+TEST_CASE("Profile search excludes read books and covers every interest", "[user_profile]") {
+    UserProfileStore profiles(clusteredStore());
+    auto history = reads("a", 5);
+    auto more = reads("b", 5);
+    history.insert(history.end(), more.begin(), more.end());
+    auto profile = profiles.setHistory("reader", history);
+
+    auto results = profiles.search(*profile, 4);
+    REQUIRE(results.size() == 4);
+    std::unordered_set<char> clusters;
+    for (const auto& result : results) {
+        REQUIRE_FALSE(profile->read_books.count(result.doc_id));
+        clusters.insert(result.doc_id[0]);
+    }
+    REQUIRE(clusters == std::unordered_set<char>{'a', 'b'});
+}
+
+TEST_CASE("Reads update cached profiles incrementally", "[user_profile]") {
+    UserProfileConfig config;
+    config.max_profiles = 16;
+    UserProfileStore profiles(clusteredStore(), config);
+    profiles.setHistoryLoader([](const std::string& user_id) {
+        return user_id == "known" ? reads("a", 2) : std::vector<ReadEvent>{};
+    });
+
+    REQUIRE(profiles.getProfile("stranger") == nullptr);
+
+    auto before = profiles.getProfile("known");
+    REQUIRE(before);
+    auto after = profiles.recordRead("known", {"a5"});
+    REQUIRE(after->read_books.count("a5"));
+    REQUIRE(after->version != before->version);
+    REQUIRE(profiles.recordRead("known", {"a5"}) == after);
+
+    // One profile per shard at this capacity, so older users get evicted
+    for (int i = 0; i < 100; ++i) {
+        profiles.recordRead("user" + std::to_string(i), {"c0"});
+    }
+    REQUIRE(profiles.size() <= 16);
+}
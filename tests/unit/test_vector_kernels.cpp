@@ -0,0 +1,58 @@
+#include <catch2/catch.hpp>
+#include <book_recommender/VectorKernels.hpp>
+#include <random>
+#include <vector>
+
+using namespace book_recommender;
+
+namespace {
+
+std::vector<float> randomVectors(size_t count, size_t dimension, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> normal;
+    std::vector<float> values(count * dimension);
+    for (float& x : values) x = normal(rng);
+    return values;
+}
+
+}
+
+TEST_CASE("Specialized kernels match the plain loop", "[vector_kernels]") {
+    for (size_t dimension : VectorKernels::SPECIALIZED_DIMENSIONS) {
+        VectorKernels fixed(dimension);
+        auto generic = VectorKernels::generic(dimension);
+        REQUIRE(fixed.specialized());
+        REQUIRE_FALSE(generic.specialized());
+
+        auto query = randomVectors(1, dimension, 1);
+        auto rows = randomVectors(9, dimension, 2);
+        for (size_t i = 0; i < 9; ++i) {
+            const float* row = rows.data() + i * dimension;
+            REQUIRE(fixed.dot(query.data(), row) == Approx(generic.dot(query.data(), row)).margin(1e-3));
+        }
+    }
+}
+
+TEST_CASE("dotRows agrees exactly with dot, including tail rows", "[vector_kernels]") {
+    for (size_t dimension : {size_t(128), size_t(768), size_t(300)}) {
+        VectorKernels kernels(dimension);
+        auto query = randomVectors(1, dimension, 3);
+        auto rows = randomVectors(7, dimension, 4);
+
+        std::vector<float> scores(7);
+        kernels.dotRows(query.data(), rows.data(), scores.size(), scores.data());
+        for (size_t i = 0; i < scores.size(); ++i) {
+            REQUIRE(scores[i] == kernels.dot(query.data(), rows.data() + i * dimension));
+        }
+    }
+}
+
+TEST_CASE("Other dimensions fall back to the plain loop", "[vector_kernels]") {
+    VectorKernels kernels(3);
+    REQUIRE_FALSE(kernels.specialized());
+    REQUIRE(kernels.dimension() == 3);
+
+    float a[] = {1.0f, 2.0f, 3.0f};
+    float b[] = {4.0f, -5.0f, 6.0f};
+    REQUIRE(kernels.dot(a, b) == 12.0f);
+}
@@ -1,7 +1,10 @@
 #include <catch2/catch.hpp>
 #include <book_recommender/BookVectorStore.hpp>
+#include <book_recommender/Metrics.hpp>
+#include "book_fixtures.hpp"
 
 using namespace book_recommender;
+using fixtures::ids;
 
 TEST_CASE("VectorStore Basic Operations", "[vector_store]") {
     BookVectorStore store(384);  // 384-dimensional vectors
@@ -56,4 +59,140 @@ TEST_CASE("VectorStore Basic Operations", "[vector_store]") {
         REQUIRE(results.size() == 1);
         REQUIRE(results[0].doc_id == "test_id");
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("addDocuments rejects a bad batch without changing the store", "[vector_store]") {
+    BookVectorStore store(4);
+    store.addDocuments({Document("a", "old", {}, std::vector<float>{1, 0, 0, 0})});
+
+    std::vector<Document> batch{
+        Document("a", "new", {}, std::vector<float>{0, 1, 0, 0}),
+        Document("b", "bad", {}, std::vector<float>{1, 0, 0})
+    };
+    REQUIRE_THROWS_AS(store.addDocuments(batch), std::invalid_argument);
+
+    REQUIRE(store.size() == 1);
+    REQUIRE(store.getDocument("a")->getText() == "old");
+    REQUIRE(store.getDocument("b") == nullptr);
+    auto results = store.search({1, 0, 0, 0}, 5);
+    REQUIRE(results.size() == 1);
+    REQUIRE(results[0].doc_id == "a");
+}
+
+namespace {
+
+Document fieldDocument(const std::string& id, std::vector<float> embedding,
+                       std::map<std::string, std::vector<Document::Embedding>> fields = {}) {
+    Document doc(id, "text " + id, {}, std::move(embedding));
+    for (auto& [field, vectors] : fields) {
+        doc.setFieldEmbeddings(field, std::move(vectors));
+    }
+    return doc;
+}
+
+}
+
+TEST_CASE("Fused search scores each field on its best vector", "[vector_store][fusion]") {
+    BookVectorStore store(4);
+    store.addDocuments({
+        fieldDocument("a", {1, 0, 0, 0}, {{"title", {{0, 1, 0, 0}}},
+                                          {"description", {{0, 0, 1, 0}, {0, 0, 0, 1}}}}),
+        fieldDocument("b", {0, 1, 0, 0}, {{"title", {{1, 0, 0, 0}}}}),
+        fieldDocument("c", {0, 0, 0, 1})
+    });
+
+    SECTION("weights decide between fields") {
+        BookVectorStore::FusionOptions fusion;
+        fusion.field_weights = {{"combined", 0.1f}, {"title", 0.9f}};
+        auto results = store.search({0, 1, 0, 0}, 2, fusion);
+        REQUIRE(ids(results) == std::vector<std::string>{"a", "b"});
+        REQUIRE(results[0].similarity == Approx(0.9f));
+        REQUIRE(results[1].similarity == Approx(0.1f));
+
+        fusion.field_weights = {{"combined", 0.9f}, {"title", 0.1f}};
+        results = store.search({0, 1, 0, 0}, 2, fusion);
+        REQUIRE(ids(results) == std::vector<std::string>{"b", "a"});
+        REQUIRE(results[0].similarity == Approx(0.9f));
+    }
+
+    SECTION("a field scores its best chunk, and missing fields are left out of the mean") {
+        BookVectorStore::FusionOptions fusion;
+        fusion.field_weights = {{"combined", 0.5f}, {"description", 0.5f}};
+        auto results = store.search({0, 0, 0, 1}, 3, fusion);
+        REQUIRE(ids(results) == std::vector<std::string>{"c", "a", "b"});
+        REQUIRE(results[0].similarity == Approx(1.0f));  // combined only
+        REQUIRE(results[1].similarity == Approx(0.5f));  // second chunk
+        REQUIRE(results[2].similarity == Approx(0.0f));
+
+        fusion.mode = BookVectorStore::FusionMode::MaxSim;
+        results = store.search({0, 0, 0, 1}, 3, fusion);
+        REQUIRE(results[0].similarity == Approx(1.0f));
+        REQUIRE(results[1].doc_id == "c");
+        REQUIRE(results[1].similarity == Approx(1.0f));
+    }
+
+    SECTION("equal scores rank by id") {
+        store.addDocuments({fieldDocument("y", {0, 0, 1, 0}), fieldDocument("x", {0, 0, 1, 0})});
+        BookVectorStore::FusionOptions fusion;
+        fusion.field_weights = {{"combined", 1.0f}};
+        REQUIRE(ids(store.search({0, 0, 1, 0}, 2, fusion)) == std::vector<std::string>{"x", "y"});
+    }
+
+    SECTION("batches fuse like single searches") {
+        BookVectorStore::FusionOptions fusion;
+        fusion.field_weights = {{"combined", 0.5f}, {"description", 0.5f}};
+        std::vector<std::vector<float>> queries{{0, 0, 0, 1}, {0, 0, 1, 0}};
+        auto batch = store.batchSearch(queries, 3, fusion);
+        REQUIRE(batch.size() == 2);
+        for (size_t q = 0; q < queries.size(); ++q) {
+            auto single = store.search(queries[q], 3, fusion);
+            REQUIRE(ids(batch[q]) == ids(single));
+            REQUIRE(batch[q][0].similarity == Approx(single[0].similarity));
+        }
+    }
+
+    SECTION("removal keeps the remaining rows pointing at their documents") {
+        store.removeDocument("a");
+        REQUIRE(store.size() == 2);
+        REQUIRE(ids(store.search({0, 0, 0, 1}, 1)) == std::vector<std::string>{"c"});
+        REQUIRE(ids(store.search({0, 1, 0, 0}, 1)) == std::vector<std::string>{"b"});
+
+        BookVectorStore::FusionOptions fusion;
+        fusion.field_weights = {{"title", 1.0f}};
+        auto results = store.search({1, 0, 0, 0}, 5, fusion);
+        REQUIRE(ids(results) == std::vector<std::string>{"b"});
+        REQUIRE(results[0].similarity == Approx(1.0f));
+
+        fusion.field_weights = {{"description", 1.0f}};
+        REQUIRE(store.search({0, 0, 0, 1}, 5, fusion).empty());
+    }
+}
+
+TEST_CASE("Batched searches record into their own latency histogram", "[vector_store][metrics]") {
+    auto& registry = MetricsRegistry::getInstance();
+    auto& single = registry.histogram("book_recommender_vector_search_seconds", "");
+    auto& batched = registry.histogram("book_recommender_vector_batch_search_seconds", "");
+
+    BookVectorStore store(4);
+    store.addDocuments({fieldDocument("a", {1, 0, 0, 0}), fieldDocument("b", {0, 1, 0, 0})});
+    std::vector<std::vector<float>> queries{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}};
+
+    auto single_before = single.snapshot().getTotalCount();
+    auto batched_before = batched.snapshot().getTotalCount();
+    store.batchSearch(queries, 2);
+    store.batchSearchExcluding(queries, {"a"}, 2);
+    REQUIRE(batched.snapshot().getTotalCount() == batched_before + 2);
+    REQUIRE(single.snapshot().getTotalCount() == single_before);
+
+    store.search(queries[0], 2);
+    REQUIRE(single.snapshot().getTotalCount() == single_before + 1);
+    REQUIRE(batched.snapshot().getTotalCount() == batched_before + 2);
+
+    SECTION("fused batches count once as a batch") {
+        store.addDocuments({fieldDocument("c", {0, 0, 1, 0}, {{"title", {{0, 0, 1, 0}}}})});
+        BookVectorStore::FusionOptions fusion;
+        store.batchSearch(queries, 2, fusion);
+        REQUIRE(batched.snapshot().getTotalCount() == batched_before + 3);
+        REQUIRE(single.snapshot().getTotalCount() == single_before + 1);
+    }
+}
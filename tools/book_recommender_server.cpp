@@ -0,0 +1,114 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <spdlog/spdlog.h>
+#include <book_recommender/BookRecommender.hpp>
+#include <book_recommender/HttpServer.hpp>
+#include <book_recommender/RecommenderEndpoints.hpp>
+
+using namespace book_recommender;
+
+namespace {
+
+std::atomic<bool> shutdown_requested{false};
+
+struct ServerOptions {
+    BookRecommender::RecommenderConfig recommender;
+    HttpServerConfig http;
+    std::string publish_dir;        // loader mode: publish a bundle and exit
+    size_t keep_bundles = 2;
+    int refresh_seconds = 5;        // attached mode: CURRENT poll interval
+};
+
+void printUsage() {
+    std::cout << "Usage: book_recommender_server [options]\n"
+              << "  --data FILE            Catalog CSV (default books.csv)\n"
+              << "  --graph FILE           Precomputed similar-books graph\n"
+              << "  --address ADDR         Interface to listen on (default 0.0.0.0)\n"
+              << "  --port N               Port to listen on (default 8080)\n"
+              << "  --threads N            Worker threads; 0 uses every core (default 0)\n"
+              << "  --max-queue N          Requests allowed to wait for a worker before\n"
+              << "                         new ones are shed with 503 (default 256)\n"
+              << "  --gzip-min-bytes N     Smallest body worth compressing (default 1024)\n"
+              << "  --timeout SECONDS      Per-request socket timeout (default 30)\n"
+              << "  --publish DIR          Load the catalog, publish an index bundle to DIR and exit\n"
+              << "  --keep N               Bundle generations kept by --publish (default 2)\n"
+              << "  --attach DIR           Serve read-only from the bundles published in DIR\n"
+              << "  --refresh SECONDS      How often --attach checks for a new bundle (default 5)\n";
+}
+
+ServerOptions parseArgs(int argc, char* argv[]) {
+    ServerOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--data") options.recommender.data_file = next();
+        else if (arg == "--graph") options.recommender.similarity_graph_path = next();
+        else if (arg == "--address") options.http.address = next();
+        else if (arg == "--port") options.http.port = std::stoi(next());
+        else if (arg == "--threads") options.http.worker_threads = std::stoul(next());
+        else if (arg == "--max-queue") options.http.max_queued_requests = std::stoul(next());
+        else if (arg == "--gzip-min-bytes") options.http.gzip_min_bytes = std::stoul(next());
+        else if (arg == "--timeout") options.http.request_timeout_seconds = std::stoi(next());
+        else if (arg == "--publish") options.publish_dir = next();
+        else if (arg == "--keep") options.keep_bundles = std::stoul(next());
+        else if (arg == "--attach") options.recommender.index_bundle_dir = next();
+        else if (arg == "--refresh") options.refresh_seconds = std::stoi(next());
+        else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("Unknown argument: " + arg);
+        }
+    }
+    if (!options.publish_dir.empty() && !options.recommender.index_bundle_dir.empty()) {
+        throw std::invalid_argument("--publish and --attach are mutually exclusive");
+    }
+    if (options.refresh_seconds <= 0) throw std::invalid_argument("Refresh interval must be positive");
+    return options;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        ServerOptions options = parseArgs(argc, argv);
+
+        BookRecommender recommender(options.recommender);
+        if (!options.publish_dir.empty()) {
+            auto generation = recommender.publishIndexBundle(options.publish_dir, options.keep_bundles);
+            std::cout << "Published generation " << generation << " to " << options.publish_dir << "\n";
+            return 0;
+        }
+
+        HttpServer server(options.http);
+        registerRecommenderEndpoints(server, recommender);
+
+        std::signal(SIGINT, [](int) { shutdown_requested = true; });
+        std::signal(SIGTERM, [](int) { shutdown_requested = true; });
+
+        server.start();
+        auto next_refresh = std::chrono::steady_clock::now() + std::chrono::seconds(options.refresh_seconds);
+        while (!shutdown_requested) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            if (!options.recommender.index_bundle_dir.empty() && std::chrono::steady_clock::now() >= next_refresh) {
+                recommender.refreshIndexBundle();
+                next_refresh += std::chrono::seconds(options.refresh_seconds);
+            }
+        }
+
+        spdlog::info("Shutting down");
+        server.stop();
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
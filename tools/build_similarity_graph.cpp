@@ -0,0 +1,82 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <book_recommender/BookVectorStore.hpp>
+#include <book_recommender/SimilarityGraph.hpp>
+
+using namespace book_recommender;
+
+namespace {
+
+struct GraphConfig {
+    std::string index_path = "book_index";
+    std::string output_path = "similar_books.graph";
+    int dimension = 384;
+    int k = 20;
+    size_t block_size = 1024;
+    bool approximate = false;
+};
+
+void printUsage() {
+    std::cout << "Usage: build_similarity_graph [options]\n"
+              << "  --index PATH       Saved vector index prefix (default book_index)\n"
+              << "  --output PATH      Graph file to write (default similar_books.graph)\n"
+              << "  --dimension N      Embedding dimension (default 384)\n"
+              << "  --k N              Neighbours kept per book (default 20)\n"
+              << "  --block-size N     Queries per search tile (default 1024)\n"
+              << "  --approximate      Use the IVF index instead of exact search\n";
+}
+
+GraphConfig parseArgs(int argc, char* argv[]) {
+    GraphConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--index") config.index_path = next();
+        else if (arg == "--output") config.output_path = next();
+        else if (arg == "--dimension") config.dimension = std::stoi(next());
+        else if (arg == "--k") config.k = std::stoi(next());
+        else if (arg == "--block-size") config.block_size = std::stoul(next());
+        else if (arg == "--approximate") config.approximate = true;
+        else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("Unknown argument: " + arg);
+        }
+    }
+
+    if (config.k <= 0) throw std::invalid_argument("k must be positive");
+    if (config.block_size == 0) throw std::invalid_argument("Block size must be positive");
+    return config;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        GraphConfig config = parseArgs(argc, argv);
+
+        BookVectorStore store(config.dimension);
+        store.loadIndex(config.index_path);
+        if (config.approximate) {
+            store.optimizeIndex();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        SimilarityGraph graph = store.buildSimilarityGraph(config.k, config.block_size, config.approximate);
+        graph.save(config.output_path);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "Wrote " << graph.size() << " books x " << graph.k() << " neighbours to "
+                  << config.output_path << " in " << elapsed.count() << "s\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
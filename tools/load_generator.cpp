@@ -0,0 +1,482 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <book_recommender/AllocationTracking.hpp>
+#include <book_recommender/BookRecommender.hpp>
+#include <book_recommender/HdrHistogram.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+using namespace book_recommender;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Operation { Recommend, Similar, Author, Series, Search };
+
+constexpr Operation ALL_OPERATIONS[] = {
+    Operation::Recommend,
+    Operation::Similar,
+    Operation::Author,
+    Operation::Series,
+    Operation::Search
+};
+constexpr size_t OPERATION_COUNT = std::size(ALL_OPERATIONS);
+
+const char* operationName(Operation op) {
+    switch (op) {
+        case Operation::Recommend: return "recommend";
+        case Operation::Similar: return "similar";
+        case Operation::Author: return "author";
+        case Operation::Series: return "series";
+        case Operation::Search: return "search";
+    }
+    return "unknown";
+}
+
+Operation parseOperation(const std::string& name) {
+    for (auto op : ALL_OPERATIONS) {
+        if (name == operationName(op)) return op;
+    }
+    throw std::invalid_argument("Unknown operation: " + name);
+}
+
+struct QueryLogEntry {
+    Operation op;
+    std::string argument;
+};
+
+struct LoadConfig {
+    std::string data_file = "books.csv";
+    double qps = 0.0;               // 0 = unthrottled closed loop
+    int concurrency = 4;
+    double duration_seconds = 30.0;
+    int top_k = 5;
+    unsigned seed = 42;
+    std::string mix = "recommend=5,similar=2,author=1,series=1,search=1";
+    std::string query_log;          // replay this log instead of generating
+    std::string record_log;         // write the generated workload here
+    bool json_output = false;
+    double max_allocs_per_op = 0.0;   // fail the run above this mean; 0 = off
+};
+
+// Per-thread, per-operation measurements; merged once the run is over
+struct OperationStats {
+    HdrHistogram latency_us;        // from intended start (CO-corrected)
+    HdrHistogram service_us;        // from actual start
+    uint64_t errors = 0;
+    uint64_t shed = 0;              // turned away by admission control
+    BookVectorStore::CacheStats cache;
+    AllocationStats allocations;
+};
+
+const std::vector<std::string> DEFAULT_QUERIES = {
+    "fantasy books with magic schools",
+    "science fiction exploring artificial intelligence",
+    "cozy mystery set in a small village",
+    "historical fiction about world war two",
+    "epic space opera with political intrigue",
+    "literary fiction about family secrets",
+    "thriller with an unreliable narrator",
+    "young adult dystopian adventure",
+    "biography of a famous scientist",
+    "romance with enemies to lovers"
+};
+
+void printUsage() {
+    std::cout << "Usage: load_generator [options]\n"
+              << "  --data FILE           Catalog CSV (default books.csv)\n"
+              << "  --qps N               Target request rate; 0 runs an unthrottled closed loop\n"
+              << "  --concurrency N       Number of client threads (default 4)\n"
+              << "  --duration SECONDS    Run length (default 30)\n"
+              << "  --mix SPEC            Operation weights, e.g. recommend=5,similar=2,search=1\n"
+              << "  --top-k N             Results requested per call (default 5)\n"
+              << "  --query-log FILE      Replay a recorded workload (op<TAB>argument per line)\n"
+              << "  --record-log FILE     Record the generated workload for later replay\n"
+              << "  --seed N              Workload generator seed (default 42)\n"
+              << "  --json                Emit the report as JSON\n"
+              << "  --max-allocs-per-op N Exit with status 2 if any operation averages more\n"
+              << "                        heap allocations per call (allocation-tracking builds)\n";
+}
+
+LoadConfig parseArgs(int argc, char* argv[]) {
+    LoadConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--data") config.data_file = next();
+        else if (arg == "--qps") config.qps = std::stod(next());
+        else if (arg == "--concurrency") config.concurrency = std::stoi(next());
+        else if (arg == "--duration") config.duration_seconds = std::stod(next());
+        else if (arg == "--mix") config.mix = next();
+        else if (arg == "--top-k") config.top_k = std::stoi(next());
+        else if (arg == "--query-log") config.query_log = next();
+        else if (arg == "--record-log") config.record_log = next();
+        else if (arg == "--seed") config.seed = static_cast<unsigned>(std::stoul(next()));
+        else if (arg == "--json") config.json_output = true;
+        else if (arg == "--max-allocs-per-op") config.max_allocs_per_op = std::stod(next());
+        else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("Unknown argument: " + arg);
+        }
+    }
+
+    if (config.concurrency <= 0) throw std::invalid_argument("Concurrency must be positive");
+    if (config.duration_seconds <= 0) throw std::invalid_argument("Duration must be positive");
+    if (config.qps < 0) throw std::invalid_argument("QPS must not be negative");
+    return config;
+}
+
+std::map<Operation, double> parseMix(const std::string& spec) {
+    std::map<Operation, double> weights;
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        auto eq = item.find('=');
+        if (eq == std::string::npos) {
+            throw std::invalid_argument("Invalid mix entry: " + item);
+        }
+        weights[parseOperation(item.substr(0, eq))] = std::stod(item.substr(eq + 1));
+    }
+    return weights;
+}
+
+std::vector<QueryLogEntry> readQueryLog(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Cannot open query log: " + path);
+
+    std::vector<QueryLogEntry> entries;
+    std::string line;
+    while (std::getline(file, line)) {
+        auto tab = line.find('\t');
+        if (line.empty() || tab == std::string::npos) continue;
+        entries.push_back({parseOperation(line.substr(0, tab)), line.substr(tab + 1)});
+    }
+    if (entries.empty()) throw std::runtime_error("Query log is empty: " + path);
+    return entries;
+}
+
+void writeQueryLog(const std::string& path, const std::vector<QueryLogEntry>& entries) {
+    std::ofstream file(path);
+    for (const auto& entry : entries) {
+        file << operationName(entry.op) << '\t' << entry.argument << '\n';
+    }
+}
+
+std::vector<QueryLogEntry> generateWorkload(
+    BookRecommender& recommender,
+    const LoadConfig& config,
+    size_t count
+) {
+    auto weights = parseMix(config.mix);
+
+    // Argument pools drawn from the loaded catalog
+    std::map<Operation, std::vector<std::string>> pools;
+    pools[Operation::Recommend] = DEFAULT_QUERIES;
+    pools[Operation::Search] = DEFAULT_QUERIES;
+    pools[Operation::Author] = recommender.getPopularAuthors(50);
+    for (const auto& book : recommender.getTopRatedBooks(200)) {
+        pools[Operation::Similar].push_back(book.getId());
+        if (book.getSeries()) {
+            pools[Operation::Series].push_back(*book.getSeries());
+        }
+    }
+
+    std::vector<Operation> ops;
+    std::vector<double> op_weights;
+    for (const auto& [op, weight] : weights) {
+        if (weight > 0 && !pools[op].empty()) {
+            ops.push_back(op);
+            op_weights.push_back(weight);
+        }
+    }
+    if (ops.empty()) throw std::runtime_error("Query mix selects no runnable operation");
+
+    std::mt19937 rng(config.seed);
+    std::discrete_distribution<size_t> pick_op(op_weights.begin(), op_weights.end());
+
+    std::vector<QueryLogEntry> workload;
+    workload.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        Operation op = ops[pick_op(rng)];
+        const auto& pool = pools[op];
+        std::uniform_int_distribution<size_t> pick_arg(0, pool.size() - 1);
+        workload.push_back({op, pool[pick_arg(rng)]});
+    }
+    return workload;
+}
+
+void execute(BookRecommender& recommender, const QueryLogEntry& entry, int top_k) {
+    switch (entry.op) {
+        case Operation::Recommend:
+            recommender.getRecommendations(entry.argument, {}, top_k);
+            break;
+        case Operation::Similar:
+            recommender.getSimilarBooks(entry.argument, {}, top_k);
+            break;
+        case Operation::Author:
+            recommender.getAuthorRecommendations(entry.argument, {}, top_k);
+            break;
+        case Operation::Series:
+            recommender.getSeriesRecommendations(entry.argument, {}, top_k);
+            break;
+        case Operation::Search:
+            recommender.searchBooks(entry.argument);
+            break;
+    }
+}
+
+double toMillis(int64_t micros) {
+    return static_cast<double>(micros) / 1000.0;
+}
+
+double perCall(uint64_t total, int64_t calls) {
+    return calls > 0 ? static_cast<double>(total) / calls : 0.0;
+}
+
+// Returns false when an operation exceeded the allocation budget
+bool report(
+    const std::vector<OperationStats>& totals,
+    double elapsed_seconds,
+    const LoadConfig& config
+) {
+    const bool json_output = config.json_output;
+    const bool track_allocations = AllocationScope::isTrackingEnabled();
+    bool within_budget = true;
+
+    nlohmann::json json_report;
+    json_report["elapsed_seconds"] = elapsed_seconds;
+    json_report["allocation_tracking"] = track_allocations;
+
+    if (!json_output) {
+        std::cout << "\n" << std::left << std::setw(12) << "operation"
+                  << std::right << std::setw(10) << "count"
+                  << std::setw(10) << "req/s"
+                  << std::setw(10) << "p50 ms"
+                  << std::setw(10) << "p99 ms"
+                  << std::setw(10) << "p999 ms"
+                  << std::setw(10) << "max ms"
+                  << std::setw(8) << "errors"
+                  << std::setw(8) << "shed"
+                  << std::setw(10) << "cache %";
+        if (track_allocations) {
+            std::cout << std::setw(12) << "allocs/op" << std::setw(12) << "KB/op";
+        }
+        std::cout << "\n";
+    }
+
+    for (size_t i = 0; i < OPERATION_COUNT; ++i) {
+        const auto& stats = totals[i];
+        const auto& hist = stats.latency_us;
+        if (hist.getTotalCount() == 0 && stats.errors == 0) continue;
+
+        uint64_t lookups = stats.cache.hits + stats.cache.misses;
+        double hit_rate = lookups > 0 ? 100.0 * stats.cache.hits / lookups : 0.0;
+        double throughput = hist.getTotalCount() / elapsed_seconds;
+        const char* name = operationName(ALL_OPERATIONS[i]);
+        int64_t calls = hist.getTotalCount() + static_cast<int64_t>(stats.errors);
+        double allocs_per_op = perCall(stats.allocations.allocations, calls);
+        double bytes_per_op = perCall(stats.allocations.bytes, calls);
+
+        if (track_allocations && config.max_allocs_per_op > 0 &&
+            allocs_per_op > config.max_allocs_per_op) {
+            within_budget = false;
+            spdlog::error("{} averaged {:.1f} allocations per call (budget {:.1f})",
+                          name, allocs_per_op, config.max_allocs_per_op);
+        }
+
+        if (json_output) {
+            json_report["operations"][name] = {
+                {"count", hist.getTotalCount()},
+                {"throughput", throughput},
+                {"p50_ms", toMillis(hist.getValueAtPercentile(50.0))},
+                {"p99_ms", toMillis(hist.getValueAtPercentile(99.0))},
+                {"p999_ms", toMillis(hist.getValueAtPercentile(99.9))},
+                {"max_ms", toMillis(hist.getMax())},
+                {"service_p50_ms", toMillis(stats.service_us.getValueAtPercentile(50.0))},
+                {"service_p99_ms", toMillis(stats.service_us.getValueAtPercentile(99.0))},
+                {"errors", stats.errors},
+                {"shed", stats.shed},
+                {"cache_hit_rate", hit_rate / 100.0}
+            };
+            if (track_allocations) {
+                json_report["operations"][name]["allocations_per_op"] = allocs_per_op;
+                json_report["operations"][name]["bytes_per_op"] = bytes_per_op;
+            }
+            continue;
+        }
+
+        std::cout << std::left << std::setw(12) << name
+                  << std::right << std::setw(10) << hist.getTotalCount()
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(10) << throughput
+                  << std::setprecision(2)
+                  << std::setw(10) << toMillis(hist.getValueAtPercentile(50.0))
+                  << std::setw(10) << toMillis(hist.getValueAtPercentile(99.0))
+                  << std::setw(10) << toMillis(hist.getValueAtPercentile(99.9))
+                  << std::setw(10) << toMillis(hist.getMax())
+                  << std::setw(8) << stats.errors
+                  << std::setw(8) << stats.shed
+                  << std::setprecision(1)
+                  << std::setw(10) << hit_rate;
+        if (track_allocations) {
+            std::cout << std::setw(12) << allocs_per_op << std::setw(12) << bytes_per_op / 1024.0;
+        }
+        std::cout << "\n";
+    }
+
+    if (json_output) {
+        json_report["within_allocation_budget"] = within_budget;
+        std::cout << json_report.dump(2) << std::endl;
+    }
+    return within_budget;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        LoadConfig config = parseArgs(argc, argv);
+        spdlog::set_level(spdlog::level::warn);
+
+        BookRecommender::RecommenderConfig recommender_config;
+        recommender_config.data_file = config.data_file;
+        BookRecommender recommender(recommender_config);
+
+        std::vector<QueryLogEntry> workload;
+        if (!config.query_log.empty()) {
+            workload = readQueryLog(config.query_log);
+        } else {
+            size_t count = config.qps > 0
+                ? static_cast<size_t>(config.qps * config.duration_seconds) + 1
+                : 10000;
+            workload = generateWorkload(recommender, config, count);
+        }
+        if (!config.record_log.empty()) {
+            writeQueryLog(config.record_log, workload);
+        }
+
+        // With a target rate every request has an intended send time on a
+        // global schedule. Latency is measured from that time, so a stalled
+        // response also charges the requests that queued up behind it.
+        const auto interval = config.qps > 0
+            ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / config.qps))
+            : Clock::duration::zero();
+        const auto run_length = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(config.duration_seconds)
+        );
+
+        std::atomic<size_t> next_request{0};
+        std::vector<std::vector<OperationStats>> per_thread(
+            config.concurrency, std::vector<OperationStats>(OPERATION_COUNT)
+        );
+
+        const auto start = Clock::now();
+        const auto deadline = start + run_length;
+
+        std::vector<std::thread> workers;
+        workers.reserve(config.concurrency);
+        for (int t = 0; t < config.concurrency; ++t) {
+            workers.emplace_back([&, t]() {
+                auto& stats = per_thread[t];
+                while (true) {
+                    size_t index = next_request.fetch_add(1, std::memory_order_relaxed);
+                    Clock::time_point intended;
+                    if (config.qps > 0) {
+                        intended = start + interval * static_cast<int64_t>(index);
+                        if (intended >= deadline) break;
+                        std::this_thread::sleep_until(intended);
+                    } else {
+                        intended = Clock::now();
+                        if (intended >= deadline) break;
+                    }
+
+                    const auto& entry = workload[index % workload.size()];
+                    auto& op_stats = stats[static_cast<size_t>(entry.op)];
+                    auto cache_before = BookVectorStore::getThreadCacheStats();
+                    auto sent = Clock::now();
+                    AllocationScope allocations;
+
+                    // The recommender answers most engine failures with an
+                    // empty list, so they are told apart by the engine's
+                    // per-thread failure count
+                    uint64_t failures = BookQueryEngine::getThreadFailureCount();
+                    bool failed = false;
+                    try {
+                        execute(recommender, entry, config.top_k);
+                        failed = BookQueryEngine::getThreadFailureCount() != failures;
+                    } catch (const OverloadError&) {
+                        ++op_stats.shed;
+                    } catch (const std::exception& e) {
+                        failed = true;
+                        spdlog::debug("Request failed: {}", e.what());
+                    }
+
+                    auto done = Clock::now();
+                    auto allocated = allocations.stats();
+                    op_stats.allocations.allocations += allocated.allocations;
+                    op_stats.allocations.bytes += allocated.bytes;
+                    auto cache_after = BookVectorStore::getThreadCacheStats();
+                    op_stats.cache.hits += cache_after.hits - cache_before.hits;
+                    op_stats.cache.misses += cache_after.misses - cache_before.misses;
+
+                    // A failure's latency says nothing about serving a request
+                    if (failed) {
+                        ++op_stats.errors;
+                        continue;
+                    }
+                    op_stats.latency_us.recordValue(
+                        std::chrono::duration_cast<std::chrono::microseconds>(done - intended).count()
+                    );
+                    op_stats.service_us.recordValue(
+                        std::chrono::duration_cast<std::chrono::microseconds>(done - sent).count()
+                    );
+                }
+            });
+        }
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::vector<OperationStats> totals(OPERATION_COUNT);
+        for (const auto& stats : per_thread) {
+            for (size_t i = 0; i < OPERATION_COUNT; ++i) {
+                totals[i].latency_us.add(stats[i].latency_us);
+                totals[i].service_us.add(stats[i].service_us);
+                totals[i].errors += stats[i].errors;
+                totals[i].shed += stats[i].shed;
+                totals[i].cache.hits += stats[i].cache.hits;
+                totals[i].cache.misses += stats[i].cache.misses;
+                totals[i].allocations.allocations += stats[i].allocations.allocations;
+                totals[i].allocations.bytes += stats[i].allocations.bytes;
+            }
+        }
+
+        if (!report(totals, elapsed, config)) {
+            return 2;
+        }
+    } catch (const std::exception& e) {
+        spdlog::error("Load generator failed: {}", e.what());
+        return 1;
+    }
+
+    return 0;
+}
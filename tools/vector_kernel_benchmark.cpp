@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <book_recommender/VectorKernels.hpp>
+
+using namespace book_recommender;
+
+namespace {
+
+struct BenchmarkConfig {
+    std::vector<size_t> dimensions{std::begin(VectorKernels::SPECIALIZED_DIMENSIONS),
+                                   std::end(VectorKernels::SPECIALIZED_DIMENSIONS)};
+    size_t rows = 20000;
+    int repeat = 20;
+};
+
+void printUsage() {
+    std::cout << "Usage: vector_kernel_benchmark [options]\n"
+              << "  --dimension N      Benchmark only this dimension (repeatable;\n"
+              << "                     default 128 256 384 768 1024)\n"
+              << "  --rows N           Vectors scored per pass (default 20000)\n"
+              << "  --repeat N         Passes per measurement (default 20)\n";
+}
+
+BenchmarkConfig parseArgs(int argc, char* argv[]) {
+    BenchmarkConfig config;
+    bool custom_dimensions = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--dimension") {
+            if (!custom_dimensions) config.dimensions.clear();
+            custom_dimensions = true;
+            config.dimensions.push_back(std::stoul(next()));
+        } else if (arg == "--rows") {
+            config.rows = std::stoul(next());
+        } else if (arg == "--repeat") {
+            config.repeat = std::stoi(next());
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("Unknown argument: " + arg);
+        }
+    }
+
+    if (config.rows == 0 || config.repeat <= 0) throw std::invalid_argument("rows and repeat must be positive");
+    for (size_t dimension : config.dimensions) {
+        if (dimension == 0) throw std::invalid_argument("Dimension must be positive");
+    }
+    return config;
+}
+
+// Best-of-`repeat` nanoseconds per row, so scheduler noise doesn't count
+template <typename Fn>
+double nanosPerRow(const BenchmarkConfig& config, Fn&& pass) {
+    double best = INFINITY;
+    for (int r = 0; r < config.repeat; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        pass();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / static_cast<double>(config.rows));
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        auto config = parseArgs(argc, argv);
+
+        std::printf("%9s %12s %12s %12s %12s %8s %8s\n", "dimension", "dot generic", "dot fixed",
+                    "rows generic", "rows fixed", "dot x", "rows x");
+        for (size_t dimension : config.dimensions) {
+            std::mt19937 rng(42);
+            std::normal_distribution<float> normal;
+            std::vector<float> rows(config.rows * dimension);
+            std::vector<float> query(dimension);
+            for (float& x : rows) x = normal(rng);
+            for (float& x : query) x = normal(rng);
+
+            auto generic = VectorKernels::generic(dimension);
+            VectorKernels fixed(dimension);
+            std::vector<float> expected(config.rows);
+            std::vector<float> scores(config.rows);
+
+            double dot_generic = nanosPerRow(config, [&] {
+                for (size_t i = 0; i < config.rows; ++i) expected[i] = generic.dot(query.data(), rows.data() + i * dimension);
+            });
+            double dot_fixed = nanosPerRow(config, [&] {
+                for (size_t i = 0; i < config.rows; ++i) scores[i] = fixed.dot(query.data(), rows.data() + i * dimension);
+            });
+            double rows_generic = nanosPerRow(config, [&] {
+                generic.dotRows(query.data(), rows.data(), config.rows, expected.data());
+            });
+            double rows_fixed = nanosPerRow(config, [&] {
+                fixed.dotRows(query.data(), rows.data(), config.rows, scores.data());
+            });
+
+            // Blocked sums round differently from the plain loop; report
+            // how far apart they land relative to the vectors' norms
+            float worst = 0.0f;
+            for (size_t i = 0; i < config.rows; ++i) {
+                worst = std::max(worst, std::abs(scores[i] - expected[i]) / static_cast<float>(dimension));
+            }
+
+            std::printf("%9zu %9.1f ns %9.1f ns %9.1f ns %9.1f ns %7.2fx %7.2fx%s\n", dimension, dot_generic, dot_fixed,
+                        rows_generic, rows_fixed, dot_generic / dot_fixed, rows_generic / rows_fixed,
+                        fixed.specialized() ? "" : "  (generic fallback)");
+            if (worst > 1e-5f) {
+                std::cerr << "Dimension " << dimension << ": kernels disagree by " << worst << " per element\n";
+                return 1;
+            }
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        printUsage();
+        return 1;
+    }
+}